@@ -574,6 +574,9 @@ const possumwood::Index& Adaptor::index() const {
 }
 
 void Adaptor::setCurrentNetwork(dependency_graph::Network& n, bool recordHistory) {
+	// a network with a deferred load is loaded when displayed
+	n.load();
+
 	// clear current view
 	while(m_graphWidget->scene().edgeCount() > 0)
 		// onDisconnect()
@@ -23,7 +23,9 @@
 #include <qt_node_editor/graph_widget.h>
 #include <qt_node_editor/node.h>
 
+#include <actions/disk_cache.h>
 #include <dependency_graph/graph.h>
+#include <dependency_graph/memory_governor.h>
 #include <possumwood_sdk/app.h>
 #include <possumwood_sdk/gl.h>
 #include <dependency_graph/attr.inl>
@@ -60,7 +62,11 @@ void signalHandler(int sig) {
 int main(int argc, char* argv[]) {
 	// // Declare the supported options.
 	po::options_description desc("Allowed options");
-	desc.add_options()("help", "produce help message")("scene", po::value<std::string>(), "open a scene file");
+	desc.add_options()("help", "produce help message")("scene", po::value<std::string>(), "open a scene file")(
+	    "cache", po::value<std::string>(), "a directory for storing the results of expensive computes")(
+	    "memory_budget", po::value<std::size_t>(), "limit of the memory held by intermediate values in megabytes")(
+	    "undo_budget", po::value<std::size_t>(), "limit of the memory held by the undo stack in megabytes")(
+	    "undo_journal", po::value<std::string>(), "a file for storing old undo steps over the undo budget");
 
 	// process the options
 	po::variables_map vm;
@@ -84,6 +90,21 @@ int main(int argc, char* argv[]) {
 	// load all plugins into an RAII container - loading of plugins requires path expansion from the main app instance
 	std::unique_ptr<PluginsRAII> plugins(new PluginsRAII());
 
+	// persistent cache of compute results
+	if(vm.count("cache"))
+		papp->graph().setComputeCache(std::make_shared<possumwood::DiskCache>(vm["cache"].as<std::string>()));
+
+	// eviction of intermediate values over the memory budget
+	if(vm.count("memory_budget"))
+		papp->graph().setMemoryGovernor(
+		    std::make_shared<dependency_graph::MemoryGovernor>(vm["memory_budget"].as<std::size_t>() * 1024 * 1024));
+
+	// undo steps over the undo budget are moved to the journal, or dropped
+	if(vm.count("undo_budget"))
+		papp->undoStack().setMemoryLimit(vm["undo_budget"].as<std::size_t>() * 1024 * 1024);
+	if(vm.count("undo_journal"))
+		papp->undoStack().setJournal(vm["undo_journal"].as<std::string>());
+
 	{
 		GL_CHECK_ERR;
 
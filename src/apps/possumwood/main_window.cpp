@@ -5,6 +5,7 @@
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/filesystem.hpp>
+#include <fstream>
 
 #include <QAction>
 #include <QApplication>
@@ -24,6 +25,7 @@
 #include <actions/actions.h>
 #include <actions/node_data.h>
 #include <dependency_graph/metadata_register.h>
+#include <dependency_graph/profiler.h>
 #include <possumwood_sdk/app.h>
 #include <possumwood_sdk/gl.h>
 #include <qt_node_editor/connected_edge.h>
@@ -234,7 +236,7 @@ MainWindow::MainWindow() : QMainWindow(), m_editor(nullptr) {
 	connect(openAct, &QAction::triggered, [this](bool) {
 		QString filename = QFileDialog::getOpenFileName(
 		    this, tr("Open File"), possumwood::App::instance().filename().toPath().string().c_str(),
-		    tr("Possumwood files (*.psw)"));
+		    tr("Possumwood files (*.psw *.pswb)"));
 
 		if(!filename.isEmpty())
 			loadFile(filename.toStdString());
@@ -271,7 +273,7 @@ MainWindow::MainWindow() : QMainWindow(), m_editor(nullptr) {
 	connect(saveAsAct, &QAction::triggered, [this](bool) {
 		QString filename = QFileDialog::getSaveFileName(
 		    this, tr("Save File"), possumwood::App::instance().filename().toPath().string().c_str(),
-		    tr("Possumwood files (*.psw)"));
+		    tr("Possumwood files (*.psw *.pswb)"));
 
 		if(!filename.isEmpty()) {
 			try {
@@ -392,6 +394,54 @@ MainWindow::MainWindow() : QMainWindow(), m_editor(nullptr) {
 		playbackMenu->addAction(m_timeline->playAction());
 	}
 
+	/////////////////////
+	// profiling menu
+	{
+		QMenu* profilingMenu = mainMenu->addMenu("P&rofiling");
+
+		QAction* recordAct = new QAction("&Record evaluation profile", this);
+		recordAct->setCheckable(true);
+		connect(recordAct, &QAction::toggled, [](bool checked) {
+			if(checked)
+				possumwood::App::instance().graph().setProfiler(std::make_shared<dependency_graph::Profiler>());
+			else
+				possumwood::App::instance().graph().setProfiler(std::shared_ptr<dependency_graph::Profiler>());
+		});
+
+		QAction* exportAct = new QAction("&Export evaluation profile...", this);
+		connect(exportAct, &QAction::triggered, [this](bool) {
+			const std::shared_ptr<dependency_graph::Profiler> profiler = possumwood::App::instance().graph().profiler();
+			if(!profiler) {
+				QMessageBox::information(this, "Export evaluation profile...",
+				                         "No evaluation profile recorded - please enable profile recording first.");
+				return;
+			}
+
+			QString filename = QFileDialog::getSaveFileName(this, tr("Export evaluation profile"), "profile.json",
+			                                                tr("Chrome trace files (*.json)"));
+
+			if(!filename.isEmpty()) {
+				std::ofstream file(filename.toStdString());
+				profiler->writeChromeTrace(file);
+
+				if(!file.good())
+					QMessageBox::critical(this, "Error exporting evaluation profile...",
+					                      "Error writing " + filename + ".");
+			}
+		});
+
+		QAction* clearAct = new QAction("&Clear evaluation profile", this);
+		connect(clearAct, &QAction::triggered, [](bool) {
+			const std::shared_ptr<dependency_graph::Profiler> profiler = possumwood::App::instance().graph().profiler();
+			if(profiler)
+				profiler->clear();
+		});
+
+		profilingMenu->addAction(recordAct);
+		profilingMenu->addAction(clearAct);
+		profilingMenu->addAction(exportAct);
+	}
+
 	/////////////////////
 	// status bar
 	m_statusBar = new QStatusBar();
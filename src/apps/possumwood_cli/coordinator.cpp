@@ -0,0 +1,249 @@
+#include "coordinator.h"
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+Coordinator::Coordinator(unsigned workers)
+    : m_workerIndex(-1), m_requests(nullptr), m_replies(nullptr), m_previousFrame(-1) {
+	if(workers == 0)
+		throw std::runtime_error("The number of worker processes has to be at least 1");
+
+	// nothing buffered should be printed twice
+	std::cout << std::flush;
+	std::cerr << std::flush;
+
+	for(unsigned w = 0; w < workers; ++w) {
+		// requests from the worker to the coordinator, and replies in the other direction
+		int requests[2], replies[2];
+		if(pipe(requests) != 0 || pipe(replies) != 0)
+			throw std::runtime_error(std::string("Error creating worker pipes - ") + strerror(errno));
+
+		const pid_t pid = fork();
+		if(pid < 0)
+			throw std::runtime_error(std::string("Error forking a worker process - ") + strerror(errno));
+
+		if(pid == 0) {
+			// worker - only its own pipes stay open
+			for(auto& other : m_workers) {
+				fclose(other.requests);
+				fclose(other.replies);
+			}
+			m_workers.clear();
+
+			close(requests[0]);
+			close(replies[1]);
+
+			m_workerIndex = w;
+			m_requests = fdopen(requests[1], "w");
+			m_replies = fdopen(replies[0], "r");
+
+			return;
+		}
+
+		close(requests[1]);
+		close(replies[0]);
+
+		m_workers.push_back(Worker());
+		m_workers.back().pid = pid;
+		m_workers.back().requests = fdopen(requests[0], "r");
+		m_workers.back().replies = fdopen(replies[1], "w");
+	}
+}
+
+Coordinator::~Coordinator() {
+	if(isWorker()) {
+		fprintf(m_requests, "done %d %f\n", m_previousFrame, previousTime());
+
+		fclose(m_requests);
+		fclose(m_replies);
+	}
+
+	else
+		for(auto& w : m_workers) {
+			if(w.requests)
+				fclose(w.requests);
+			fclose(w.replies);
+		}
+}
+
+bool Coordinator::isWorker() const {
+	return m_workerIndex >= 0;
+}
+
+float Coordinator::previousTime() const {
+	if(m_previousFrame < 0)
+		return 0.0f;
+
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_previousStart).count();
+}
+
+int Coordinator::next(std::size_t sequence, const std::vector<int>& frames) {
+	assert(isWorker());
+
+	fprintf(m_requests, "next %zu %zu %d %f\n", sequence, frames.size(), m_previousFrame, previousTime());
+	fflush(m_requests);
+
+	int position = -1;
+	if(fscanf(m_replies, "%d", &position) != 1)
+		throw std::runtime_error("Lost the connection to the coordinator process");
+
+	if(position >= 0) {
+		assert((std::size_t)position < frames.size());
+
+		m_previousFrame = frames[position];
+		m_previousStart = std::chrono::steady_clock::now();
+	}
+	else
+		m_previousFrame = -1;
+
+	return position;
+}
+
+int Coordinator::run() {
+	assert(!isWorker());
+
+	// a worker failing between its request and the reply should not terminate the coordinator
+	signal(SIGPIPE, SIG_IGN);
+
+	const auto start = std::chrono::steady_clock::now();
+	unsigned errors = 0;
+
+	while(true) {
+		std::vector<pollfd> fds;
+		std::vector<std::size_t> indices;
+		for(std::size_t w = 0; w < m_workers.size(); ++w)
+			if(m_workers[w].requests) {
+				fds.push_back(pollfd{fileno(m_workers[w].requests), POLLIN, 0});
+				indices.push_back(w);
+			}
+
+		if(fds.empty())
+			break;
+
+		if(poll(&fds[0], fds.size(), -1) < 0) {
+			if(errno == EINTR)
+				continue;
+			throw std::runtime_error(std::string("Error waiting for the worker processes - ") + strerror(errno));
+		}
+
+		for(std::size_t f = 0; f < fds.size(); ++f) {
+			if(fds[f].revents == 0)
+				continue;
+
+			const std::size_t index = indices[f];
+			Worker& w = m_workers[index];
+
+			// each worker waits for a reply after each request - there is never more than one line to read
+			char line[256];
+			if(fgets(line, sizeof(line), w.requests) == nullptr) {
+				// the worker exited
+				fclose(w.requests);
+				w.requests = nullptr;
+
+				int status = 0;
+				waitpid(w.pid, &status, 0);
+
+				const bool failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+				if(failed) {
+					std::cerr << "[coordinator] worker " << index << " failed";
+					if(WIFSIGNALED(status))
+						std::cerr << " (signal " << WTERMSIG(status) << ")";
+					else
+						std::cerr << " (exit code " << WEXITSTATUS(status) << ")";
+					if(w.position >= 0)
+						std::cerr << " while evaluating frame #" << w.position << " of sequence " << w.sequence;
+
+					// the frame is handed out again to the remaining workers (only once, a frame crashing
+					//   the workers deterministically would take all of them down)
+					if(w.position >= 0 && m_retried.insert(std::make_pair(w.sequence, w.position)).second) {
+						m_requeued[w.sequence].push_back(w.position);
+						std::cerr << " - requeued";
+					}
+					else
+						++errors;
+
+					std::cerr << std::endl;
+				}
+
+				continue;
+			}
+
+			char command[16] = {0};
+			std::size_t sequence = 0, count = 0;
+			int previousFrame = -1;
+			float previousTime = 0.0f;
+
+			const bool isNext =
+			    sscanf(line, "next %zu %zu %d %f", &sequence, &count, &previousFrame, &previousTime) == 4;
+			if(!isNext && sscanf(line, "%15s %d %f", command, &previousFrame, &previousTime) != 3)
+				throw std::runtime_error(std::string("Unexpected worker message - ") + line);
+
+			// progress of the previous frame
+			if(previousFrame >= 0) {
+				++w.frames;
+				w.time += previousTime;
+
+				std::cout << "[coordinator] worker " << index << " finished frame " << previousFrame << " in "
+				          << std::fixed << std::setprecision(2) << previousTime << "ms" << std::endl;
+			}
+
+			w.position = -1;
+
+			if(isNext) {
+				std::vector<int>& requeued = m_requeued[sequence];
+				std::size_t& position = m_positions[sequence];
+
+				// frames of failed workers first
+				if(!requeued.empty()) {
+					w.position = requeued.back();
+					w.sequence = sequence;
+					requeued.pop_back();
+				}
+				else if(position < count) {
+					w.position = position;
+					w.sequence = sequence;
+					++position;
+				}
+
+				fprintf(w.replies, "%d\n", w.position);
+				fflush(w.replies);
+			}
+		}
+	}
+
+	// requeued frames not picked up by any of the remaining workers (e.g., all of them already finished
+	//   their sequence) were never evaluated
+	for(auto& r : m_requeued)
+		for(int position : r.second) {
+			++errors;
+
+			std::cerr << "[coordinator] frame #" << position << " of sequence " << r.first << " was not evaluated"
+			          << std::endl;
+		}
+
+	// summary
+	std::cout << "[coordinator] finished in " << std::fixed << std::setprecision(2)
+	          << std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+	for(std::size_t w = 0; w < m_workers.size(); ++w) {
+		std::cout << "[coordinator]   worker " << w << " - " << m_workers[w].frames << " frames";
+		if(m_workers[w].frames > 0)
+			std::cout << ", " << m_workers[w].time / (float)m_workers[w].frames << "ms per frame";
+		std::cout << std::endl;
+	}
+
+	if(errors > 0) {
+		std::cerr << "[coordinator] " << errors << " failures in " << m_workers.size() << " workers" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+
+/// Local distribution of the frames of the CLI between worker processes. The coordinator forks a number
+/// of workers, each evaluating all command-line options with its own App and GL context (i.e., loading
+/// the scene only once). The frames of each frame sequence (a --render or --eval option) are handed out
+/// one by one, whenever a worker finishes its previous frame - workers with faster frames get more of
+/// them. The coordinator prints the progress and errors reported by all workers. The frame of a failed worker
+/// is handed out again to the remaining workers (only once - a frame that fails twice is reported as lost).
+class Coordinator {
+  public:
+	/// forks the workers - the constructor returns both in the coordinator and in each worker (see isWorker())
+	Coordinator(unsigned workers);
+	/// in a worker, reports the time of its last frame to the coordinator
+	~Coordinator();
+
+	bool isWorker() const;
+
+	/// coordinator only - hands out frames to the workers until all of them exit. Returns the exit code of
+	///   the whole run (non-zero if any worker failed).
+	int run();
+
+	/// worker only - returns the position of the next frame of a sequence to evaluate (-1 if all its frames
+	///   have been handed out already), reporting the time of the previous frame. Sequences are identified by
+	///   the order of the options creating them (the same in all workers), and the frame numbers of a sequence
+	///   are only used for progress reports.
+	int next(std::size_t sequence, const std::vector<int>& frames);
+
+  private:
+	Coordinator(const Coordinator&) = delete;
+	Coordinator& operator=(const Coordinator&) = delete;
+
+	/// a worker process, as seen by the coordinator
+	struct Worker {
+		Worker() : pid(0), requests(nullptr), replies(nullptr), position(-1), sequence(0), frames(0), time(0.0f) {
+		}
+
+		pid_t pid;
+		FILE* requests;
+		FILE* replies;
+
+		// the frame being evaluated (position and sequence, for error reports)
+		int position;
+		std::size_t sequence;
+
+		unsigned frames;
+		float time;
+	};
+
+	// worker - returns the time since the previous frame has been handed out
+	float previousTime() const;
+
+	// coordinator - all workers (running ones have their requests stream open)
+	std::vector<Worker> m_workers;
+	// coordinator - the next frame position of each sequence
+	std::map<std::size_t, std::size_t> m_positions;
+	// coordinator - frame positions of failed workers, to be handed out again, for each sequence
+	std::map<std::size_t, std::vector<int>> m_requeued;
+	// coordinator - frames that were handed out again already (sequence and position)
+	std::set<std::pair<std::size_t, int>> m_retried;
+
+	// worker - the index of this worker, and its streams to the coordinator
+	int m_workerIndex;
+	FILE* m_requests;
+	FILE* m_replies;
+
+	// worker - the previous frame and the time it was handed out
+	int m_previousFrame;
+	std::chrono::steady_clock::time_point m_previousStart;
+};
@@ -1,20 +1,35 @@
 #include <GL/glew.h>
 #include <GL/glut.h>
 #include <OpenImageIO/imageio.h>
+#include <actions/disk_cache.h>
+#include <actions/io.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/memory_governor.h>
+#include <dependency_graph/profiler.h>
 #include <dependency_graph/static_initialisation.h>
 #include <possumwood_sdk/app.h>
 #include <possumwood_sdk/viewport_state.h>
+#include <unistd.h>
 
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
+#include <boost/optional.hpp>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
 #include <possumwood_sdk/config.inl>
 
 #include "common.h"
+#include "coordinator.h"
 #include "expression.h"
 #include "options.h"
 #include "render_context.h"
 #include "stack.h"
+#include "writer_pool.h"
 
 using namespace OIIO;
 
@@ -26,6 +41,9 @@ using namespace OIIO;
 // each step of execution inside the OpenGL loop. It initialises the OpenGL on the first
 // --render parameter, and destroys it once the evaluation of all parameters finishes.
 
+// Without any --render parameter, no GL context is created at all - the --eval parameters
+// only pull the values of outputs, which makes the CLI usable on headless render-farm nodes.
+
 // global viewport state
 possumwood::ViewportState viewport;
 // rendering options
@@ -34,10 +52,26 @@ std::unique_ptr<RenderContext> renderContext;
 // global application instance
 std::unique_ptr<possumwood::App> papp;
 
+// background writing of the results
+std::unique_ptr<WriterPool> writerPool;
+
 // additional view parameters
 std::size_t frame_step = 0;
 float cam_orbit = 0.0f;
 
+// explicit frame range, and the shard of the frames evaluated by this process
+boost::optional<std::pair<int, int>> frame_range;
+unsigned shard_index = 0;
+unsigned shard_count = 1;
+
+// local distribution of frames between worker processes
+std::unique_ptr<Coordinator> coordinator;
+// the number of frame sequences created so far (identifying them in all worker processes)
+std::size_t sequence_count = 0;
+
+// evaluation profile output
+std::string profile_filename;
+
 // expression expansion
 int currentFrame() {
 	return std::round(possumwood::App::instance().time() *
@@ -56,16 +90,43 @@ const ExpressionExpansion expr({{"T", []() { return (boost::format("%.2f") % cur
 
 void printHelp() {
 	std::cout << "Parameters:" << std::endl;
-	std::cout << "  --scene <filename> - Loads a .psw scene file." << std::endl;
+	std::cout << "  --scene <filename> - Loads a .psw or .pswb scene file." << std::endl;
 	std::cout << "  --render <filename> - renders a frame to a file. Only PPM files supported at the moment."
 	          << std::endl;
 	std::cout << "  --window <width> <height> - defines the render window size in pixels" << std::endl;
 	std::cout << "  --cam_pos <x> <y> <z> - defines camera position in world space" << std::endl;
 	std::cout << "  --cam_target <x> <y> <z> - defines camera target (default 0,0,0)" << std::endl;
 	std::cout << "  --cam_orbit <orbit_count> - if present, makes the camera orbit the scene" << std::endl;
-	std::cout << "  --frame_step <step> - render multiple frames" << std::endl;
+	std::cout << "  --eval <network/node/port> [<filename>] - evaluates a port without any rendering, printing the"
+	          << std::endl;
+	std::cout << "                        evaluation time. Writes the result to an image file (for image types) or"
+	          << std::endl;
+	std::cout << "                        to a JSON file, if a filename is provided." << std::endl;
+	std::cout << "  --frame_step <step> - render or evaluate multiple frames" << std::endl;
+	std::cout << "  --frames <first>-<last> - render or evaluate a range of frames (with the frame step, if present)"
+	          << std::endl;
+	std::cout << "  --shard <index>/<count> - render or evaluate only every count-th frame, starting from the index"
+	          << std::endl;
+	std::cout << "                            (e.g., to split the frames between several machines)" << std::endl;
+	std::cout << "  --workers <count> - forks a number of worker processes, each loading the scene once, and hands"
+	          << std::endl;
+	std::cout << "                      out the frames between them as they finish their previous ones" << std::endl;
+	std::cout << "  --writers <count> - number of background threads encoding and writing the results, allowing"
+	          << std::endl;
+	std::cout << "                      the following frames to be evaluated in the meantime (0 writes each"
+	          << std::endl;
+	std::cout << "                      result immediately; defaults to the number of cores)" << std::endl;
+	std::cout << "  --cache <directory> - stores the results of expensive computes in a directory, and reuses them"
+	          << std::endl;
+	std::cout << "                        in subsequent runs" << std::endl;
+	std::cout << "  --memory_budget <megabytes> - limits the memory held by intermediate values, evicting the least"
+	          << std::endl;
+	std::cout << "                                recently used ones to be recomputed on demand" << std::endl;
+	std::cout << "  --profile <filename> - records the timings of all evaluations, and saves them on exit as a"
+	          << std::endl;
+	std::cout << "                         Chrome trace JSON file (chrome://tracing or Perfetto)" << std::endl;
 	std::cout << std::endl;
-	std::cout << "The render filename parameter can contain the following 'variables':" << std::endl;
+	std::cout << "The render and eval filename parameters can contain the following 'variables':" << std::endl;
 	std::cout << "  $T - time, with two decimal points" << std::endl;
 	std::cout << "  $F - frame, as an integer value" << std::endl;
 	std::cout << "  $2F - frame, as an integer value, padded with 0s to the width of 2" << std::endl;
@@ -74,14 +135,7 @@ void printHelp() {
 	std::cout << std::endl;
 }
 
-void loadScene(const Options::Item& option) {
-	if(option.parameters.size() != 1)
-		throw std::runtime_error("--scene option allows only exactly one filename");
-
-	std::cout << "Loading " << option.parameters[0] << "... " << std::flush;
-	dependency_graph::State state = papp->loadFile(possumwood::Filepath::fromPath(option.parameters[0]));
-	std::cout << "done" << std::endl;
-
+void printState(const dependency_graph::State& state) {
 	for(auto& msg : state) {
 		if(msg.first == dependency_graph::State::kInfo)
 			std::cout << "[info] ";
@@ -91,54 +145,107 @@ void loadScene(const Options::Item& option) {
 			std::cout << "[error] ";
 		std::cout << msg.second << std::endl;
 	}
+}
+
+void loadScene(const Options::Item& option) {
+	if(option.parameters.size() != 1)
+		throw std::runtime_error("--scene option allows only exactly one filename");
+
+	std::cout << "Loading " << option.parameters[0] << "... " << std::flush;
+	dependency_graph::State state = papp->loadFile(possumwood::Filepath::fromPath(option.parameters[0]));
+	std::cout << "done" << std::endl;
+
+	printState(state);
 
 	if(state.errored())
 		throw std::runtime_error("Error loading scene file. Exiting.");
 }
 
-std::vector<Action> render(const Options::Item& option) {
-	if(option.parameters.size() != 1)
-		throw std::runtime_error("--render option allows only exactly one filename");
+/// times of all frames to render or evaluate - an explicit frame range, or the whole timeline of the scene
+///   with a frame step (or just the start time without it)
+std::vector<float> frameTimes() {
+	const possumwood::Config& cfg = possumwood::App::instance().sceneConfig();
 
-	std::vector<Action> result;
+	if(frame_range) {
+		std::vector<float> result;
+		for(int f = frame_range->first; f <= frame_range->second; f += std::max<int>(frame_step, 1))
+			result.push_back((float)f / cfg["fps"].as<float>());
+
+		return result;
+	}
 
 	std::size_t end_param = 0;
-	if(frame_step > 0) {
-		const possumwood::Config& cfg = possumwood::App::instance().sceneConfig();
+	if(frame_step > 0)
 		end_param =
 		    std::size_t(round((cfg["end_time"].as<float>() - cfg["start_time"].as<float>()) * cfg["fps"].as<float>())) /
 		    frame_step;
-	}
 
-	for(std::size_t param = 0; param <= end_param; ++param) {
-		const possumwood::Config& cfg = possumwood::App::instance().sceneConfig();
-		const float t = (float)(param * frame_step) / cfg["fps"].as<float>() + cfg["start_time"].as<float>();
+	std::vector<float> result;
+	for(std::size_t param = 0; param <= end_param; ++param)
+		result.push_back((float)(param * frame_step) / cfg["fps"].as<float>() + cfg["start_time"].as<float>());
 
-		std::function<void(std::vector<GLubyte>&)> callback = [option, t](const std::vector<GLubyte>& buffer) {
-			possumwood::App::instance().setTime(t);
+	return result;
+}
 
-			const std::string filename = expr.expand(option.parameters[0]);
-			std::cout << "Rendering " << filename << "... " << std::flush;
+/// a worker process evaluates the frames of a sequence handed out by the coordinator, one by one. A frame is
+///   reported as finished only after its readback and write finish - a failure of a write is then reported
+///   while its own frame is still assigned to the worker, and that frame is handed out again.
+Action nextFrame(std::size_t sequence, const std::vector<float>& times, const std::vector<std::size_t>& indices,
+                 std::function<std::vector<Action>(std::size_t, float)> frame) {
+	return Action([sequence, times, indices, frame]() {
+		std::vector<int> frames;
+		for(std::size_t i : indices)
+			frames.push_back(std::round(times[i] * possumwood::App::instance().sceneConfig()["fps"].as<float>()));
 
-			std::unique_ptr<ImageOutput> out(ImageOutput::create(filename));
-			if(!out)
-				throw(std::runtime_error("Cannot write output image " + filename));
+		std::vector<Action> result;
 
-			ImageSpec spec(viewport.width(), viewport.height(), 3, TypeDesc::UINT8);
-			if(out->open(filename, spec)) {
-				for(int y = viewport.height() - 1; y >= 0; --y) {
-					const GLubyte* ptr = &(buffer[y * viewport.width() * 3]);
+		// finish the previous frame first (rethrowing the errors of its readback or write)
+		if(renderContext)
+			renderContext->flush();
+		writerPool->wait();
 
-					out->write_scanline(y, 0, TypeDesc::UINT8, ptr);
-				}
+		const int position = coordinator->next(sequence, frames);
+		if(position >= 0) {
+			result = frame(indices[position], times[indices[position]]);
+			result.push_back(nextFrame(sequence, times, indices, frame));
+		}
 
-				out->close();
-			}
-			else
-				throw std::runtime_error("Error opening output file " + filename);
+		return result;
+	});
+}
 
-			std::cout << "done" << std::endl;
-		};
+/// creates the actions evaluating the frames of a sequence - the frames of the shard of this process, either
+///   all of them, or handed out by the coordinator one by one in a worker process
+std::vector<Action> frameActions(const std::vector<float>& times,
+                                 std::function<std::vector<Action>(std::size_t, float)> frame) {
+	const std::size_t sequence = sequence_count++;
+
+	// shards are interleaved - frames of similar complexity are spread evenly between them
+	std::vector<std::size_t> indices;
+	for(std::size_t i = shard_index; i < times.size(); i += shard_count)
+		indices.push_back(i);
+
+	if(coordinator)
+		return std::vector<Action>(1, nextFrame(sequence, times, indices, frame));
+
+	std::vector<Action> result;
+	for(std::size_t i : indices) {
+		const std::vector<Action> actions = frame(i, times[i]);
+		result.insert(result.end(), actions.begin(), actions.end());
+	}
+
+	return result;
+}
+
+std::vector<Action> render(const Options::Item& option) {
+	if(option.parameters.size() != 1)
+		throw std::runtime_error("--render option allows only exactly one filename");
+
+	const std::vector<float> times = frameTimes();
+	const std::size_t end_param = times.size() - 1;
+
+	return frameActions(times, [option, end_param](std::size_t param, float t) {
+		std::vector<Action> result;
 
 		// orbitting camera
 		Imath::V3f viewVec = viewport.eyePosition() - viewport.target();
@@ -151,10 +258,149 @@ std::vector<Action> render(const Options::Item& option) {
 		current.perspective(viewport.fowInDegrees(), viewVec.length() / 10.0f, viewVec.length() * 10.0f);
 		current.lookAt(viewport.target() + viewVec, current.target());
 
+		// the frame's time has to be set before it is drawn - the filename is expanded at the same time, as
+		//   the readback finishes only while one of the following frames is rendered
+		std::shared_ptr<std::string> frameFilename(new std::string());
+		result.push_back(Action([t, option, frameFilename]() {
+			possumwood::App::instance().setTime(t);
+			*frameFilename = expr.expand(option.parameters[0]);
+
+			return std::vector<Action>();
+		}));
+
+		RenderContext::Callback callback = [frameFilename, current](RenderContext::Pixels pixels) {
+			const std::string filename = *frameFilename;
+			std::cout << "Rendering " << filename << std::endl;
+
+			// the encoding and writing of the image runs in the background, overlapping with the
+			//   evaluation and drawing of the following frames
+			const int width = current.width();
+			const int height = current.height();
+
+			writerPool->add([filename, width, height, pixels]() {
+				std::unique_ptr<ImageOutput> out(ImageOutput::create(filename));
+				if(!out)
+					throw(std::runtime_error("Cannot write output image " + filename));
+
+				// GL rows are bottom-up - written flipped in a single call, starting from the last row with
+				//   a negative row stride
+				ImageSpec spec(width, height, 3, TypeDesc::UINT8);
+				if(out->open(filename, spec)) {
+					const stride_t rowStride = (stride_t)width * 3;
+					const GLubyte* lastRow = &((*pixels)[(height - 1) * rowStride]);
+
+					out->write_image(TypeDesc::UINT8, lastRow, AutoStride, -rowStride);
+
+					out->close();
+				}
+				else
+					throw std::runtime_error("Error opening output file " + filename);
+			});
+		};
+
 		result.push_back(renderContext->render(current, callback));
+
+		return result;
+	});
+}
+
+/// finds a port by its path in the graph - names of the nested networks and of the node, followed by
+///   the name of the port (e.g., network/node/port)
+dependency_graph::Port& findPort(const std::string& path) {
+	std::vector<std::string> names;
+	boost::split(names, path, boost::is_any_of("/"));
+	if(names.size() < 2)
+		throw std::runtime_error("Port path " + path + " should contain at least a node name and a port name");
+
+	dependency_graph::Network* network = &papp->graph();
+	for(std::size_t n = 0; n + 1 < names.size(); ++n) {
+		auto it = std::find_if(network->nodes().begin(), network->nodes().end(),
+		                       [&](const dependency_graph::NodeBase& node) { return node.name() == names[n]; });
+		if(it == network->nodes().end())
+			throw std::runtime_error("Node " + names[n] + " of port path " + path + " not found");
+
+		// loading a network's content recreates its ports - done before the port is returned
+		if(it->is<dependency_graph::Network>())
+			it->as<dependency_graph::Network>().load();
+
+		if(n + 2 == names.size()) {
+			for(std::size_t p = 0; p < it->portCount(); ++p)
+				if(it->port(p).name() == names.back())
+					return it->port(p);
+
+			throw std::runtime_error("Port " + names.back() + " of port path " + path + " not found");
+		}
+
+		if(!it->is<dependency_graph::Network>())
+			throw std::runtime_error("Node " + names[n] + " of port path " + path + " is not a network");
+		network = &it->as<dependency_graph::Network>();
 	}
 
-	return result;
+	throw std::runtime_error("Port " + path + " not found");
+}
+
+/// writes a value to a file - using its image writer, if one is registered for the value type, or as JSON
+void writeValue(const std::string& filename, const dependency_graph::Data& value) {
+	if(possumwood::io::hasImageWriter(value) && boost::filesystem::path(filename).extension() != ".json")
+		possumwood::io::writeImage(filename, value);
+
+	else {
+		if(!dependency_graph::io::isSaveable(value))
+			throw std::runtime_error("Values of type " + value.type() + " cannot be written to a file");
+
+		nlohmann::json json;
+		possumwood::io::toJson(json, value);
+
+		std::ofstream file(filename);
+		file << std::setw(4) << json;
+		if(!file.good())
+			throw std::runtime_error("Error writing to " + filename);
+	}
+}
+
+std::vector<Action> evaluate(const Options::Item& option) {
+	if(option.parameters.empty() || option.parameters.size() > 2)
+		throw std::runtime_error("--eval option allows only a port path and an optional filename");
+
+	// fails early on a port path that can't be resolved
+	findPort(option.parameters[0]);
+
+	return frameActions(frameTimes(), [option](std::size_t, float t) {
+		return std::vector<Action>(1, Action([option, t]() {
+			possumwood::App::instance().setTime(t);
+
+			// the port is resolved for each frame - a later --scene option replaces the whole graph
+			dependency_graph::Port& port = findPort(option.parameters[0]);
+
+			std::cout << "Evaluating " << option.parameters[0] << " at frame " << currentFrame() << "... "
+			          << std::flush;
+
+			// networks with a deferred load in the upstream are loaded before the evaluation (its port
+			//   is already loaded by findPort())
+			port.loadDeferredNetworks();
+
+			const auto start = std::chrono::steady_clock::now();
+			// a copy - the written value stays valid while the following frames are evaluated
+			const dependency_graph::Data value = port.getData();
+			const auto duration = std::chrono::steady_clock::now() - start;
+
+			std::cout << "done in " << std::fixed << std::setprecision(2)
+			          << std::chrono::duration<float, std::milli>(duration).count() << "ms" << std::endl;
+
+			printState(port.node().state());
+			if(port.node().state().errored())
+				throw std::runtime_error("Error evaluating " + option.parameters[0] + ". Exiting.");
+
+			if(option.parameters.size() > 1) {
+				const std::string filename = expr.expand(option.parameters[1]);
+				writerPool->add([filename, value]() { writeValue(filename, value); });
+
+				std::cout << "  writing to " << filename << std::endl;
+			}
+
+			return std::vector<Action>();
+		}));
+	});
 }
 
 std::vector<Action> evaluateOption(const Options::const_iterator& current) {
@@ -166,9 +412,43 @@ std::vector<Action> evaluateOption(const Options::const_iterator& current) {
 	else if(option.name == "--render")
 		return render(option);
 
+	else if(option.name == "--eval")
+		return evaluate(option);
+
 	else if(option.name == "--help")
 		printHelp();
 
+	else if(option.name == "--frames") {
+		int first = 0, last = 0;
+		char rest = 0;
+		if(option.parameters.size() != 1 ||
+		   (sscanf(option.parameters[0].c_str(), "%d-%d%c", &first, &last, &rest) != 2 &&
+		    sscanf(option.parameters[0].c_str(), "%d%c", &first, &rest) != 1))
+			throw std::runtime_error("--frames option allows only exactly one frame or frame range (e.g., 10-20)");
+
+		if(option.parameters[0].find('-', 1) == std::string::npos)
+			last = first;
+		if(last < first)
+			throw std::runtime_error("--frames option range " + option.parameters[0] + " is empty");
+
+		frame_range = std::make_pair(first, last);
+	}
+
+	else if(option.name == "--shard") {
+		unsigned index = 0, count = 0;
+		char rest = 0;
+		if(option.parameters.size() != 1 ||
+		   sscanf(option.parameters[0].c_str(), "%u/%u%c", &index, &count, &rest) != 2 || index >= count)
+			throw std::runtime_error("--shard option allows only exactly one shard index and count (e.g., 2/8)");
+
+		shard_index = index;
+		shard_count = count;
+	}
+
+	else if(option.name == "--workers") {
+		// already handled before any evaluation (see main())
+	}
+
 	else if(option.name == "--frame_step") {
 		if(option.parameters.size() != 1)
 			throw std::runtime_error("--frame_step option allows only exactly one integer parameter");
@@ -205,6 +485,40 @@ std::vector<Action> evaluateOption(const Options::const_iterator& current) {
 		cam_orbit = atof(option.parameters[0].c_str());
 	}
 
+	else if(option.name == "--cache") {
+		if(option.parameters.size() != 1)
+			throw std::runtime_error("--cache option allows only exactly one directory");
+
+		papp->graph().setComputeCache(std::make_shared<possumwood::DiskCache>(option.parameters[0]));
+	}
+
+	else if(option.name == "--memory_budget") {
+		if(option.parameters.size() != 1)
+			throw std::runtime_error("--memory_budget option allows only exactly one integer parameter");
+
+		const std::size_t budget = std::stoul(option.parameters[0]) * 1024 * 1024;
+		papp->graph().setMemoryGovernor(std::make_shared<dependency_graph::MemoryGovernor>(budget));
+	}
+
+	else if(option.name == "--profile") {
+		if(option.parameters.size() != 1)
+			throw std::runtime_error("--profile option allows only exactly one filename");
+
+		profile_filename = option.parameters[0];
+		papp->graph().setProfiler(std::make_shared<dependency_graph::Profiler>());
+	}
+
+	else if(option.name == "--writers") {
+		if(option.parameters.size() != 1)
+			throw std::runtime_error("--writers option allows only exactly one integer parameter");
+
+		const unsigned count = std::stoul(option.parameters[0]);
+
+		// the previous pool finishes its writes first
+		writerPool->wait();
+		writerPool.reset(new WriterPool(count, 2 * count));
+	}
+
 	else if(option.name == "--window") {
 		if(option.parameters.size() != 2)
 			throw std::runtime_error("--window option allows only exactly two integer parameters");
@@ -228,6 +542,25 @@ std::vector<Action> evaluateOptions(const Options& options) {
 }
 
 int main(int argc, char* argv[]) {
+	// parse the program options
+	Options options(argc, argv);
+
+	// local coordinator - forks the worker processes before any other initialisation (each worker has its
+	//   own plugins, App and GL context), and only distributes the frames between them
+	auto workersParamIt = std::find_if(options.begin(), options.end(),
+	                                   [](const Options::Item& item) { return item.name == "--workers"; });
+
+	unsigned workers = 1;
+	if(workersParamIt != options.end()) {
+		if(workersParamIt->parameters.size() != 1)
+			throw std::runtime_error("--workers option allows only exactly one integer parameter");
+
+		workers = std::stoul(workersParamIt->parameters[0]);
+		coordinator = std::unique_ptr<Coordinator>(new Coordinator(workers));
+		if(!coordinator->isWorker())
+			return coordinator->run();
+	}
+
 	// static initialiser for the dependency graph library
 	std::unique_ptr<dependency_graph::StaticInitialisation> initialiser(new dependency_graph::StaticInitialisation());
 
@@ -237,8 +570,10 @@ int main(int argc, char* argv[]) {
 	// load all plugins into an RAII container
 	PluginsRAII plugins;
 
-	// parse the program options
-	Options options(argc, argv);
+	// background writers - at most two pending results per thread, to bound the memory of queued frames
+	//   (the cores are shared by all worker processes)
+	const unsigned cores = std::max(1u, std::thread::hardware_concurrency() / workers);
+	writerPool = std::unique_ptr<WriterPool>(new WriterPool(cores, 2 * cores));
 
 	// populate the initial action
 	Stack s;
@@ -265,6 +600,27 @@ int main(int argc, char* argv[]) {
 			s.step();
 	}
 
+	// wait for all results to be written
+	writerPool->wait();
+	writerPool.reset();
+
+	// report the last frame to the coordinator
+	coordinator.reset();
+
+	// write the evaluation profile (one per worker process)
+	if(papp->graph().profiler()) {
+		if(workersParamIt != options.end())
+			profile_filename += "." + std::to_string(getpid());
+
+		std::ofstream profile(profile_filename);
+		papp->graph().profiler()->writeChromeTrace(profile);
+
+		if(profile.good())
+			std::cout << "Evaluation profile saved to " << profile_filename << std::endl;
+		else
+			std::cerr << "Error saving the evaluation profile to " << profile_filename << std::endl;
+	}
+
 	// explicitly destroy the app object before exiting, to avoid initialisation order problems
 	papp.reset();
 
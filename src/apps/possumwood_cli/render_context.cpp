@@ -5,7 +5,11 @@
 #include <possumwood_sdk/gl.h>
 #include <possumwood_sdk/metadata.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <chrono>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -72,7 +76,7 @@ std::pair<unsigned, unsigned> findGLVersion() {
 
 }  // namespace
 
-RenderContext::RenderContext(const possumwood::ViewportState& viewport) : m_window(nullptr) {
+RenderContext::RenderContext(const possumwood::ViewportState& viewport) : m_window(nullptr), m_nextReadback(0) {
 	ensureGLFWInitialised();
 
 	std::pair<unsigned, unsigned> gl_ver = findGLVersion();
@@ -99,6 +103,13 @@ RenderContext::~RenderContext() {
 	// https://sourceforge.net/p/freeglut/mailman/freeglut-developer/thread/BANLkTin7n06HnopO5qSiUgUBrN3skAWDyA@mail.gmail.com/
 	ensureGLFWInitialised();
 
+	for(auto& r : m_readbacks) {
+		if(r.fence)
+			glDeleteSync(r.fence);
+		if(r.buffer)
+			glDeleteBuffers(1, &r.buffer);
+	}
+
 	glfwDestroyWindow(m_window);
 }
 
@@ -130,15 +141,12 @@ void draw(const possumwood::ViewportState& viewport) {
 
 }  // namespace
 
-Action RenderContext::render(const possumwood::ViewportState& viewport,
-                             std::function<void(std::vector<GLubyte>&)> callback) {
+Action RenderContext::render(const possumwood::ViewportState& viewport, Callback callback) {
 	return Action([this, viewport, callback]() {
 		std::vector<Action> actions;
 
-		std::shared_ptr<std::vector<GLubyte>> data(new std::vector<GLubyte>(viewport.width() * viewport.height() * 3));
-
 		// initialisation
-		actions.push_back(Action([this, data, viewport]() -> std::vector<Action> {
+		actions.push_back(Action([this, viewport]() -> std::vector<Action> {
 			ensureGLFWInitialised();
 
 			glfwSetWindowSize(m_window, viewport.width(), viewport.height());
@@ -160,19 +168,12 @@ Action RenderContext::render(const possumwood::ViewportState& viewport,
 			return std::vector<Action>();
 		}));
 
-		// reading back the buffers
-		actions.push_back(Action([data, callback, viewport] {
-			GL_CHECK_ERR
-
-			glReadBuffer(GL_BACK);
-
+		// reading back the buffers - only started here, the pixels are passed to the callback
+		//   while a later frame is rendered
+		actions.push_back(Action([this, callback, viewport] {
 			GL_CHECK_ERR
 
-			glReadPixels(0, 0, viewport.width(), viewport.height(), GL_RGB, GL_UNSIGNED_BYTE, &(*data)[0]);
-
-			GL_CHECK_ERR
-
-			callback(*data);
+			startReadback(viewport.width(), viewport.height(), callback);
 
 			GL_CHECK_ERR
 
@@ -183,6 +184,97 @@ Action RenderContext::render(const possumwood::ViewportState& viewport,
 	});
 }
 
+void RenderContext::startReadback(int width, int height, Callback callback) {
+	Readback& r = m_readbacks[m_nextReadback];
+	m_nextReadback = (m_nextReadback + 1) % m_readbacks.size();
+
+	// the buffer is reused - the frame it holds has to be finished first
+	if(r.fence)
+		finishReadback(r);
+
+	const std::size_t size = width * height * 3;
+	if(r.buffer == 0)
+		glGenBuffers(1, &r.buffer);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer);
+	if(r.size != size) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		r.size = size;
+	}
+
+	// tightly packed rows (the default alignment of 4 doesn't match RGB rows of any width)
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	r.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	r.width = width;
+	r.height = height;
+	r.callback = callback;
+}
+
+void RenderContext::finishReadback(Readback& r) {
+	assert(r.fence);
+
+	Callback callback;
+	std::swap(callback, r.callback);
+
+	const GLenum wait = glClientWaitSync(r.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	glDeleteSync(r.fence);
+	r.fence = 0;
+
+	if(wait == GL_WAIT_FAILED)
+		throw std::runtime_error("Error waiting for the readback of a frame");
+
+	std::shared_ptr<std::vector<GLubyte>> data = hostBuffer(r.width * r.height * 3);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer);
+	const void* ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, data->size(), GL_MAP_READ_BIT);
+	if(ptr) {
+		std::memcpy(data->data(), ptr, data->size());
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	GL_CHECK_ERR
+
+	if(!ptr)
+		throw std::runtime_error("Error mapping the readback buffer");
+
+	callback(data);
+}
+
+std::shared_ptr<std::vector<GLubyte>> RenderContext::hostBuffer(std::size_t size) {
+	// a buffer referenced only by the pool was released by all previous callbacks (a pointer can't be copied
+	//   again once released, so the test is safe even with the callbacks' copies held by other threads)
+	auto it = std::find_if(m_hostBuffers.begin(), m_hostBuffers.end(),
+	                       [](const std::shared_ptr<std::vector<GLubyte>>& b) { return b.use_count() == 1; });
+
+	if(it == m_hostBuffers.end()) {
+		m_hostBuffers.push_back(std::make_shared<std::vector<GLubyte>>());
+		it = m_hostBuffers.end() - 1;
+	}
+	else
+		// the new frame is written only after all reads of the released copies
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+	// the same size keeps the allocation of the buffer
+	(*it)->resize(size);
+
+	return *it;
+}
+
+void RenderContext::flush() {
+	// oldest readbacks first
+	for(std::size_t i = 0; i < m_readbacks.size(); ++i) {
+		Readback& r = m_readbacks[(m_nextReadback + i) % m_readbacks.size()];
+		if(r.fence)
+			finishReadback(r);
+	}
+}
+
 void RenderContext::run(Stack& stack) {
 	using namespace std::chrono_literals;
 
@@ -195,4 +287,6 @@ void RenderContext::run(Stack& stack) {
 		// a little delay to allow GLFW to run its "idle" loop
 		std::this_thread::sleep_for(10ms);
 	}
+
+	flush();
 }
@@ -5,6 +5,9 @@
 #include <GL/gl.h>
 #include <GL/glu.h>
 
+#include <array>
+#include <functional>
+#include <memory>
 #include <vector>
 
 /// WHY?
@@ -24,13 +27,52 @@ class RenderContext {
 	RenderContext(const possumwood::ViewportState& viewport);
 	~RenderContext();
 
+	/// runs all actions of the stack, and finishes all pending readbacks afterwards
 	void run(Stack& stack);
 
-	Action render(const possumwood::ViewportState& viewport, std::function<void(std::vector<GLubyte>&)> callback);
+	/// pixels of a frame (bottom-up rows of RGB values) - a pooled buffer, reused for a later frame once
+	///   all copies of the pointer are released (e.g., by a background writer)
+	typedef std::shared_ptr<const std::vector<GLubyte>> Pixels;
+	typedef std::function<void(Pixels)> Callback;
+
+	/// renders a frame, and reads it back asynchronously - the callback receives the frame's pixels
+	///   once they are available, while the following frames are drawn
+	Action render(const possumwood::ViewportState& viewport, Callback callback);
+
+	/// waits for all pending readbacks, and calls their callbacks (in the order of rendering)
+	void flush();
 
   private:
 	RenderContext(const RenderContext&) = delete;
 	RenderContext& operator=(const RenderContext&) = delete;
 
+	/// a frame read back into a pixel buffer object, not blocking the GL pipeline
+	struct Readback {
+		Readback() : buffer(0), size(0), fence(0), width(0), height(0) {
+		}
+
+		GLuint buffer;
+		std::size_t size;
+
+		GLsync fence;
+		int width, height;
+		Callback callback;
+	};
+
+	// starts a readback of the current frame into the next buffer of the ring (finishing its previous
+	//   readback first)
+	void startReadback(int width, int height, Callback callback);
+	// waits for a readback to finish, maps its buffer and calls its callback
+	void finishReadback(Readback& readback);
+	// returns a host buffer not used by any previous callback (allocating a new one only if all are in use)
+	std::shared_ptr<std::vector<GLubyte>> hostBuffer(std::size_t size);
+
 	GLFWwindow* m_window;
+
+	// a ring of persistent pixel buffers - a frame is mapped only when its buffer is needed again
+	std::array<Readback, 3> m_readbacks;
+	std::size_t m_nextReadback;
+
+	// a pool of host buffers the frames are copied to - a buffer is in use while referenced outside the pool
+	std::vector<std::shared_ptr<std::vector<GLubyte>>> m_hostBuffers;
 };
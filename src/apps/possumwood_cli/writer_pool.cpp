@@ -0,0 +1,91 @@
+#include "writer_pool.h"
+
+#include <algorithm>
+
+WriterPool::WriterPool(unsigned threads, std::size_t maxPending)
+    : m_maxPending(std::max<std::size_t>(maxPending, 1)), m_running(0), m_finished(false) {
+	for(unsigned t = 0; t < threads; ++t)
+		m_threads.push_back(std::thread([this]() { run(); }));
+}
+
+WriterPool::~WriterPool() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_finished = true;
+	}
+	m_changed.notify_all();
+
+	// the threads finish all queued writes before exiting
+	for(auto& t : m_threads)
+		t.join();
+}
+
+void WriterPool::add(const std::function<void()>& write) {
+	if(m_threads.empty()) {
+		write();
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_changed.wait(lock, [this]() { return m_queue.size() + m_running < m_maxPending || m_error; });
+
+		if(m_error) {
+			std::exception_ptr error = m_error;
+			m_error = nullptr;
+			std::rethrow_exception(error);
+		}
+
+		m_queue.push_back(write);
+	}
+
+	m_changed.notify_all();
+}
+
+void WriterPool::wait() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_changed.wait(lock, [this]() { return m_queue.empty() && m_running == 0; });
+
+	if(m_error) {
+		std::exception_ptr error = m_error;
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+std::size_t WriterPool::threadCount() const {
+	return m_threads.size();
+}
+
+void WriterPool::run() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while(true) {
+		m_changed.wait(lock, [this]() { return !m_queue.empty() || m_finished; });
+		if(m_queue.empty())
+			return;
+
+		std::function<void()> write = std::move(m_queue.front());
+		m_queue.pop_front();
+		++m_running;
+
+		lock.unlock();
+
+		std::exception_ptr error;
+		try {
+			write();
+		}
+		catch(...) {
+			error = std::current_exception();
+		}
+
+		lock.lock();
+
+		--m_running;
+		// only the first error is reported
+		if(error && !m_error)
+			m_error = error;
+
+		m_changed.notify_all();
+	}
+}
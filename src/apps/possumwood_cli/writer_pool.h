@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A pool of background threads writing the results of the CLI (image encoding and file writes),
+/// allowing the main thread to continue with the evaluation and rendering of the next frame.
+/// The number of pending writes is limited, to bound the memory held by the queued results.
+class WriterPool {
+  public:
+	/// creates a pool with a number of threads - a pool without any threads runs all writes synchronously
+	WriterPool(unsigned threads, std::size_t maxPending);
+	/// waits for all pending writes (without reporting their errors - use wait() for that)
+	~WriterPool();
+
+	/// queues a write, blocking while the number of pending writes is at the limit. Rethrows the error
+	///   of a previously failed write.
+	void add(const std::function<void()>& write);
+
+	/// waits for all pending writes to finish, and rethrows the error of a failed write
+	void wait();
+
+	std::size_t threadCount() const;
+
+  private:
+	WriterPool(const WriterPool&) = delete;
+	WriterPool& operator=(const WriterPool&) = delete;
+
+	void run();
+
+	std::vector<std::thread> m_threads;
+	std::size_t m_maxPending;
+
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::deque<std::function<void()>> m_queue;
+	std::size_t m_running;
+	bool m_finished;
+	std::exception_ptr m_error;
+};
@@ -1,8 +1,10 @@
 #include "actions.h"
 
 #include <functional>
+#include <memory>
 #include <set>
 #include <iomanip>
+#include <sstream>
 
 #include <dependency_graph/attr_map.h>
 #include <dependency_graph/detail.h>
@@ -16,6 +18,7 @@
 #include "app.h"
 #include "clipboard.h"
 #include "detail/connections.h"
+#include "detail/instances.h"
 #include "detail/metadata.h"
 #include "detail/nodes.h"
 #include "detail/tools.h"
@@ -189,6 +192,9 @@ nlohmann::json writeNetwork(const dependency_graph::Network& net, const dependen
 	// source set - write just the filename to load from, not the content
 	else {
 		j["source"] = net.source().string();
+
+		if(detail::NetworkTemplate::isInstance(net.metadata()))
+			j["instanced"] = true;
 	}
 
 	return j;
@@ -225,23 +231,14 @@ dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
                                      const dependency_graph::UniqueId& targetIndex,
                                      const nlohmann::json& _source,
                                      PasteFlags flags,
-                                     std::set<dependency_graph::UniqueId>* ids = nullptr) {
-	dependency_graph::State state;
-	nlohmann::json tmp;
-
-	// pasted network should actually be loaded from a file
-	const nlohmann::json* source = nullptr;
-	if(_source.find("source") != _source.end()) {
-		auto stream = AppCore::instance().filesystem().read(
-		    possumwood::Filepath::fromString(_source["source"].get<std::string>()));
-		(*stream) >> tmp;
+                                     std::set<dependency_graph::UniqueId>* ids = nullptr);
 
-		source = &tmp;
-	}
-	// should be loaded from the json directly
-	else {
-		source = &_source;
-	}
+/// pastes the nodes and connections of a network (not its ports or source)
+dependency_graph::State pasteContent(possumwood::UndoStack::Action& action,
+                                     const dependency_graph::UniqueId& targetIndex,
+                                     const nlohmann::json* source,
+                                     std::set<dependency_graph::UniqueId>* ids) {
+	dependency_graph::State state;
 
 	// indices of newly loaded nodes
 	std::map<std::string, dependency_graph::UniqueId> nodeIds;
@@ -301,8 +298,10 @@ dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
 		}
 	}
 
-	// add all connections, based on "unique" IDs
+	// add all connections, based on "unique" IDs - as a single batch, validated at once
 	if(source->find("connections") != source->end()) {
+		std::vector<detail::NamedConnection> connections;
+
 		for(auto& c : (*source)["connections"]) {
 			auto id1 = nodeIds.find(c["out_node"].get<std::string>());
 			auto port1 = c["out_port"].get<std::string>();
@@ -319,10 +318,74 @@ dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
 				               "' cannot be added!");
 
 			if(id1 != nodeIds.end() && id2 != nodeIds.end())
-				action.append(detail::connectAction(id1->second, port1, id2->second, port2));
+				connections.push_back(detail::NamedConnection{id1->second, port1, id2->second, port2});
 		}
+
+		action.append(detail::connectAction(connections));
 	}
 
+	return state;
+}
+
+/// loads the content of a network with a deferred load, from the content of its source file
+dependency_graph::State loadContent(dependency_graph::Network& network, std::shared_ptr<const nlohmann::json> source) {
+	possumwood::UndoStack::Action action;
+	dependency_graph::State state = pasteContent(action, network.index(), source.get(), nullptr);
+
+	// the loading is not undoable - the content is a part of the network (removed with it)
+	dependency_graph::Graph::BulkBuild bulkBuild(network.graph());
+	possumwood::UndoStack tmpStack;
+	state.append(tmpStack.execute(action, false));
+
+	return state;
+}
+
+dependency_graph::State pasteNetwork(possumwood::UndoStack::Action& action,
+                                     const dependency_graph::UniqueId& targetIndex,
+                                     const nlohmann::json& _source,
+                                     PasteFlags flags,
+                                     std::set<dependency_graph::UniqueId>* ids) {
+	dependency_graph::State state;
+	std::shared_ptr<nlohmann::json> tmp;
+
+	// pasted network should actually be loaded from a file
+	const nlohmann::json* source = nullptr;
+	if(_source.find("source") != _source.end()) {
+		auto stream = AppCore::instance().filesystem().read(
+		    possumwood::Filepath::fromString(_source["source"].get<std::string>()));
+
+		tmp = std::make_shared<nlohmann::json>();
+		(*stream) >> *tmp;
+
+		source = tmp.get();
+	}
+	// should be loaded from the json directly
+	else {
+		source = &_source;
+	}
+
+	const dependency_graph::Network::Loader loader =
+	    std::bind(&loadContent, std::placeholders::_1, std::shared_ptr<const nlohmann::json>(tmp));
+
+	// an instanced network with a source file - no content, evaluated by a template shared with all
+	//   other instances of the same source
+	boost::optional<dependency_graph::MetadataHandle> instance;
+	if(tmp && !(flags & kRoot) && _source.value("instanced", false))
+		instance = detail::NetworkTemplate::instance(_source["source"].get<std::string>(), *source, loader);
+
+	// a network with a source file, with ports that can be determined without instantiating its content -
+	//   the content is only loaded when first needed (see Network::load())
+	boost::optional<dependency_graph::MetadataHandle> ports;
+	if(tmp && !(flags & kRoot) && !instance)
+		ports = detail::networkMetadata(*source);
+
+	if(instance)
+		action.append(detail::deferredLoadAction(targetIndex, *instance, dependency_graph::Network::Loader()));
+	else if(ports)
+		action.append(detail::deferredLoadAction(targetIndex, *ports, loader));
+	else
+		state.append(pasteContent(action, targetIndex, source, ids));
+
 	// and add the "source" if any, with a compressed filepath
 	if(_source.find("source") != _source.end() && !(flags & kRoot)) {
 		action.append(detail::setSourceAction(
@@ -375,7 +438,8 @@ dependency_graph::State paste(dependency_graph::Network& current,
 dependency_graph::State fromJson(dependency_graph::Network& current,
                                  dependency_graph::Selection& selection,
                                  const nlohmann::json& json,
-                                 bool haltOnError) {
+                                 bool haltOnError,
+                                 bool bulkBuild) {
 	dependency_graph::State state;
 
 	possumwood::UndoStack::Action action;
@@ -385,8 +449,15 @@ dependency_graph::State fromJson(dependency_graph::Network& current,
 	// paste the network extracted from the JSON
 	state.append(pasteNetwork(action, current.index(), json, kRoot, &pastedNodeIds));
 
-	// execute the action (will actually make the nodes and connections)
-	state.append(possumwood::AppCore::instance().undoStack().execute(action, haltOnError));
+	// execute the action (will actually make the nodes and connections) - as a bulk build by default,
+	//   deferring the graph callbacks and the dirtiness propagation to the end of the whole action
+	{
+		std::unique_ptr<dependency_graph::Graph::BulkBuild> build;
+		if(bulkBuild)
+			build.reset(new dependency_graph::Graph::BulkBuild(possumwood::AppCore::instance().graph()));
+
+		state.append(possumwood::AppCore::instance().undoStack().execute(action, haltOnError));
+	}
 
 	// and make the selection based on added nodes
 	for(auto& n : pastedNodeIds)
@@ -419,9 +490,15 @@ void changeMetadata(dependency_graph::NodeBase& node, const dependency_graph::Me
 	possumwood::AppCore::instance().undoStack().execute(action);
 }
 
-void setValue(dependency_graph::Port& port, const dependency_graph::Data& value) {
+void setValue(dependency_graph::Port& port, const dependency_graph::Data& value, bool mergeable) {
 	possumwood::UndoStack::Action action = detail::setValueAction(port, value);
 
+	if(mergeable) {
+		std::stringstream key;
+		key << "Setting value of " << port.node().index() << "/" << port.index();
+		action.setMergeKey(key.str());
+	}
+
 	AppCore::instance().undoStack().execute(action);
 }
 
@@ -19,9 +19,11 @@ void removeNode(dependency_graph::NodeBase& node);
 void connect(dependency_graph::Port& p1, dependency_graph::Port& p2);
 void disconnect(dependency_graph::Port& p1, dependency_graph::Port& p2);
 
+/// Mergeable value changes of the same port in a quick succession (e.g., a series of changes while
+/// dragging a slider) form a single undo step.
 template <typename T>
-void setValue(dependency_graph::Port& p, const T& value);
-void setValue(dependency_graph::Port& p, const dependency_graph::Data& value);
+void setValue(dependency_graph::Port& p, const T& value, bool mergeable = false);
+void setValue(dependency_graph::Port& p, const dependency_graph::Data& value, bool mergeable = false);
 
 void changeMetadata(dependency_graph::NodeBase& node, const dependency_graph::MetadataHandle& handle);
 void renameNode(dependency_graph::NodeBase& node, const std::string& name);
@@ -35,8 +37,10 @@ void remove(const dependency_graph::Selection& selection);
 
 void move(const std::map<dependency_graph::NodeBase*, possumwood::NodeData::Point>& nodes);
 
+/// creates the network described by the json inside the current network - as a bulk build of the graph
+/// (see dependency_graph::Graph::BulkBuild), unless bulkBuild is false
 dependency_graph::State fromJson(dependency_graph::Network& current, dependency_graph::Selection& selection,
-                                 const nlohmann::json& json, bool haltOnError = true);
+                                 const nlohmann::json& json, bool haltOnError = true, bool bulkBuild = true);
 nlohmann::json toJson(const dependency_graph::Selection& selection = dependency_graph::Selection());
 
 dependency_graph::State importNetwork(dependency_graph::Network& current, dependency_graph::Selection& selection,
@@ -46,8 +50,8 @@ dependency_graph::State importNetwork(dependency_graph::Network& current, depend
 ////
 
 template <typename T>
-void setValue(dependency_graph::Port& p, const T& value) {
-	setValue(p, dependency_graph::Data(value));
+void setValue(dependency_graph::Port& p, const T& value, bool mergeable) {
+	setValue(p, dependency_graph::Data(value), mergeable);
 }
 
 }  // namespace actions
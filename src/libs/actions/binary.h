@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace possumwood {
+namespace binary {
+
+/// Helpers for implementing binary serializations of data types (see BinaryIO). Integers are
+/// stored little-endian with a fixed size. Arrays of trivially copyable values (floats, Imath vectors,
+/// pixels) are stored as raw memory, i.e., in the little-endian IEEE layout of all supported platforms.
+/// All read functions throw std::runtime_error on a premature end of the stream.
+
+template <typename T>
+void writeInt(std::ostream& out, T value) {
+	static_assert(std::is_integral<T>::value, "only integers can be written using writeInt()");
+	typedef typename std::make_unsigned<T>::type U;
+
+	char buffer[sizeof(T)];
+	for(std::size_t b = 0; b < sizeof(T); ++b)
+		buffer[b] = static_cast<char>((static_cast<U>(value) >> (b * 8)) & 0xff);
+	out.write(buffer, sizeof(T));
+}
+
+template <typename T>
+T readInt(std::istream& in) {
+	static_assert(std::is_integral<T>::value, "only integers can be read using readInt()");
+	typedef typename std::make_unsigned<T>::type U;
+
+	unsigned char buffer[sizeof(T)];
+	if(!in.read(reinterpret_cast<char*>(buffer), sizeof(T)))
+		throw std::runtime_error("Error reading binary data - unexpected end of stream.");
+
+	U result = 0;
+	for(std::size_t b = 0; b < sizeof(T); ++b)
+		result |= static_cast<U>(buffer[b]) << (b * 8);
+	return static_cast<T>(result);
+}
+
+/// writes an array of trivially copyable values as raw memory
+template <typename T>
+void writeRaw(std::ostream& out, const T* data, std::size_t count) {
+	static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be written as raw memory");
+	out.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+/// reads an array of trivially copyable values written by writeRaw()
+template <typename T>
+void readRaw(std::istream& in, T* data, std::size_t count) {
+	static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be read as raw memory");
+	if(!in.read(reinterpret_cast<char*>(data), count * sizeof(T)))
+		throw std::runtime_error("Error reading binary data - unexpected end of stream.");
+}
+
+/// reads an element count, checking it against a sane upper limit (corrupted data should not lead
+/// to huge allocations)
+inline std::size_t readCount(std::istream& in) {
+	const std::uint64_t count = readInt<std::uint64_t>(in);
+	if(count > std::numeric_limits<std::uint32_t>::max())
+		throw std::runtime_error("Error reading binary data - invalid element count.");
+	return count;
+}
+
+inline void writeString(std::ostream& out, const std::string& str) {
+	writeInt<std::uint64_t>(out, str.size());
+	out.write(str.data(), str.size());
+}
+
+inline std::string readString(std::istream& in) {
+	std::string result(readCount(in), '\0');
+	if(!result.empty())
+		readRaw(in, &result[0], result.size());
+	return result;
+}
+
+/// writes a vector of trivially copyable values (its size, followed by its raw content)
+template <typename T>
+void writeVector(std::ostream& out, const std::vector<T>& data) {
+	writeInt<std::uint64_t>(out, data.size());
+	if(!data.empty())
+		writeRaw(out, data.data(), data.size());
+}
+
+template <typename T>
+void readVector(std::istream& in, std::vector<T>& data) {
+	data.resize(readCount(in));
+	if(!data.empty())
+		readRaw(in, data.data(), data.size());
+}
+
+}  // namespace binary
+}  // namespace possumwood
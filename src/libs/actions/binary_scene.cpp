@@ -0,0 +1,160 @@
+#include "binary_scene.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+
+#include "binary.h"
+
+namespace possumwood {
+
+namespace {
+
+const char s_magic[] = "PSWB";
+const std::uint32_t s_version = 1;
+
+const char s_sceneTag[] = "SCNE";
+const char s_valueTag[] = "VALU";
+
+thread_local BinarySceneWriter* s_currentWriter = nullptr;
+thread_local BinarySceneReader* s_currentReader = nullptr;
+
+using binary::readInt;
+using binary::writeInt;
+
+void writeChunk(std::ostream& out, const char* tag, const char* data, std::uint64_t size) {
+	out.write(tag, 4);
+	writeInt<std::uint64_t>(out, size);
+	out.write(data, size);
+}
+
+}  // namespace
+
+BinarySceneWriter::BinarySceneWriter() : m_previous(s_currentWriter) {
+	s_currentWriter = this;
+}
+
+BinarySceneWriter::~BinarySceneWriter() {
+	assert(s_currentWriter == this);
+	s_currentWriter = m_previous;
+}
+
+BinarySceneWriter* BinarySceneWriter::current() {
+	return s_currentWriter;
+}
+
+std::size_t BinarySceneWriter::add(const dependency_graph::Data& data) {
+	std::ostringstream ss(std::ios::binary);
+	io::writeBinary(ss, data);
+
+	m_values.push_back(ss.str());
+	return m_values.size() - 1;
+}
+
+void BinarySceneWriter::write(std::ostream& out, const nlohmann::json& scene) const {
+	out.write(s_magic, 4);
+	writeInt<std::uint32_t>(out, s_version);
+
+	// the scene first, allowing the reader to skip over the values without reading them
+	const std::vector<std::uint8_t> cbor = nlohmann::json::to_cbor(scene);
+	writeChunk(out, s_sceneTag, reinterpret_cast<const char*>(cbor.data()), cbor.size());
+
+	for(auto& v : m_values)
+		writeChunk(out, s_valueTag, v.data(), v.size());
+
+	if(!out.good())
+		throw std::runtime_error("Error writing a binary scene.");
+}
+
+/////////////////////////////////////
+
+BinarySceneReader::BinarySceneReader(std::istream& in) : m_in(in), m_previous(s_currentReader) {
+	if(!isBinaryScene(in))
+		throw std::runtime_error("Error reading a binary scene - not a binary Possumwood scene file.");
+	in.seekg(4, std::ios::cur);
+
+	const std::uint32_t version = readInt<std::uint32_t>(in);
+	if(version > s_version)
+		throw std::runtime_error("Error reading a binary scene - unsupported format version " +
+		                         std::to_string(version) + ".");
+
+	bool sceneFound = false;
+	while(in.peek() != std::char_traits<char>::eof()) {
+		char tag[4];
+		if(!in.read(tag, 4))
+			throw std::runtime_error("Error reading a binary scene - unexpected end of file.");
+		const std::uint64_t size = readInt<std::uint64_t>(in);
+		const std::streamoff offset = in.tellg();
+
+		if(std::string(tag, 4) == s_sceneTag) {
+			std::vector<std::uint8_t> cbor(size);
+			if(!in.read(reinterpret_cast<char*>(cbor.data()), size))
+				throw std::runtime_error("Error reading a binary scene - unexpected end of file.");
+
+			m_scene = nlohmann::json::from_cbor(cbor);
+			sceneFound = true;
+		}
+
+		else {
+			// values (and unknown chunks) are skipped here - the values are read when the nodes are created
+			if(std::string(tag, 4) == s_valueTag)
+				m_values.push_back(std::make_pair(offset, size));
+
+			if(!in.seekg(offset + static_cast<std::streamoff>(size)))
+				throw std::runtime_error("Error reading a binary scene - unexpected end of file.");
+		}
+	}
+
+	if(!sceneFound)
+		throw std::runtime_error("Error reading a binary scene - no scene chunk found.");
+
+	// only registered when fully constructed
+	s_currentReader = this;
+}
+
+BinarySceneReader::~BinarySceneReader() {
+	assert(s_currentReader == this);
+	s_currentReader = m_previous;
+}
+
+const nlohmann::json& BinarySceneReader::scene() const {
+	return m_scene;
+}
+
+bool BinarySceneReader::isBinaryScene(std::istream& in) {
+	const std::streampos pos = in.tellg();
+
+	char magic[4];
+	const bool result = in.read(magic, 4) && std::string(magic, 4) == s_magic;
+
+	in.clear();
+	in.seekg(pos);
+
+	return result;
+}
+
+bool BinarySceneReader::isBinarySceneFilename(const std::string& filename) {
+	return boost::algorithm::iends_with(filename, ".pswb");
+}
+
+BinarySceneReader* BinarySceneReader::current() {
+	return s_currentReader;
+}
+
+void BinarySceneReader::read(std::size_t index, dependency_graph::Data& data) {
+	if(index >= m_values.size())
+		throw std::runtime_error("Error reading a binary scene - value " + std::to_string(index) + " not found.");
+
+	const std::pair<std::streamoff, std::uint64_t>& chunk = m_values[index];
+
+	m_in.clear();
+	m_in.seekg(chunk.first);
+	io::readBinary(m_in, data);
+
+	if(!m_in || m_in.tellg() != chunk.first + static_cast<std::streamoff>(chunk.second))
+		throw std::runtime_error("Error reading a binary scene - value " + std::to_string(index) + " of type " +
+		                         data.type() + " doesn't match its stored size.");
+}
+
+}  // namespace possumwood
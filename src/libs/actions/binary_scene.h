@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "io.h"
+
+namespace possumwood {
+
+/// Binary scene container (.pswb), a compact alternative to the JSON .psw format. Consists of a
+/// "PSWB" magic, a 32-bit format version and a sequence of chunks, each with a 4-character tag,
+/// a 64-bit payload size and the payload itself:
+///   - "SCNE" - the structure of the scene (the same as in a .psw file), encoded as CBOR
+///   - "VALU" - a single value in its binary serialization (see BinaryIO), referenced from the
+///              scene by the index of the chunk
+/// All integers are stored little-endian. Chunks with unknown tags are skipped on reading.
+///
+/// Values of types without a binary serialization stay inline in the scene structure.
+class BinarySceneWriter : public boost::noncopyable {
+  public:
+	/// while the writer exists, io::toJson() calls on the current thread store values with a binary
+	/// serialization in separate chunks of this writer, only referenced from the resulting JSON
+	BinarySceneWriter();
+	~BinarySceneWriter();
+
+	/// writes the container - the scene, with all values collected by this writer
+	void write(std::ostream& out, const nlohmann::json& scene) const;
+
+	/// returns the writer active on the current thread, or nullptr
+	static BinarySceneWriter* current();
+
+  private:
+	/// serializes a value into a new chunk, and returns its index
+	std::size_t add(const dependency_graph::Data& data);
+
+	std::vector<std::string> m_values;
+	BinarySceneWriter* m_previous;
+
+	friend void io::toJson(nlohmann::json& j, const dependency_graph::Data& data);
+};
+
+/// Reader of the binary scene container. Only the chunk table and the scene structure are read on
+/// construction - the binary values are read directly from the stream into their target values when
+/// resolved by io::fromJson() calls. All values are still read while the scene is being loaded (i.e.,
+/// when the loaded nodes are being created) - they are not loaded lazily, or memory-mapped. The
+/// stream needs to be seekable, and needs to outlive the reader.
+class BinarySceneReader : public boost::noncopyable {
+  public:
+	/// reads the chunk table and the scene structure; while the reader exists, io::fromJson() calls on
+	/// the current thread resolve the references to its values
+	explicit BinarySceneReader(std::istream& in);
+	~BinarySceneReader();
+
+	const nlohmann::json& scene() const;
+
+	/// returns true if the stream contains a binary scene (doesn't change the stream position)
+	static bool isBinaryScene(std::istream& in);
+	/// returns true for filenames with the binary scene extension (.pswb)
+	static bool isBinarySceneFilename(const std::string& filename);
+
+	/// returns the reader active on the current thread, or nullptr
+	static BinarySceneReader* current();
+
+  private:
+	/// reads a value chunk into a value
+	void read(std::size_t index, dependency_graph::Data& data);
+
+	std::istream& m_in;
+	nlohmann::json m_scene;
+
+	// offsets and sizes of value chunks
+	std::vector<std::pair<std::streamoff, std::uint64_t>> m_values;
+
+	BinarySceneReader* m_previous;
+
+	friend void io::fromJson(const nlohmann::json& j, dependency_graph::Data& data);
+};
+
+}  // namespace possumwood
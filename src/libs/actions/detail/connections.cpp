@@ -144,6 +144,94 @@ void doDisconnectByNames(const dependency_graph::UniqueId& fromNode, const std::
 	doDisconnectByRefs(from, fromPortId, to, toPortId);
 }
 
+dependency_graph::Port& findPort(dependency_graph::NodeBase& node, const std::string& name) {
+	for(std::size_t p = 0; p < node.portCount(); ++p)
+		if(node.port(p).name() == name)
+			return node.port(p);
+
+	throw std::runtime_error("Cannot connect " + node.name() + ":" + name + " - port doesn't exist on the node.");
+}
+
+/// the outcome of a batch connect - connections that were made, and the errors of the ones that were not
+struct BatchResult {
+	std::vector<bool> connected;
+	std::vector<std::string> errors;
+};
+
+void doConnectBatch(const std::vector<NamedConnection>& connections, std::shared_ptr<BatchResult> result) {
+	result->connected.assign(connections.size(), false);
+	result->errors.clear();
+
+	std::vector<std::pair<dependency_graph::Port*, dependency_graph::Port*>> ports;
+	std::vector<std::size_t> indices;
+
+	for(std::size_t c = 0; c < connections.size(); ++c) {
+		try {
+			dependency_graph::NodeBase& from = detail::findNode(connections[c].fromNode);
+			dependency_graph::NodeBase& to = detail::findNode(connections[c].toNode);
+
+			ports.push_back(
+			    std::make_pair(&findPort(from, connections[c].fromPort), &findPort(to, connections[c].toPort)));
+			indices.push_back(c);
+		}
+		catch(std::exception& err) {
+			result->errors.push_back(err.what());
+		}
+	}
+
+	if(ports.empty())
+		return;
+
+	for(std::size_t c : indices)
+		unlinkAll(connections[c].fromNode, connections[c].toNode);
+
+	dependency_graph::Network& network = ports.front().first->node().network();
+
+	try {
+		network.connections().connect(ports);
+
+		for(std::size_t c : indices)
+			result->connected[c] = true;
+	}
+	catch(std::exception&) {
+		// the batch is not valid as a whole - connect one by one, skipping the invalid connections
+		for(std::size_t p = 0; p < ports.size(); ++p) {
+			try {
+				ports[p].first->connect(*ports[p].second);
+				result->connected[indices[p]] = true;
+			}
+			catch(std::exception& err) {
+				result->errors.push_back(err.what());
+			}
+		}
+	}
+
+	// the network's ports are rebuilt only once for the whole batch
+	for(std::size_t p = 0; p < ports.size(); ++p)
+		if(result->connected[indices[p]] && (ports[p].first->node().metadata()->type() == "input" ||
+		                                     ports[p].second->node().metadata()->type() == "output")) {
+			::possumwood::actions::detail::buildNetwork(network);
+			break;
+		}
+}
+
+void doDisconnectBatch(const std::vector<NamedConnection>& connections, std::shared_ptr<BatchResult> result) {
+	for(std::size_t c = connections.size(); c > 0; --c)
+		if(result->connected[c - 1])
+			doDisconnectByNames(connections[c - 1].fromNode, connections[c - 1].fromPort, connections[c - 1].toNode,
+			                    connections[c - 1].toPort);
+}
+
+void checkBatch(std::shared_ptr<BatchResult> result) {
+	if(!result->errors.empty()) {
+		std::stringstream ss;
+		for(std::size_t e = 0; e < result->errors.size(); ++e)
+			ss << (e > 0 ? "\n" : "") << result->errors[e];
+
+		throw std::runtime_error(ss.str());
+	}
+}
+
 }  // namespace
 
 possumwood::UndoStack::Action disconnectAction(const dependency_graph::UniqueId& fromNodeId, std::size_t fromPort,
@@ -276,6 +364,75 @@ possumwood::UndoStack::Action connectAction(const dependency_graph::UniqueId& fr
 	return action;
 }
 
+possumwood::UndoStack::Action connectAction(const std::vector<NamedConnection>& connections) {
+	possumwood::UndoStack::Action action;
+
+	if(connections.empty())
+		return action;
+
+	// value reset after disconnect
+	//   -> we want the values as they were when undoing a connect action
+	std::shared_ptr<std::vector<dependency_graph::Data>> data(
+	    new std::vector<dependency_graph::Data>(connections.size()));
+
+	// invalid connections are skipped, and reported by a separate command - to keep the valid part
+	//   of the batch undoable if errors are not halting the action
+	std::shared_ptr<BatchResult> result(new BatchResult());
+
+	{
+		std::stringstream ss;
+		ss << "Cloning data for a batch of " << connections.size() << " new connections";
+
+		action.addCommand(
+		    ss.str(),
+		    // on connect, save the values
+		    [connections, data]() {
+			    for(std::size_t c = 0; c < connections.size(); ++c) {
+				    try {
+					    dependency_graph::Port& port =
+					        findPort(detail::findNode(connections[c].toNode), connections[c].toPort);
+
+					    // only on non-void ports, though
+					    if((*data)[c].empty() && port.type() != typeid(void))
+						    (*data)[c] = port.getData();
+				    }
+				    // missing ports are reported by the connect command
+				    catch(std::exception&) {
+				    }
+			    }
+		    },
+
+		    // and on disconnect, put them back
+		    [connections, data, result]() {
+			    for(std::size_t c = 0; c < connections.size(); ++c)
+				    if(!(*data)[c].empty() && result->connected[c]) {
+					    dependency_graph::Port& port =
+					        findPort(detail::findNode(connections[c].toNode), connections[c].toPort);
+
+					    assert(!port.isConnected());
+					    port.setData((*data)[c]);
+				    }
+		    });
+	}
+
+	{
+		std::stringstream ss;
+		ss << "Creating a batch of " << connections.size() << " connections";
+
+		action.addCommand(ss.str(), std::bind(&doConnectBatch, connections, result),
+		                  std::bind(&doDisconnectBatch, connections, result));
+	}
+
+	{
+		std::stringstream ss;
+		ss << "Validating a batch of " << connections.size() << " connections";
+
+		action.addCommand(ss.str(), std::bind(&checkBatch, result), []() {});
+	}
+
+	return action;
+}
+
 possumwood::UndoStack::Action connectAction(const dependency_graph::Port& p1, const dependency_graph::Port& p2) {
 	return connectAction(p1.node().index(), p1.index(), p2.node().index(), p2.index());
 }
@@ -11,12 +11,23 @@ namespace possumwood {
 namespace actions {
 namespace detail {
 
+/// a connection between two ports, identified by node IDs and port names
+struct NamedConnection {
+	dependency_graph::UniqueId fromNode;
+	std::string fromPort;
+	dependency_graph::UniqueId toNode;
+	std::string toPort;
+};
+
 possumwood::UndoStack::Action connectAction(const dependency_graph::Port& p1, const dependency_graph::Port& p2);
 possumwood::UndoStack::Action connectAction(const dependency_graph::UniqueId& fromNodeId, std::size_t fromPort,
                                             const dependency_graph::UniqueId& toNodeId, std::size_t toPort);
 possumwood::UndoStack::Action connectAction(const dependency_graph::UniqueId& fromNodeId,
                                             const std::string& fromPortName, const dependency_graph::UniqueId& toNodeId,
                                             const std::string& toPortName);
+/// connects a batch of ports within a single network, validating the whole batch at once (see
+/// dependency_graph::Connections::connect()) - used when loading networks
+possumwood::UndoStack::Action connectAction(const std::vector<NamedConnection>& connections);
 possumwood::UndoStack::Action disconnectAction(dependency_graph::Port& p1, dependency_graph::Port& p2);
 possumwood::UndoStack::Action disconnectAction(const dependency_graph::UniqueId& fromNodeId, std::size_t fromPort,
                                                const dependency_graph::UniqueId& toNodeId, std::size_t toPort);
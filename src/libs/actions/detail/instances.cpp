@@ -0,0 +1,254 @@
+#include "instances.h"
+
+#include <algorithm>
+
+#include <dependency_graph/detail.h>
+#include <dependency_graph/metadata_register.h>
+#include <dependency_graph/values.h>
+
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/nodes_iterator.inl>
+
+#include "metadata.h"
+
+namespace possumwood {
+namespace actions {
+namespace detail {
+
+namespace {
+
+// the number of evaluated input combinations kept for each template
+const std::size_t s_cacheSize = 16;
+
+std::mutex s_templatesMutex;
+std::vector<std::weak_ptr<NetworkTemplate>> s_templates;
+
+std::vector<std::shared_ptr<NetworkTemplate>> templates() {
+	std::lock_guard<std::mutex> lock(s_templatesMutex);
+
+	std::vector<std::shared_ptr<NetworkTemplate>> result;
+	for(auto& t : s_templates)
+		if(auto ptr = t.lock())
+			result.push_back(ptr);
+
+	return result;
+}
+
+/// loads the content of a network, including all its nested networks, and returns the combined flags of the
+///   loaded nodes
+unsigned loadAll(dependency_graph::Network& network) {
+	network.load();
+
+	unsigned flags = dependency_graph::Metadata::kNoFlags;
+	for(auto& n : network.nodes()) {
+		flags |= n.metadata()->flags();
+
+		if(n.is<dependency_graph::Network>())
+			flags |= loadAll(n.as<dependency_graph::Network>());
+	}
+
+	return flags;
+}
+
+}  // namespace
+
+NetworkTemplate::NetworkTemplate(const std::string& source, const nlohmann::json& content)
+    : m_source(source),
+      m_content(content),
+      m_identity(source + ":" + content.dump()),
+      m_network(nullptr),
+      m_meta(nullptr),
+      m_timeDependent(false) {
+}
+
+NetworkTemplate::~NetworkTemplate() {
+	for(auto& g : m_governors)
+		if(auto governor = g.lock())
+			governor->setExternalUsage(this, 0);
+
+	std::lock_guard<std::mutex> lock(s_templatesMutex);
+
+	s_templates.erase(std::remove_if(s_templates.begin(), s_templates.end(),
+	                                 [](const std::weak_ptr<NetworkTemplate>& t) { return t.expired(); }),
+	                  s_templates.end());
+}
+
+boost::optional<dependency_graph::MetadataHandle> NetworkTemplate::instance(const std::string& source,
+                                                                            const nlohmann::json& content,
+                                                                            dependency_graph::Network::Loader loader) {
+	// identical source networks share a template (a changed source file leads to a new one)
+	for(auto& t : templates())
+		if(t->m_source == source && t->m_content == content)
+			return dependency_graph::MetadataHandle(*t->m_meta);
+
+	boost::optional<dependency_graph::MetadataHandle> ports = networkMetadata(content);
+	if(!ports)
+		return boost::none;
+
+	std::shared_ptr<NetworkTemplate> result(new NetworkTemplate(source, content));
+	{
+		std::lock_guard<std::mutex> lock(s_templatesMutex);
+		s_templates.push_back(result);
+	}
+
+	// the template is a network with the same ports as all its instances, with its content fully loaded
+	//   upfront - the instances are then evaluated without any further changes to the template's structure
+	auto networkIt = dependency_graph::MetadataRegister::singleton().find("network");
+	assert(networkIt != dependency_graph::MetadataRegister::singleton().end());
+
+	result->m_network = &result->m_graph.nodes().add(*networkIt, source).as<dependency_graph::Network>();
+	result->m_network->setMetadata(*ports);
+	result->m_network->setDeferredLoad(loader);
+	const unsigned flags = loadAll(*result->m_network);
+
+	// the instances only evaluate the template - each output depends on all inputs
+	std::unique_ptr<dependency_graph::Metadata> meta = dependency_graph::instantiateMetadata("network");
+	for(std::size_t a = 0; a < (*ports)->attributeCount(); ++a) {
+		const dependency_graph::Attr& attr = (*ports)->attr(a);
+		dependency_graph::detail::MetadataAccess::addAttribute(*meta, attr.name(), attr.category(),
+		                                                       attr.createData(), attr.flags());
+	}
+
+	for(std::size_t in = 0; in < meta->attributeCount(); ++in)
+		for(std::size_t out = 0; out < meta->attributeCount(); ++out)
+			if(meta->attr(in).category() == dependency_graph::Attr::kInput &&
+			   meta->attr(out).category() == dependency_graph::Attr::kOutput)
+				dependency_graph::detail::MetadataAccess::addInfluence(*meta, in, out);
+
+	// a template containing main-thread-only nodes can only be evaluated on the main thread, and a template
+	//   containing time sources has to be re-evaluated after each time change
+	meta->setFlags(flags &
+	               (dependency_graph::Metadata::kMainThreadOnly | dependency_graph::Metadata::kTimeSource));
+	result->m_timeDependent = flags & dependency_graph::Metadata::kTimeSource;
+
+	// the metadata owns the template - it is released with the last instance
+	meta->setCompute([result](dependency_graph::Values& vals) { return result->compute(vals); });
+
+	result->m_meta = meta.get();
+	return dependency_graph::MetadataHandle(std::move(meta));
+}
+
+bool NetworkTemplate::isInstance(const dependency_graph::MetadataHandle& meta) {
+	for(auto& t : templates())
+		if(t->m_meta == &meta.metadata())
+			return true;
+
+	return false;
+}
+
+std::string NetworkTemplate::identity(const dependency_graph::MetadataHandle& meta) {
+	for(auto& t : templates())
+		if(t->m_meta == &meta.metadata())
+			return t->m_identity;
+
+	return std::string();
+}
+
+dependency_graph::NodeBase* NetworkTemplate::findNode(const dependency_graph::UniqueId& id) {
+	for(auto& t : templates()) {
+		auto it = t->m_graph.nodes().find(id, dependency_graph::Nodes::kRecursive);
+		if(it != t->m_graph.nodes().end())
+			return &(*it);
+	}
+
+	return nullptr;
+}
+
+void NetworkTemplate::setInputs(const std::vector<dependency_graph::Data>& inputs) {
+	auto input = inputs.begin();
+	for(std::size_t pi = 0; pi < m_network->portCount(); ++pi)
+		if(m_network->port(pi).category() == dependency_graph::Attr::kInput)
+			m_network->port(pi).setData(*(input++));
+}
+
+std::size_t NetworkTemplate::cacheSize() const {
+	std::size_t result = 0;
+	for(auto& e : m_cache) {
+		for(auto& d : e.key)
+			result += d.size();
+		for(auto& d : e.outputs)
+			result += d.size();
+	}
+
+	return result;
+}
+
+dependency_graph::State NetworkTemplate::compute(dependency_graph::Values& vals) {
+	// the template is shared between all instances, potentially evaluated from different threads
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::vector<dependency_graph::Data> key;
+	for(std::size_t pi = 0; pi < m_network->portCount(); ++pi)
+		if(m_network->port(pi).category() == dependency_graph::Attr::kInput)
+			key.push_back(vals.data(pi));
+
+	// the outputs of a time-dependent template depend on the current time as well - the time sources of
+	//   the template's graph are invalidated (the instance is a time source itself, evaluated after each
+	//   time change) and their values are added to the key
+	if(m_timeDependent) {
+		setInputs(key);
+		m_graph.invalidateTimeSources();
+
+		for(dependency_graph::NodeBase* n : m_graph.nodeIndex().timeSources())
+			for(std::size_t pi = 0; pi < n->portCount(); ++pi)
+				if(n->port(pi).category() == dependency_graph::Attr::kOutput)
+					key.push_back(n->port(pi).getData());
+	}
+
+	auto it = std::find_if(m_cache.begin(), m_cache.end(), [&key](const CacheEntry& e) { return e.key == key; });
+
+	// evaluate the template with the inputs of this instance
+	if(it == m_cache.end()) {
+		CacheEntry entry;
+		entry.key = key;
+
+		if(!m_timeDependent)
+			setInputs(key);
+
+		for(std::size_t pi = 0; pi < m_network->portCount(); ++pi)
+			if(m_network->port(pi).category() == dependency_graph::Attr::kOutput)
+				entry.outputs.push_back(m_network->port(pi).getData());
+
+		// the state of an instance is the state of the template's content
+		entry.state = m_network->state();
+		for(auto n = m_network->nodes().begin(dependency_graph::Nodes::kRecursive); n != m_network->nodes().end();
+		    ++n)
+			entry.state.append(n->state());
+
+		m_cache.push_front(std::move(entry));
+		if(m_cache.size() > s_cacheSize)
+			m_cache.pop_back();
+	}
+
+	// or reuse the outputs evaluated for the same inputs
+	else
+		m_cache.splice(m_cache.begin(), m_cache, it);
+
+	auto output = m_cache.front().outputs.begin();
+	for(std::size_t pi = 0; pi < m_network->portCount(); ++pi)
+		if(m_network->port(pi).category() == dependency_graph::Attr::kOutput)
+			vals.setData(pi, *(output++));
+
+	// the cached values are accounted for by the memory governor of the evaluated graph, and released
+	//   (least recently used first) while it is over its budget
+	if(std::shared_ptr<dependency_graph::MemoryGovernor> governor = vals.memoryGovernor()) {
+		if(std::find_if(m_governors.begin(), m_governors.end(),
+		                [&governor](const std::weak_ptr<dependency_graph::MemoryGovernor>& g) {
+			                return g.lock() == governor;
+		                }) == m_governors.end())
+			m_governors.push_back(governor);
+
+		governor->setExternalUsage(this, cacheSize());
+		while(m_cache.size() > 1 && governor->usage() > governor->budget()) {
+			m_cache.pop_back();
+			governor->setExternalUsage(this, cacheSize());
+		}
+	}
+
+	return m_cache.front().state;
+}
+
+}  // namespace detail
+}  // namespace actions
+}  // namespace possumwood
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+
+#include <dependency_graph/graph.h>
+#include <dependency_graph/memory_governor.h>
+#include <dependency_graph/metadata.h>
+#include <dependency_graph/network.h>
+
+#include <nlohmann/json.hpp>
+
+namespace possumwood {
+namespace actions {
+namespace detail {
+
+/// The shared content of instanced networks - networks referencing the same source file, with the
+/// "instanced" flag set. Instead of a full copy of the source network, each instance is an empty network
+/// only holding the values of its own ports, with the outputs evaluated by a single template network
+/// (in a private graph) shared by all instances. The evaluated outputs are cached by the input values,
+/// so instances with identical inputs share the results of a single evaluation. Instances of templates
+/// containing time sources are time sources themselves - the values of the template's time sources are
+/// then part of the cache key.
+class NetworkTemplate : public boost::noncopyable {
+  public:
+	~NetworkTemplate();
+
+	/// returns the metadata of a new instance of the source network, with the ports of the source and
+	///   a compute evaluating the shared template. Returns none if the ports can't be determined from the
+	///   source content (see networkMetadata()) - such a network can't be instanced.
+	static boost::optional<dependency_graph::MetadataHandle> instance(const std::string& source,
+	                                                                  const nlohmann::json& content,
+	                                                                  dependency_graph::Network::Loader loader);
+
+	/// returns true if the metadata belongs to an instanced network
+	static bool isInstance(const dependency_graph::MetadataHandle& meta);
+
+	/// returns the identity of the template of an instanced network - its source and content (empty for any
+	///   other metadata). All instances have the same "network" metadata type, regardless of their template.
+	static std::string identity(const dependency_graph::MetadataHandle& meta);
+
+	/// finds a node in the content of the templates (used by actions to build the content), or nullptr
+	static dependency_graph::NodeBase* findNode(const dependency_graph::UniqueId& id);
+
+  private:
+	NetworkTemplate(const std::string& source, const nlohmann::json& content);
+
+	dependency_graph::State compute(dependency_graph::Values& vals);
+
+	/// sets the input values of the template network
+	void setInputs(const std::vector<dependency_graph::Data>& inputs);
+	/// returns the approximate size of all cached values, in bytes
+	std::size_t cacheSize() const;
+
+	struct CacheEntry {
+		// the input values, followed by the values of the time sources for a time-dependent template
+		std::vector<dependency_graph::Data> key;
+		std::vector<dependency_graph::Data> outputs;
+		dependency_graph::State state;
+	};
+
+	std::string m_source;
+	nlohmann::json m_content;
+	// the source and the serialized content, identifying the template
+	std::string m_identity;
+
+	dependency_graph::Graph m_graph;
+	dependency_graph::Network* m_network;
+
+	// the metadata of all instances, owning this template via its compute
+	const dependency_graph::Metadata* m_meta;
+	// true if the template contains time sources
+	bool m_timeDependent;
+
+	// evaluated outputs, most recently used first
+	std::list<CacheEntry> m_cache;
+	std::mutex m_mutex;
+
+	// memory governors the size of the cache was reported to
+	std::vector<std::weak_ptr<dependency_graph::MemoryGovernor>> m_governors;
+};
+
+}  // namespace detail
+}  // namespace actions
+}  // namespace possumwood
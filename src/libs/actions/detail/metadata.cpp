@@ -2,6 +2,7 @@
 
 #include <dependency_graph/attr_map.h>
 #include <dependency_graph/detail.h>
+#include <dependency_graph/metadata_register.h>
 #include <dependency_graph/values.h>
 
 #include <dependency_graph/nodes_iterator.inl>
@@ -31,6 +32,23 @@ struct ConnectionItem {
 	std::size_t thisPort, thatPort;
 };
 
+/// returns true if two metadata instances have the same attributes (names, categories, types and flags)
+bool sameAttributes(const dependency_graph::Metadata& m1, const dependency_graph::Metadata& m2) {
+	if(m1.attributeCount() != m2.attributeCount())
+		return false;
+
+	for(std::size_t a = 0; a < m1.attributeCount(); ++a) {
+		const dependency_graph::Attr& a1 = m1.attr(a);
+		const dependency_graph::Attr& a2 = m2.attr(a);
+
+		if(a1.name() != a2.name() || a1.category() != a2.category() || a1.type() != a2.type() ||
+		   a1.flags() != a2.flags())
+			return false;
+	}
+
+	return true;
+}
+
 }  // namespace
 
 possumwood::UndoStack::Action changeMetadataAction(dependency_graph::NodeBase& node,
@@ -46,7 +64,7 @@ possumwood::UndoStack::Action changeMetadataAction(dependency_graph::NodeBase& n
 			if(node.hasParentNetwork()) {
 				auto conns = node.network().connections().connectedTo(port);
 
-				for(auto& c : conns)
+				for(auto c : conns)
 					outConnections.push_back(ConnectionItem{c.get().node().index(), pi, c.get().index()});
 			}
 		}
@@ -106,7 +124,7 @@ void buildNetwork(dependency_graph::Network& network) {
 	std::unique_ptr<dependency_graph::Metadata> meta = dependency_graph::instantiateMetadata("network");
 
 	std::vector<Link> links;
-	std::vector<dependency_graph::Data> values;
+	std::vector<dependency_graph::Port*> values;
 
 	for(auto& n : network.nodes()) {
 		if(n.metadata()->type() == "input" && n.port(0).isConnected()) {
@@ -122,7 +140,7 @@ void buildNetwork(dependency_graph::Network& network) {
 			                                                       in.flags());
 
 			// also the port value
-			values.push_back(n.port(0).getData());
+			values.push_back(&n.port(0));
 		}
 
 		if(n.metadata()->type() == "output" && n.port(0).isConnected()) {
@@ -139,7 +157,7 @@ void buildNetwork(dependency_graph::Network& network) {
 			                                                       out.flags());
 
 			// also port the value
-			values.push_back(conn->node().port(conn->index()).getData());
+			values.push_back(&conn->node().port(conn->index()));
 		}
 	}
 
@@ -178,13 +196,17 @@ void buildNetwork(dependency_graph::Network& network) {
 		if((n.metadata()->type() == "output") && n.port(0).isLinked())
 			action.append(detail::unlinkAction(n.port(0)));
 
-	// change metadata of the node, using an action (unless root - root handling to be addressed at some point)
-	dependency_graph::MetadataHandle handle(std::move(meta));
-	action.append(changeMetadataAction(network, handle));
+	// change metadata of the node, using an action (unless root - root handling to be addressed at some point).
+	//   Unchanged ports (e.g., of a network with a deferred load, created with the ports from its source file)
+	//   keep the current metadata, connections and values - only the links are rebuilt.
+	if(!sameAttributes(network.metadata().metadata(), *meta)) {
+		dependency_graph::MetadataHandle handle(std::move(meta));
+		action.append(changeMetadataAction(network, handle));
 
-	// transfer all the values
-	for(std::size_t pi = 0; pi < values.size(); ++pi)
-		action.append(detail::setValueAction(network.index(), pi, values[pi]));
+		// transfer all the values
+		for(std::size_t pi = 0; pi < values.size(); ++pi)
+			action.append(detail::setValueAction(network.index(), pi, values[pi]->getData()));
+	}
 
 	// link all what needs to be linked
 	for(auto& l : links)
@@ -194,6 +216,71 @@ void buildNetwork(dependency_graph::Network& network) {
 	tmpStack.execute(action);
 }
 
+boost::optional<dependency_graph::MetadataHandle> networkMetadata(const nlohmann::json& content) {
+	std::unique_ptr<dependency_graph::Metadata> meta = dependency_graph::instantiateMetadata("network");
+
+	const nlohmann::json nodes = content.value("nodes", nlohmann::json::object());
+	const nlohmann::json connections = content.value("connections", nlohmann::json::array());
+
+	// the same order of ports as in buildNetwork() - the order of nodes, which is the order of their creation
+	for(nlohmann::json::const_iterator ni = nodes.begin(); ni != nodes.end(); ++ni) {
+		const std::string type = ni.value()["type"].get<std::string>();
+		if(type != "input" && type != "output")
+			continue;
+
+		// the port type comes from the first connection of the input or output node
+		std::string thatNode, thatPort;
+		for(auto& c : connections) {
+			if(type == "input" && c["out_node"].get<std::string>() == ni.key()) {
+				thatNode = c["in_node"].get<std::string>();
+				thatPort = c["in_port"].get<std::string>();
+				break;
+			}
+
+			if(type == "output" && c["in_node"].get<std::string>() == ni.key()) {
+				thatNode = c["out_node"].get<std::string>();
+				thatPort = c["out_port"].get<std::string>();
+				break;
+			}
+		}
+
+		// unconnected input and output nodes don't create ports
+		if(thatNode.empty())
+			continue;
+
+		// the type of the connected port is only known for registered node types with static ports
+		auto thatIt = nodes.find(thatNode);
+		if(thatIt == nodes.end())
+			return boost::none;
+
+		const std::string thatType = (*thatIt)["type"].get<std::string>();
+		if(thatType == "network" || thatType == "input" || thatType == "output")
+			return boost::none;
+
+		auto metaIt = dependency_graph::MetadataRegister::singleton().find(thatType);
+		if(metaIt == dependency_graph::MetadataRegister::singleton().end())
+			return boost::none;
+
+		bool found = false;
+		for(std::size_t a = 0; a < (*metaIt)->attributeCount() && !found; ++a) {
+			const dependency_graph::Attr& attr = (*metaIt)->attr(a);
+			if(attr.name() == thatPort) {
+				dependency_graph::detail::MetadataAccess::addAttribute(
+				    *meta, ni.value()["name"].get<std::string>(), attr.category(), attr.createData(), attr.flags());
+				found = true;
+			}
+		}
+
+		if(!found)
+			return boost::none;
+	}
+
+	// the outputs are linked to the content of the network - the compute is never used
+	meta->setCompute([](dependency_graph::Values&) { return dependency_graph::State(); });
+
+	return dependency_graph::MetadataHandle(std::move(meta));
+}
+
 }  // namespace detail
 }  // namespace actions
 }  // namespace possumwood
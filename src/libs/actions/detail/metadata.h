@@ -4,6 +4,8 @@
 
 #include <boost/optional.hpp>
 
+#include <nlohmann/json.hpp>
+
 #include "../node_data.h"
 #include "../undo_stack.h"
 
@@ -16,6 +18,11 @@ possumwood::UndoStack::Action changeMetadataAction(dependency_graph::NodeBase& n
 
 void buildNetwork(dependency_graph::Network& net);
 
+/// returns the metadata that buildNetwork() would build for a network with the content described by a JSON
+/// (e.g., a source file), without instantiating the content. Returns none if the types of the network ports
+/// can't be determined without instantiation (e.g., inputs connected to nested networks).
+boost::optional<dependency_graph::MetadataHandle> networkMetadata(const nlohmann::json& content);
+
 }  // namespace detail
 }  // namespace actions
 }  // namespace possumwood
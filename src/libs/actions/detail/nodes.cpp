@@ -137,6 +137,9 @@ possumwood::UndoStack::Action removeNodeAction(dependency_graph::NodeBase& node)
 possumwood::UndoStack::Action removeNetworkAction(dependency_graph::Network& net) {
 	possumwood::UndoStack::Action action;
 
+	// the content of a network with a deferred load is needed to undo the removal
+	net.load();
+
 	// remove all connections
 	for(auto& e : net.connections())
 		action.append(disconnectAction(e.first, e.second));
@@ -235,6 +238,24 @@ void doSetSource(const dependency_graph::UniqueId& nodeId, std::shared_ptr<boost
 	net.setSource(*newPath);
 }
 
+void doSetDeferredLoad(const dependency_graph::UniqueId& nodeId, const dependency_graph::MetadataHandle& meta,
+                       dependency_graph::Network::Loader loader) {
+	dependency_graph::NodeBase& node = detail::findNode(nodeId);
+	assert(node.is<dependency_graph::Network>());
+	dependency_graph::Network& net = node.as<dependency_graph::Network>();
+
+	// only applicable to a newly created network (setMetadata() would throw on a connected one)
+	assert(net.nodes().empty());
+	net.setMetadata(meta);
+	net.setDeferredLoad(loader);
+}
+
+void doResetDeferredLoad(const dependency_graph::UniqueId& nodeId) {
+	// the content of a network loaded in the meantime was not created by any action - clear() removes it
+	//   together with the loader, leaving an empty network to be removed by undoing its creation
+	detail::findNode(nodeId).as<dependency_graph::Network>().clear();
+}
+
 }  // namespace
 
 possumwood::UndoStack::Action setSourceAction(const dependency_graph::UniqueId& networkId,
@@ -253,6 +274,20 @@ possumwood::UndoStack::Action setSourceAction(const dependency_graph::UniqueId&
 	return action;
 }
 
+possumwood::UndoStack::Action deferredLoadAction(const dependency_graph::UniqueId& networkId,
+                                                 const dependency_graph::MetadataHandle& meta,
+                                                 dependency_graph::Network::Loader loader) {
+	possumwood::UndoStack::Action action;
+
+	std::stringstream ss;
+	ss << "Deferring the loading of network " << networkId;
+
+	action.addCommand(ss.str(), std::bind(&doSetDeferredLoad, networkId, meta, loader),
+	                  std::bind(&doResetDeferredLoad, networkId));
+
+	return action;
+}
+
 }  // namespace detail
 }  // namespace actions
 }  // namespace possumwood
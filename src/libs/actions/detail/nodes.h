@@ -31,6 +31,12 @@ possumwood::UndoStack::Action renameNodeAction(const dependency_graph::UniqueId&
 possumwood::UndoStack::Action setSourceAction(const dependency_graph::UniqueId& networkId,
                                               const boost::filesystem::path& source);
 
+/// sets the ports of a newly created network, and defers the loading of its content (see Network::load()).
+/// An empty loader leaves the network without content (e.g., an instanced network, see NetworkTemplate).
+possumwood::UndoStack::Action deferredLoadAction(const dependency_graph::UniqueId& networkId,
+                                                 const dependency_graph::MetadataHandle& meta,
+                                                 dependency_graph::Network::Loader loader);
+
 }  // namespace detail
 }  // namespace actions
 }  // namespace possumwood
@@ -3,6 +3,7 @@
 #include <dependency_graph/nodes_iterator.inl>
 
 #include "../app.h"
+#include "instances.h"
 
 namespace possumwood {
 namespace actions {
@@ -13,10 +14,14 @@ dependency_graph::NodeBase& findNode(const dependency_graph::UniqueId& id) {
 		return possumwood::AppCore::instance().graph();
 
 	auto it = possumwood::AppCore::instance().graph().nodes().find(id, dependency_graph::Nodes::kRecursive);
-	assert(it != possumwood::AppCore::instance().graph().nodes().end());
+	if(it != possumwood::AppCore::instance().graph().nodes().end())
+		return *it;
 
-	// and get the node reference
-	return *it;
+	// not part of the scene - the content of an instanced network's template (built using the same actions)
+	dependency_graph::NodeBase* node = NetworkTemplate::findNode(id);
+	assert(node != nullptr);
+
+	return *node;
 }
 
 }  // namespace detail
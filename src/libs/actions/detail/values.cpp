@@ -3,6 +3,7 @@
 #include <dependency_graph/nodes.inl>
 
 #include "../app.h"
+#include "tools.h"
 
 namespace possumwood {
 namespace actions {
@@ -15,16 +16,7 @@ void doSetValueFromJson(const dependency_graph::UniqueId& nodeId,
                         const nlohmann::json& value,
                         std::shared_ptr<dependency_graph::Data> original) {
 	// get the node
-	dependency_graph::NodeBase* node = nullptr;
-	if(nodeId == AppCore::instance().graph().index())
-		node = &AppCore::instance().graph();
-	else {
-		auto nodeIt = AppCore::instance().graph().nodes().find(nodeId, dependency_graph::Nodes::kRecursive);
-		assert(nodeIt != AppCore::instance().graph().nodes().end());
-
-		node = &(*nodeIt);
-	}
-	assert(node != nullptr);
+	dependency_graph::NodeBase* node = &findNode(nodeId);
 
 	// get the port
 	int portId = -1;
@@ -59,18 +51,7 @@ void doSetValue(const dependency_graph::UniqueId& nodeId,
                 unsigned portId,
                 std::shared_ptr<const dependency_graph::Data> value,
                 std::shared_ptr<dependency_graph::Data> original) {
-	dependency_graph::NodeBase* node = nullptr;
-
-	if(AppCore::instance().graph().index() == nodeId)
-		node = &AppCore::instance().graph();
-	else {
-		auto it = AppCore::instance().graph().nodes().find(nodeId, dependency_graph::Nodes::kRecursive);
-		assert(it != AppCore::instance().graph().nodes().end());
-
-		node = &(*it);
-	}
-
-	assert(node != nullptr);
+	dependency_graph::NodeBase* node = &findNode(nodeId);
 
 	if(node->port(portId).category() == dependency_graph::Attr::kOutput || !node->port(portId).isConnected()) {
 		assert(original != nullptr);
@@ -87,18 +68,7 @@ void doResetValue(const dependency_graph::UniqueId& nodeId,
                   std::shared_ptr<dependency_graph::Data> value) {
 	assert(value != nullptr);
 	if(!value->empty()) {
-		dependency_graph::NodeBase* node = nullptr;
-
-		if(AppCore::instance().graph().index() == nodeId)
-			node = &AppCore::instance().graph();
-		else {
-			auto it = AppCore::instance().graph().nodes().find(nodeId, dependency_graph::Nodes::kRecursive);
-			assert(it != AppCore::instance().graph().nodes().end());
-
-			node = &(*it);
-		}
-
-		assert(node != nullptr);
+		dependency_graph::NodeBase* node = &findNode(nodeId);
 
 		if(node->port(portId).category() == dependency_graph::Attr::kOutput || !node->port(portId).isConnected())
 			node->port(portId).setData(*value);
@@ -160,7 +130,8 @@ possumwood::UndoStack::Action setValueAction(const dependency_graph::UniqueId& n
 
 	action.addCommand(
 	    ss.str(), [nodeId, portId, target, original]() { doSetValue(nodeId, portId, target, original); },
-	    [nodeId, portId, original]() { doResetValue(nodeId, portId, original); });
+	    [nodeId, portId, original]() { doResetValue(nodeId, portId, original); },
+	    std::vector<UndoStack::Action::Value>{target, original}, std::vector<UndoStack::Action::Value>{original});
 
 	return action;
 }
@@ -176,7 +147,8 @@ possumwood::UndoStack::Action setValueAction(const dependency_graph::UniqueId& n
 	ss << "Setting value of " << nodeId << "/" << portName << " to " << value << " from JSON";
 
 	action.addCommand(ss.str(), std::bind(&doSetValueFromJson, nodeId, portName, value, original),
-	                  std::bind(&doResetValueFromJson, nodeId, portName, original));
+	                  std::bind(&doResetValueFromJson, nodeId, portName, original),
+	                  std::vector<UndoStack::Action::Value>{original}, std::vector<UndoStack::Action::Value>{original});
 
 	return action;
 }
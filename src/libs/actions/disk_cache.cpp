@@ -0,0 +1,268 @@
+#include "disk_cache.h"
+
+#include <dependency_graph/node_base.h>
+#include <dependency_graph/port.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include "detail/instances.h"
+#include "io.h"
+
+namespace possumwood {
+
+namespace {
+
+std::map<std::type_index, CacheKeyBase::key_fn>& s_keyFn() {
+	static std::map<std::type_index, CacheKeyBase::key_fn> s_map;
+	return s_map;
+}
+
+/// 64-bit FNV-1a hash, as a hex string
+std::string hash(const std::string& str) {
+	std::uint64_t result = 14695981039346656037ull;
+	for(const char& c : str) {
+		result ^= static_cast<unsigned char>(c);
+		result *= 1099511628211ull;
+	}
+
+	std::stringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << result;
+	return ss.str();
+}
+
+// upper limit of the number of recorded value keys - the map is cleared when reached
+const std::size_t s_maxKeyCount = 100000;
+
+/// returns true if a value can be stored in the cache (values of other types are never looked up)
+bool isStorable(const dependency_graph::Data& data) {
+	return !data.empty() && (io::hasBinary(data) || dependency_graph::io::isSaveable(data));
+}
+
+}  // namespace
+
+CacheKeyBase::CacheKeyBase(const std::type_index& type, key_fn fn) : m_type(type) {
+	s_keyFn()[type] = fn;
+}
+
+CacheKeyBase::~CacheKeyBase() {
+	auto it = s_keyFn().find(m_type);
+	if(it != s_keyFn().end())
+		s_keyFn().erase(it);
+}
+
+/////////////////////////////////////
+
+DiskCache::DiskCache(const boost::filesystem::path& directory, std::chrono::steady_clock::duration minComputeTime)
+    : m_directory(directory), m_minComputeTime(minComputeTime) {
+	boost::filesystem::create_directories(m_directory);
+}
+
+const boost::filesystem::path& DiskCache::directory() const {
+	return m_directory;
+}
+
+std::string DiskCache::fileKey(const boost::filesystem::path& path) {
+	std::stringstream result;
+	result << path.string();
+
+	boost::system::error_code ec;
+	if(boost::filesystem::is_regular_file(path, ec)) {
+		result << "|" << boost::filesystem::last_write_time(path, ec);
+		result << "|" << boost::filesystem::file_size(path, ec);
+	}
+
+	return result.str();
+}
+
+std::string DiskCache::valueKey(const dependency_graph::Port& port) {
+	// a value computed or loaded by this cache (or a copy of it in a connected input)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		auto it = m_keys.find(port.version());
+		if(it != m_keys.end())
+			return it->second;
+	}
+
+	// otherwise, the key is derived from the value itself
+	const dependency_graph::Data& data = port.node().datablock().data(port.index());
+
+	auto it = s_keyFn().find(data.typeinfo());
+	if(it != s_keyFn().end())
+		return hash(data.type() + ":" + it->second(data));
+
+	if(dependency_graph::io::isSaveable(data)) {
+		nlohmann::json json;
+		io::toJson(json, data);
+
+		// each version identifies a single value - the key doesn't need to be serialized again (unlike custom
+		//   keys, which can depend on other things than the value, like the content of a file)
+		const std::string key = hash(data.type() + ":" + json.dump());
+
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if(m_keys.size() >= s_maxKeyCount)
+			m_keys.clear();
+		m_keys[port.version()] = key;
+
+		return key;
+	}
+
+	return std::string();
+}
+
+std::string DiskCache::outputKey(const dependency_graph::Port& output, const std::vector<std::size_t>& inputs) {
+	std::stringstream key;
+	key << output.node().metadata()->type();
+
+	// instanced networks share the "network" type, but the result of their compute depends on their template
+	const std::string instance = actions::detail::NetworkTemplate::identity(output.node().metadata());
+	if(!instance.empty())
+		key << "[" << hash(instance) << "]";
+
+	key << "/" << output.name() << ":" << output.node().datablock().data(output.index()).type() << "(";
+
+	for(auto it = inputs.begin(); it != inputs.end(); ++it) {
+		const dependency_graph::Port& input = output.node().port(*it);
+
+		const std::string inputKey = valueKey(input);
+		if(inputKey.empty())
+			return std::string();
+
+		if(it != inputs.begin())
+			key << ",";
+		key << input.name() << "=" << inputKey;
+	}
+
+	key << ")";
+
+	return key.str();
+}
+
+boost::filesystem::path DiskCache::path(const std::string& key) const {
+	return m_directory / hash(key);
+}
+
+bool DiskCache::load(dependency_graph::Port& output, const std::vector<std::size_t>& inputs) {
+	try {
+		// the stored value is read into a copy of the current value, which provides its type (values that
+		//   can't be stored are not looked up at all)
+		dependency_graph::Data data = static_cast<const dependency_graph::Port&>(output).node().datablock().data(
+		    output.index());
+		if(!isStorable(data))
+			return false;
+
+		const std::string key = outputKey(output, inputs);
+		if(key.empty())
+			return false;
+
+		// a missing file is just a failure to open it
+		boost::filesystem::ifstream file(path(key), std::ios::binary);
+		if(!file.is_open())
+			return false;
+
+		// the first line contains the full key, to detect hash collisions
+		std::string line;
+		if(!std::getline(file, line) || line != key)
+			return false;
+
+		std::string format;
+		if(!std::getline(file, format))
+			return false;
+
+		if(format == "binary")
+			io::readBinary(file, data);
+		else if(format == "json") {
+			nlohmann::json json;
+			file >> json;
+
+			io::fromJson(json, data);
+		}
+		else
+			return false;
+
+		output.setData(data);
+
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if(m_keys.size() >= s_maxKeyCount)
+			m_keys.clear();
+		m_keys[output.version()] = hash(key);
+	}
+	catch(...) {
+		// any problem with a cache file just means a cache miss
+		return false;
+	}
+
+	return true;
+}
+
+void DiskCache::store(dependency_graph::Port& output, const std::vector<std::size_t>& inputs,
+                      std::chrono::steady_clock::duration computeTime) {
+	try {
+		const std::string key = outputKey(output, inputs);
+		if(key.empty())
+			return;
+
+		// the key is recorded even if the value is not stored, to allow caching of the downstream
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			if(m_keys.size() >= s_maxKeyCount)
+				m_keys.clear();
+			m_keys[output.version()] = hash(key);
+		}
+
+		// only storing the results of expensive computes, of types that can be stored
+		if(computeTime < m_minComputeTime)
+			return;
+
+		const dependency_graph::Data& data =
+		    static_cast<const dependency_graph::Port&>(output).node().datablock().data(output.index());
+		if(!isStorable(data))
+			return;
+
+		const boost::filesystem::path filename = path(key);
+		if(boost::filesystem::exists(filename))
+			return;
+
+		// write to a temporary file first, to never leave a partially written file in the cache
+		const boost::filesystem::path tmp =
+		    filename.parent_path() / boost::filesystem::unique_path(filename.filename().string() + ".%%%%%%%%.tmp");
+
+		try {
+			boost::filesystem::ofstream file(tmp, std::ios::binary);
+			file << key << std::endl;
+
+			if(io::hasBinary(data)) {
+				file << "binary" << std::endl;
+				io::writeBinary(file, data);
+			}
+			else {
+				nlohmann::json json;
+				io::toJson(json, data);
+
+				file << "json" << std::endl;
+				file << json;
+			}
+
+			if(!file.good())
+				throw std::runtime_error("Error writing cache file " + tmp.string());
+		}
+		catch(...) {
+			boost::system::error_code ec;
+			boost::filesystem::remove(tmp, ec);
+			throw;
+		}
+
+		boost::filesystem::rename(tmp, filename);
+	}
+	catch(std::exception& e) {
+		// a failure to store a value in the cache should never affect the evaluation
+		std::cerr << "Error storing a value in the compute cache - " << e.what() << std::endl;
+	}
+}
+
+}  // namespace possumwood
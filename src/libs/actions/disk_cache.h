@@ -0,0 +1,76 @@
+#pragma once
+
+#include <dependency_graph/compute_cache.h>
+#include <dependency_graph/data.h>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+namespace possumwood {
+
+/// A persistent content-addressed cache of compute results, stored in a directory on disk.
+/// Each output value is identified by a key derived from the node type (including the template
+/// of an instanced network), the output name and the keys of all its influencing inputs - a connected
+/// input uses the key of its upstream output, an unconnected input a hash of its serialized value.
+/// Results of computes running longer than a threshold are stored using their binary serialization
+/// (see BinaryIO), or using their JSON serialization if no binary serialization is registered for
+/// their type. Outputs of types without either serialization are never looked up in the cache.
+class DiskCache : public dependency_graph::ComputeCache {
+  public:
+	DiskCache(const boost::filesystem::path& directory,
+	          std::chrono::steady_clock::duration minComputeTime = std::chrono::seconds(1));
+
+	const boost::filesystem::path& directory() const;
+
+	/// a helper returning a key of a file on disk, including its modification time and size
+	static std::string fileKey(const boost::filesystem::path& path);
+
+	bool load(dependency_graph::Port& output, const std::vector<std::size_t>& inputs) override;
+	void store(dependency_graph::Port& output, const std::vector<std::size_t>& inputs,
+	           std::chrono::steady_clock::duration computeTime) override;
+
+  private:
+	/// returns the key identifying the current value of a port (empty if the value can't be identified)
+	std::string valueKey(const dependency_graph::Port& port);
+	/// returns the key of an output, derived from its influencing inputs (empty if any input can't be identified)
+	std::string outputKey(const dependency_graph::Port& output, const std::vector<std::size_t>& inputs);
+
+	boost::filesystem::path path(const std::string& key) const;
+
+	boost::filesystem::path m_directory;
+	std::chrono::steady_clock::duration m_minComputeTime;
+
+	// keys of values, indexed by their version
+	std::mutex m_mutex;
+	std::unordered_map<std::size_t, std::string> m_keys;
+};
+
+/// Registration of a custom cache key for a data type, for types whose value alone doesn't
+/// identify the compute result (e.g., a filename, where the content of the file matters as well).
+class CacheKeyBase : public boost::noncopyable {
+  public:
+	typedef std::function<std::string(const dependency_graph::Data&)> key_fn;
+
+	CacheKeyBase(const std::type_index& type, key_fn fn);
+	virtual ~CacheKeyBase();
+
+  private:
+	std::type_index m_type;
+};
+
+template <typename T>
+class CacheKey : public CacheKeyBase {
+  public:
+	typedef std::function<std::string(const T&)> key_fn;
+
+	CacheKey(key_fn fn)
+	    : CacheKeyBase(typeid(T), [fn](const dependency_graph::Data& data) { return fn(data.get<T>()); }) {
+	}
+};
+
+}  // namespace possumwood
@@ -168,11 +168,11 @@ std::unique_ptr<std::istream> Filesystem::read(const Filepath& path) {
 	if(!exists(path))
 		throw std::runtime_error("File " + path.toString() + " doesn't exist!");
 
-	return std::unique_ptr<std::istream>(new std::ifstream(path.toPath().string()));
+	return std::unique_ptr<std::istream>(new std::ifstream(path.toPath().string(), std::ios::binary));
 }
 
 std::unique_ptr<std::ostream> Filesystem::write(const Filepath& path) {
-	return std::unique_ptr<std::ostream>(new std::ofstream(path.toPath().string()));
+	return std::unique_ptr<std::ostream>(new std::ofstream(path.toPath().string(), std::ios::binary));
 }
 
 bool Filesystem::exists(const Filepath& path) const {
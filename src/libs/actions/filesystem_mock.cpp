@@ -36,8 +36,18 @@ struct Source {
 		return 0;
 	}
 
-	boost::iostreams::stream_offset seek(boost::iostreams::stream_offset /*off*/, std::ios_base::seekdir /*way*/) {
-		return 0;
+	boost::iostreams::stream_offset seek(boost::iostreams::stream_offset off, std::ios_base::seekdir way) {
+		boost::iostreams::stream_offset result = off;
+		if(way == std::ios_base::cur)
+			result += offset;
+		else if(way == std::ios_base::end)
+			result += data.length();
+
+		if(result < 0 || result > static_cast<boost::iostreams::stream_offset>(data.length()))
+			throw std::ios_base::failure("Seeking outside of a buffer.");
+
+		offset = result;
+		return result;
 	}
 
 	const std::string& data;
@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "binary_scene.h"
+
 namespace {
 std::map<std::type_index, possumwood::IOBase::to_fn>& s_toFn() {
 	static std::map<std::type_index, possumwood::IOBase::to_fn> s_map;
@@ -12,6 +14,21 @@ std::map<std::type_index, possumwood::IOBase::from_fn>& s_fromFn() {
 	static std::map<std::type_index, possumwood::IOBase::from_fn> s_map;
 	return s_map;
 }
+
+std::map<std::type_index, possumwood::BinaryIOBase::write_fn>& s_writeFn() {
+	static std::map<std::type_index, possumwood::BinaryIOBase::write_fn> s_map;
+	return s_map;
+}
+
+std::map<std::type_index, possumwood::BinaryIOBase::read_fn>& s_readFn() {
+	static std::map<std::type_index, possumwood::BinaryIOBase::read_fn> s_map;
+	return s_map;
+}
+
+std::map<std::type_index, possumwood::ImageWriterBase::write_fn>& s_imageFn() {
+	static std::map<std::type_index, possumwood::ImageWriterBase::write_fn> s_map;
+	return s_map;
+}
 }  // namespace
 
 namespace possumwood {
@@ -35,6 +52,31 @@ IOBase::~IOBase() {
 		s_fromFn().erase(it2);
 }
 
+BinaryIOBase::BinaryIOBase(const std::type_index& type, write_fn write, read_fn read) : m_type(type) {
+	s_writeFn()[type] = write;
+	s_readFn()[type] = read;
+}
+
+BinaryIOBase::~BinaryIOBase() {
+	auto it1 = s_writeFn().find(m_type);
+	if(it1 != s_writeFn().end())
+		s_writeFn().erase(it1);
+
+	auto it2 = s_readFn().find(m_type);
+	if(it2 != s_readFn().end())
+		s_readFn().erase(it2);
+}
+
+ImageWriterBase::ImageWriterBase(const std::type_index& type, write_fn write) : m_type(type) {
+	s_imageFn()[type] = write;
+}
+
+ImageWriterBase::~ImageWriterBase() {
+	auto it = s_imageFn().find(m_type);
+	if(it != s_imageFn().end())
+		s_imageFn().erase(it);
+}
+
 }  // namespace possumwood
 
 /////////////////////////////////////
@@ -42,7 +84,25 @@ IOBase::~IOBase() {
 namespace possumwood {
 namespace io {
 
+namespace {
+
+// key of a reference to a value stored in a binary scene chunk
+const char s_binaryKey[] = "$binary";
+
+}  // namespace
+
 void fromJson(const nlohmann::json& j, dependency_graph::Data& data) {
+	// a reference to a binary value, only valid while reading a binary scene
+	if(j.is_object() && j.size() == 1 && j.find(s_binaryKey) != j.end()) {
+		BinarySceneReader* reader = BinarySceneReader::current();
+		if(reader == nullptr)
+			throw std::runtime_error("Binary value reference of type " + data.type() +
+			                         " found outside of a binary scene.");
+
+		reader->read(j[s_binaryKey].get<std::size_t>(), data);
+		return;
+	}
+
 	auto it = s_fromFn().find(data.typeinfo());
 
 #ifndef NDEBUG
@@ -55,6 +115,14 @@ void fromJson(const nlohmann::json& j, dependency_graph::Data& data) {
 }
 
 void toJson(nlohmann::json& j, const dependency_graph::Data& data) {
+	// writing a binary scene - values with binary serialization are stored separately
+	BinarySceneWriter* writer = BinarySceneWriter::current();
+	if(writer != nullptr && hasBinary(data)) {
+		j = nlohmann::json::object();
+		j[s_binaryKey] = writer->add(data);
+		return;
+	}
+
 	auto it = s_toFn().find(data.typeinfo());
 #ifndef NDEBUG
 	if(it == s_toFn().end())
@@ -65,6 +133,38 @@ void toJson(nlohmann::json& j, const dependency_graph::Data& data) {
 	it->second(j, data);
 }
 
+bool hasBinary(const dependency_graph::Data& data) {
+	return s_writeFn().find(data.typeinfo()) != s_writeFn().end();
+}
+
+void readBinary(std::istream& in, dependency_graph::Data& data) {
+	auto it = s_readFn().find(data.typeinfo());
+	if(it == s_readFn().end())
+		throw std::runtime_error("No binary serialization implemented for type " + data.type());
+
+	it->second(in, data);
+}
+
+void writeBinary(std::ostream& out, const dependency_graph::Data& data) {
+	auto it = s_writeFn().find(data.typeinfo());
+	if(it == s_writeFn().end())
+		throw std::runtime_error("No binary serialization implemented for type " + data.type());
+
+	it->second(out, data);
+}
+
+bool hasImageWriter(const dependency_graph::Data& data) {
+	return s_imageFn().find(data.typeinfo()) != s_imageFn().end();
+}
+
+void writeImage(const std::string& filename, const dependency_graph::Data& data) {
+	auto it = s_imageFn().find(data.typeinfo());
+	if(it == s_imageFn().end())
+		throw std::runtime_error("No image writer implemented for type " + data.type());
+
+	it->second(filename, data);
+}
+
 }  // namespace io
 }  // namespace possumwood
 
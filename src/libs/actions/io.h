@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <iostream>
+#include <string>
 #include <typeindex>
 
 #include <boost/noncopyable.hpp>
@@ -46,10 +48,80 @@ class IO : public IOBase {
 	}
 };
 
+/// Binary IO base class, registering all existing binary IO instances / specialisations.
+/// Facilitates binary serialization of dependency_graph::Data<T> instances in plugins, for
+/// data types where JSON serialization is not practical (e.g., images or large arrays).
+class BinaryIOBase : public boost::noncopyable {
+  public:
+	typedef std::function<void(std::ostream&, const dependency_graph::Data&)> write_fn;
+	typedef std::function<void(std::istream&, dependency_graph::Data&)> read_fn;
+
+	BinaryIOBase(const std::type_index& type, write_fn write, read_fn read);
+	virtual ~BinaryIOBase();
+
+  private:
+	std::type_index m_type;
+};
+
+template <typename T>
+class BinaryIO : public BinaryIOBase {
+  public:
+	typedef std::function<void(std::ostream&, const T&)> write_fn;
+	typedef std::function<void(std::istream&, T&)> read_fn;
+
+	BinaryIO(write_fn write, read_fn read)
+	    : BinaryIOBase(
+	          typeid(T), [write](std::ostream& out, const dependency_graph::Data& data) { write(out, data.get<T>()); },
+	          [read](std::istream& in, dependency_graph::Data& data) {
+		          T val = data.get<T>();
+		          read(in, val);
+		          data.set<T>(std::move(val));
+	          }) {
+	}
+};
+
+/// Image writer base class, registering image writers of data types holding images (e.g., frames in
+/// plugins). Allows to write values to image files without knowing their type (e.g., outputs evaluated
+/// by the command-line application).
+class ImageWriterBase : public boost::noncopyable {
+  public:
+	typedef std::function<void(const std::string&, const dependency_graph::Data&)> write_fn;
+
+	ImageWriterBase(const std::type_index& type, write_fn write);
+	virtual ~ImageWriterBase();
+
+  private:
+	std::type_index m_type;
+};
+
+template <typename T>
+class ImageWriter : public ImageWriterBase {
+  public:
+	typedef std::function<void(const std::string&, const T&)> write_fn;
+
+	ImageWriter(write_fn write)
+	    : ImageWriterBase(typeid(T), [write](const std::string& filename, const dependency_graph::Data& data) {
+		      write(filename, data.get<T>());
+	      }) {
+	}
+};
+
 namespace io {
 
 void fromJson(const nlohmann::json& j, dependency_graph::Data& data);
 void toJson(nlohmann::json& j, const dependency_graph::Data& data);
 
+/// returns true if a binary serialization of the data type has been registered
+bool hasBinary(const dependency_graph::Data& data);
+
+void readBinary(std::istream& in, dependency_graph::Data& data);
+void writeBinary(std::ostream& out, const dependency_graph::Data& data);
+
+/// returns true if an image writer of the data type has been registered
+bool hasImageWriter(const dependency_graph::Data& data);
+
+/// writes a value to an image file (the format is determined by the filename's extension)
+void writeImage(const std::string& filename, const dependency_graph::Data& data);
+
 }  // namespace io
 }  // namespace possumwood
@@ -0,0 +1,103 @@
+#include "undo_journal.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <zlib.h>
+
+#include "io.h"
+
+namespace possumwood {
+
+UndoJournal::UndoJournal(const boost::filesystem::path& path) : m_path(path), m_end(0) {
+	m_file.open(path.string(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!m_file.good())
+		throw std::runtime_error("Error opening undo journal " + path.string() + ".");
+}
+
+UndoJournal::~UndoJournal() {
+	m_file.close();
+
+	boost::system::error_code err;
+	boost::filesystem::remove(m_path, err);
+}
+
+boost::optional<UndoJournal::Record> UndoJournal::write(const dependency_graph::Data& data) {
+	Record record{m_end, 0, 0, data.type(), io::hasBinary(data)};
+
+	// serialize the value
+	std::string raw;
+	if(record.binary) {
+		std::ostringstream ss(std::ios::binary);
+		io::writeBinary(ss, data);
+		raw = ss.str();
+	}
+	else if(dependency_graph::io::isSaveable(data)) {
+		nlohmann::json j;
+		io::toJson(j, data);
+		raw = j.dump();
+	}
+	else
+		return boost::none;
+
+	// compress it - fast compression, as this happens during interactive editing
+	uLongf size = compressBound(raw.size());
+	std::vector<Bytef> buffer(size);
+	if(compress2(buffer.data(), &size, reinterpret_cast<const Bytef*>(raw.data()), raw.size(), Z_BEST_SPEED) !=
+	   Z_OK)
+		return boost::none;
+
+	// and append it to the end of the file
+	m_file.clear();
+	m_file.seekp(m_end);
+	m_file.write(reinterpret_cast<const char*>(buffer.data()), size);
+	if(!m_file.good())
+		throw std::runtime_error("Error writing undo journal " + m_path.string() + ".");
+
+	record.size = size;
+	record.rawSize = raw.size();
+	m_end += size;
+
+	return record;
+}
+
+dependency_graph::Data UndoJournal::read(const Record& record) {
+	std::vector<Bytef> buffer(record.size);
+
+	m_file.clear();
+	m_file.seekg(record.offset);
+	if(!m_file.read(reinterpret_cast<char*>(buffer.data()), record.size))
+		throw std::runtime_error("Error reading undo journal " + m_path.string() + ".");
+
+	std::string raw(record.rawSize, '\0');
+	uLongf size = record.rawSize;
+	if(uncompress(reinterpret_cast<Bytef*>(&raw[0]), &size, buffer.data(), buffer.size()) != Z_OK ||
+	   size != record.rawSize)
+		throw std::runtime_error("Error decompressing a value of type " + record.type + " from undo journal " +
+		                         m_path.string() + ".");
+
+	dependency_graph::Data result = dependency_graph::Data::create(record.type);
+	if(record.binary) {
+		std::istringstream ss(raw, std::ios::binary);
+		io::readBinary(ss, result);
+	}
+	else
+		io::fromJson(nlohmann::json::parse(raw), result);
+
+	return result;
+}
+
+void UndoJournal::clear() {
+	m_file.close();
+	m_file.open(m_path.string(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	m_end = 0;
+}
+
+const boost::filesystem::path& UndoJournal::path() const {
+	return m_path;
+}
+
+}  // namespace possumwood
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+
+#include <dependency_graph/data.h>
+
+namespace possumwood {
+
+/// An append-only file of compressed values, storing the values held by old undo actions outside
+/// of the main memory (see UndoStack::setJournal()). Each value is serialized using its binary
+/// serialization if available (see BinaryIO), or its JSON serialization otherwise, and compressed
+/// using zlib. The file is created (truncated) on construction and removed on destruction.
+class UndoJournal : public boost::noncopyable {
+  public:
+	explicit UndoJournal(const boost::filesystem::path& path);
+	~UndoJournal();
+
+	/// a location of a single value in the journal
+	struct Record {
+		std::uint64_t offset, size, rawSize;
+		std::string type;
+		bool binary;
+	};
+
+	/// appends a value to the journal - returns none if the value can't be serialized
+	boost::optional<Record> write(const dependency_graph::Data& data);
+	/// reads a value back from the journal
+	dependency_graph::Data read(const Record& record);
+
+	/// discards all values, truncating the file
+	void clear();
+
+	const boost::filesystem::path& path() const;
+
+  private:
+	boost::filesystem::path m_path;
+	std::fstream m_file;
+	std::uint64_t m_end;
+};
+
+}  // namespace possumwood
@@ -3,17 +3,26 @@
 #include <boost/noncopyable.hpp>
 #include <cassert>
 #include <iostream>
+#include <set>
 #include <sstream>
 
 namespace possumwood {
 
+namespace {
+
+// maximum interval between two actions to be merged
+const std::chrono::milliseconds s_mergeInterval(1000);
+
+}  // namespace
+
 void UndoStack::Action::addCommand(const std::string& name, const std::function<void()>& redo,
-                                   const std::function<void()>& undo) {
+                                   const std::function<void()>& undo, const std::vector<Value>& redoValues,
+                                   const std::vector<Value>& undoValues) {
 	assert(undo);
 	assert(redo);
 
-	m_undo.push_back(Data{name, undo});
-	m_redo.push_back(Data{name, redo});
+	m_undo.push_back(Data{name, undo, undoValues});
+	m_redo.push_back(Data{name, redo, redoValues});
 }
 
 void UndoStack::Action::append(const Action& a) {
@@ -24,11 +33,30 @@ void UndoStack::Action::append(const Action& a) {
 		m_redo.push_back(c);
 }
 
+void UndoStack::Action::setMergeKey(const std::string& key) {
+	m_mergeKey = key;
+}
+
+std::vector<UndoStack::Action::Value> UndoStack::Action::values() const {
+	std::vector<Value> result;
+	std::set<const dependency_graph::Data*> unique;
+
+	for(auto& commands : {&m_redo, &m_undo})
+		for(auto& c : *commands)
+			for(auto& v : c.values)
+				if(unique.insert(v.get()).second)
+					result.push_back(v);
+
+	return result;
+}
+
 //////////////////////////
 
 UndoStack::UndoStack()
+    : m_memoryLimit(0)
 #ifndef NDEBUG
-    : m_executionInProgress(false)
+      ,
+      m_executionInProgress(false)
 #endif
 {
 }
@@ -116,9 +144,37 @@ dependency_graph::State UndoStack::execute(const Action& input_action, bool halt
 			}
 		}
 
+		// consecutive actions with the same merge key form a single undo step - the undo of the first action,
+		//   and the redo of the last one
+		const auto now = std::chrono::steady_clock::now();
+		if(!input_action.m_mergeKey.empty() && m_redoStack.empty() && !m_undoStack.empty() &&
+		   m_undoStack.back().m_mergeKey == input_action.m_mergeKey &&
+		   m_undoStack.back().m_undo.size() == action.m_undo.size() && now - m_lastExecution < s_mergeInterval) {
+			Action& last = m_undoStack.back();
+			last.m_redo = action.m_redo;
+
+			// the journal of the last action might refer to values that are not held anymore
+			std::set<const dependency_graph::Data*> values;
+			for(auto& v : last.values())
+				values.insert(v.get());
+
+			for(auto it = last.m_journal.begin(); it != last.m_journal.end();)
+				if(values.find(it->first) == values.end())
+					it = last.m_journal.erase(it);
+				else
+					++it;
+		}
+
 		// if no exception was thrown during the execution, add this command to the undo stack
-		m_undoStack.push_back(action);
+		else {
+			action.m_mergeKey = input_action.m_mergeKey;
+			m_undoStack.push_back(action);
+		}
+
 		m_redoStack.clear();
+		m_lastExecution = now;
+
+		applyMemoryLimit();
 	}
 
 #ifndef NDEBUG
@@ -137,6 +193,8 @@ void UndoStack::undo() {
 
 	// execute the last undo queue item
 	if(!m_undoStack.empty()) {
+		restore(m_undoStack.back());
+
 		for(std::vector<UndoStack::Action::Data>::const_reverse_iterator it = m_undoStack.back().m_undo.rbegin();
 		    it != m_undoStack.back().m_undo.rend(); ++it)
 			it->fn();
@@ -160,6 +218,8 @@ void UndoStack::redo() {
 
 	// execute the last redo queue item
 	if(!m_redoStack.empty()) {
+		restore(m_redoStack.back());
+
 		for(std::vector<Action::Data>::const_iterator it = m_redoStack.back().m_redo.begin();
 		    it != m_redoStack.back().m_redo.end(); ++it)
 			it->fn();
@@ -189,6 +249,94 @@ bool UndoStack::empty() const {
 void UndoStack::clear() {
 	m_undoStack.clear();
 	m_redoStack.clear();
+
+	if(m_journal)
+		m_journal->clear();
+}
+
+void UndoStack::setMemoryLimit(std::size_t bytes) {
+	m_memoryLimit = bytes;
+
+	applyMemoryLimit();
+}
+
+std::size_t UndoStack::memoryLimit() const {
+	return m_memoryLimit;
+}
+
+std::size_t UndoStack::memoryFootprint() const {
+	std::size_t result = 0;
+
+	for(auto& stack : {&m_undoStack, &m_redoStack})
+		for(auto& a : *stack)
+			for(auto& v : a.values())
+				result += v->size();
+
+	return result;
+}
+
+void UndoStack::setJournal(const boost::filesystem::path& path) {
+	// values in the previous journal are needed by the actions
+	for(auto& stack : {&m_undoStack, &m_redoStack})
+		for(auto& a : *stack)
+			restore(a);
+
+	m_journal.reset();
+	if(!path.empty())
+		m_journal = std::unique_ptr<UndoJournal>(new UndoJournal(path));
+
+	applyMemoryLimit();
+}
+
+void UndoStack::applyMemoryLimit() {
+	if(m_memoryLimit == 0)
+		return;
+
+	std::size_t footprint = memoryFootprint();
+
+	// move the values of the oldest actions to the journal first
+	if(m_journal)
+		for(std::size_t a = 0; a + 1 < m_undoStack.size() && footprint > m_memoryLimit; ++a)
+			for(auto& v : m_undoStack[a].values())
+				if(!v->empty()) {
+					Action& action = m_undoStack[a];
+
+					// values are not changed after the action was executed - a value journaled previously
+					//   doesn't need to be written again
+					auto it = action.m_journal.find(v.get());
+					if(it == action.m_journal.end()) {
+						auto record = m_journal->write(*v);
+						if(record)
+							it = action.m_journal.insert(std::make_pair(v.get(), *record)).first;
+					}
+
+					if(it != action.m_journal.end()) {
+						footprint -= v->size();
+						*v = dependency_graph::Data();
+					}
+				}
+
+	// and drop the oldest actions if that was not enough
+	std::size_t count = 0;
+	while(footprint > m_memoryLimit && count + 1 < m_undoStack.size()) {
+		for(auto& v : m_undoStack[count].values())
+			footprint -= v->size();
+		++count;
+	}
+
+	m_undoStack.erase(m_undoStack.begin(), m_undoStack.begin() + count);
+}
+
+void UndoStack::restore(Action& action) {
+	if(!action.m_journal.empty()) {
+		assert(m_journal);
+
+		for(auto& v : action.values()) {
+			auto it = action.m_journal.find(v.get());
+			if(it != action.m_journal.end() && v->empty())
+				*v = m_journal->read(it->second);
+		}
+	}
 }
 
 std::ostream& operator<<(std::ostream& out, const UndoStack::Action& action) {
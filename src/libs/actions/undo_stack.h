@@ -1,12 +1,19 @@
 #pragma once
 
+#include <dependency_graph/data.h>
 #include <dependency_graph/state.h>
 
+#include <boost/filesystem/path.hpp>
 #include <boost/noncopyable.hpp>
+#include <chrono>
 #include <functional>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "undo_journal.h"
+
 namespace possumwood {
 
 /// A simple implementation of undo stack based on Command design pattern.
@@ -22,18 +29,38 @@ class UndoStack : public boost::noncopyable {
 	/// executing an action, all commands of a failed action are rolled back.
 	class Action {
 	  public:
-		void addCommand(const std::string& name, const std::function<void()>& redo, const std::function<void()>& undo);
+		typedef std::shared_ptr<dependency_graph::Data> Value;
+
+		/// adds a command. The values captured by the redo and undo functors (e.g., the new and the original
+		/// value of a port) can be listed explicitly - they are then accounted for in the memory limit of the
+		/// stack, and can be moved to its journal while not needed (see UndoStack::setMemoryLimit()).
+		void addCommand(const std::string& name, const std::function<void()>& redo, const std::function<void()>& undo,
+		                const std::vector<Value>& redoValues = std::vector<Value>(),
+		                const std::vector<Value>& undoValues = std::vector<Value>());
 
 		/// appends all commands from action 'a' to this action
 		void append(const Action& a);
 
+		/// Consecutively executed actions with the same non-empty merge key, in a quick succession (e.g., a
+		/// series of changes of a single port value while dragging a slider), are merged into a single undo
+		/// step, undoing to the state before the first of them. Not transferred by append().
+		void setMergeKey(const std::string& key);
+
 	  private:
 		struct Data {
 			std::string name;
 			std::function<void()> fn;
+			std::vector<Value> values;
 		};
 
+		/// returns all values held by this action (without duplicates)
+		std::vector<Value> values() const;
+
 		std::vector<Data> m_redo, m_undo;
+		std::string m_mergeKey;
+
+		/// values of this action moved to the journal (restored on undo or redo)
+		std::map<const dependency_graph::Data*, UndoJournal::Record> m_journal;
 
 		/// the actual implementation is handled in UndoStack code.
 		friend class UndoStack;
@@ -64,10 +91,35 @@ class UndoStack : public boost::noncopyable {
 
 	void clear();
 
+	/// Limits the memory held by the values of the actions in the stack (in bytes, 0 for no limit). When
+	/// exceeded, the values of the oldest actions are moved to the journal (if set), and the oldest actions
+	/// are dropped if that is not sufficient. The last action is always kept.
+	void setMemoryLimit(std::size_t bytes);
+	std::size_t memoryLimit() const;
+
+	/// approximate memory held by the values of all actions in the stack (not including the journal)
+	std::size_t memoryFootprint() const;
+
+	/// Sets a file for storing the values of old actions over the memory limit, compressed and read back
+	/// on undo. The file is created by this call, and removed with the stack. An empty path disables the
+	/// journal.
+	void setJournal(const boost::filesystem::path& path);
+
   protected:
   private:
+	/// moves values to the journal, and drops the oldest actions, to fit the memory limit
+	void applyMemoryLimit();
+	/// reads back all values of an action moved to the journal
+	void restore(Action& action);
+
 	std::vector<Action> m_undoStack, m_redoStack;
 
+	// time of the last execution, for merging of actions
+	std::chrono::steady_clock::time_point m_lastExecution;
+
+	std::size_t m_memoryLimit;
+	std::unique_ptr<UndoJournal> m_journal;
+
 #ifndef NDEBUG
 	bool m_executionInProgress;
 #endif
@@ -0,0 +1,294 @@
+#include "async_evaluation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_set>
+
+#include "evaluation_plan.h"
+#include "graph.h"
+#include "node_base.inl"
+
+namespace dependency_graph {
+
+namespace {
+
+thread_local AsyncEvaluation* s_current = nullptr;
+
+}
+
+EvaluationCancelled::EvaluationCancelled() : std::runtime_error("Evaluation cancelled") {
+}
+
+/////////////////////////////////////
+
+AsyncEvaluation::AsyncEvaluation(Port& port, std::weak_ptr<Graph> graph)
+    : m_port(&port),
+      m_graph(graph),
+      m_callerThread(std::this_thread::get_id()),
+      m_cancelled(false),
+      m_computed(0),
+      m_total(1),
+      m_finished(false) {
+}
+
+void AsyncEvaluation::cancel() {
+	m_cancelled = true;
+}
+
+bool AsyncEvaluation::isCancelled() const {
+	return m_cancelled;
+}
+
+bool AsyncEvaluation::isFinished() const {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_finished;
+}
+
+void AsyncEvaluation::wait() const {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return m_finished; });
+	}
+
+	processCallbacks();
+}
+
+bool AsyncEvaluation::waitFor(std::chrono::steady_clock::duration timeout) const {
+	bool finished = false;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		finished = m_condition.wait_for(lock, timeout, [this]() { return m_finished; });
+	}
+
+	processCallbacks();
+
+	return finished;
+}
+
+Data AsyncEvaluation::get() const {
+	wait();
+
+	if(m_error != nullptr)
+		std::rethrow_exception(m_error);
+
+	return m_result;
+}
+
+float AsyncEvaluation::progress() const {
+	if(isFinished())
+		return 1.0f;
+
+	return std::min(1.0f, (float)m_computed / (float)m_total);
+}
+
+void AsyncEvaluation::processCallbacks() const {
+	assert(std::this_thread::get_id() == m_callerThread);
+
+	std::vector<Deferred> callbacks;
+	{
+		std::unique_lock<std::mutex> lock(m_callbacksMutex);
+		callbacks.swap(m_callbacks);
+	}
+
+	std::shared_ptr<Graph> graph = m_graph.lock();
+	if(!graph)
+		return;
+
+	// the nodes are found by their ids - the graph could have changed since the callbacks were deferred
+	for(const Deferred& d : callbacks) {
+		NodeBase* node = graph->nodeIndex().find(d.node);
+		if(node == nullptr || d.port >= node->portCount())
+			continue;
+
+		switch(d.callback) {
+			case kStateChanged:
+				graph->stateChanged(*node);
+				break;
+			case kValueChanged:
+				node->port(d.port).m_valueCallbacks();
+				break;
+			case kFlagsChanged:
+				node->port(d.port).m_flagsCallbacks();
+				break;
+		}
+	}
+}
+
+bool AsyncEvaluation::requiresMainThread() const {
+	std::vector<const Port*> stack(1, m_port);
+	std::unordered_set<const Port*> visited;
+
+	// only dirty ports can trigger a compute
+	while(!stack.empty()) {
+		const Port* p = stack.back();
+		stack.pop_back();
+
+		if(p->isDirty() && visited.insert(p).second) {
+			if(p->m_linkedFromPort)
+				stack.push_back(p->m_linkedFromPort);
+
+			else if(p->category() == Attr::kInput) {
+				if(p->m_connectedFrom)
+					stack.push_back(p->m_connectedFrom);
+			}
+
+			else if(p->node().metadata()->flags() & Metadata::kMainThreadOnly)
+				return true;
+
+			else
+				for(std::size_t i : p->node().metadata()->influencedBy(p->index()))
+					stack.push_back(&p->node().port(i));
+		}
+	}
+
+	return false;
+}
+
+bool AsyncEvaluation::defer(Callback callback, const NodeBase& node, std::size_t port) {
+	if(s_current == nullptr || std::this_thread::get_id() == s_current->m_callerThread)
+		return false;
+
+	std::unique_lock<std::mutex> lock(s_current->m_callbacksMutex);
+	s_current->m_callbacks.push_back(Deferred{callback, node.index(), port});
+
+	return true;
+}
+
+void AsyncEvaluation::run() {
+	Scope scope(this);
+
+	try {
+		checkCancelled();
+
+		// the number of computes to run, for progress reporting
+		if(m_port->isDirty() && m_port->category() == Attr::kOutput && m_port->m_linkedFromPort == nullptr) {
+			std::shared_ptr<const EvaluationPlan> plan = m_port->node().graph().evaluationPlan(*m_port);
+
+			const std::vector<bool> required = plan->requiredSteps();
+
+			std::size_t total = 1;
+			for(std::size_t s = 0; s < plan->size(); ++s)
+				if((*plan)[s].kind == EvaluationPlan::Step::kCompute && required[s])
+					++total;
+			m_total = total;
+		}
+
+		finish(m_port->getData(), nullptr);
+	}
+	catch(...) {
+		finish(Data(), std::current_exception());
+	}
+}
+
+void AsyncEvaluation::finish(const Data& result, std::exception_ptr error) {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		m_result = result;
+		m_error = error;
+		m_finished = true;
+	}
+
+	m_condition.notify_all();
+}
+
+void AsyncEvaluation::computeFinished() {
+	++m_computed;
+}
+
+bool AsyncEvaluation::cancelled() {
+	return s_current != nullptr && s_current->isCancelled();
+}
+
+void AsyncEvaluation::checkCancelled() {
+	if(cancelled())
+		throw EvaluationCancelled();
+}
+
+AsyncEvaluation* AsyncEvaluation::current() {
+	return s_current;
+}
+
+AsyncEvaluation::Scope::Scope(AsyncEvaluation* eval) : m_previous(s_current) {
+	s_current = eval;
+}
+
+AsyncEvaluation::Scope::~Scope() {
+	s_current = m_previous;
+}
+
+/////////////////////////////////////
+
+EvaluationQueue::EvaluationQueue(Graph& graph) : m_graph(&graph, [](Graph*) {}), m_quit(false) {
+	m_thread = std::thread([this]() { worker(); });
+}
+
+EvaluationQueue::~EvaluationQueue() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_quit = true;
+
+		for(auto& e : m_queue)
+			e->cancel();
+		if(m_running)
+			m_running->cancel();
+	}
+
+	m_condition.notify_all();
+	m_thread.join();
+}
+
+std::shared_ptr<AsyncEvaluation> EvaluationQueue::push(Port& port) {
+	std::shared_ptr<AsyncEvaluation> result(new AsyncEvaluation(port, m_graph));
+
+	// computes that have to run on the main thread can't be run by the worker
+	if(result->requiresMainThread()) {
+		result->run();
+		return result;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		assert(!m_quit);
+
+		m_queue.push_back(result);
+	}
+
+	m_condition.notify_one();
+
+	return result;
+}
+
+bool EvaluationQueue::isEvaluating() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// the running evaluation is reset by the worker only after its waiters were released
+	return !m_queue.empty() || (m_running != nullptr && !m_running->isFinished());
+}
+
+void EvaluationQueue::worker() {
+	while(true) {
+		std::shared_ptr<AsyncEvaluation> eval;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_quit || !m_queue.empty(); });
+
+			// pending evaluations are still finished (as cancelled) on quit, to release their waiters
+			if(m_queue.empty())
+				return;
+
+			eval = m_queue.front();
+			m_queue.pop_front();
+
+			m_running = eval;
+		}
+
+		eval->run();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_running.reset();
+	}
+}
+
+}  // namespace dependency_graph
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "data.h"
+#include "unique_id.h"
+
+namespace dependency_graph {
+
+class Graph;
+class NodeBase;
+class Port;
+
+/// Thrown by an evaluation that was cancelled using its AsyncEvaluation handle
+class EvaluationCancelled : public std::runtime_error {
+  public:
+	EvaluationCancelled();
+};
+
+/// Handle of an asynchronous evaluation of a port, started by Graph::evaluateAsync().
+///
+/// The cancellation is checked between the computes of individual nodes, and can be polled from
+/// long-running compute functions (see Values::isCancelled() and Values::checkCancelled()).
+/// A cancelled evaluation leaves all ports that were not evaluated yet dirty, to be evaluated
+/// on the next pull. The progress is reported via Graph::onStateChanged() after each
+/// finished compute, and can be read using progress().
+///
+/// Graph and port callbacks triggered by the evaluation are never called from the worker thread -
+/// they are deferred, and called on the thread that started the evaluation by processCallbacks()
+/// (e.g., polled by a UI timer), wait(), waitFor() or get(). An evaluation with any node flagged
+/// as Metadata::kMainThreadOnly in its dirty upstream is not run on the worker thread at all - it
+/// is evaluated synchronously by Graph::evaluateAsync(), which returns an already finished handle.
+class AsyncEvaluation : public boost::noncopyable {
+  public:
+	/// requests cancellation of this evaluation (does not wait for the evaluation to stop)
+	void cancel();
+	bool isCancelled() const;
+
+	/// returns true if this evaluation finished (successfully, with an error or cancelled)
+	bool isFinished() const;
+
+	/// waits for this evaluation to finish
+	void wait() const;
+	/// waits for this evaluation to finish, with a timeout. Returns isFinished().
+	bool waitFor(std::chrono::steady_clock::duration timeout) const;
+
+	/// waits for this evaluation to finish, and returns the evaluated value. Rethrows
+	/// any exception thrown by the evaluation (EvaluationCancelled if cancelled).
+	Data get() const;
+
+	/// returns the progress of the evaluation in the range <0, 1>, as the ratio of finished
+	/// computes to the number of dirty outputs in the upstream of the evaluated port
+	float progress() const;
+
+	/// calls the graph and port callbacks deferred by the evaluation since the last call (does nothing
+	/// once the graph is destroyed). Has to be called on the thread that started the evaluation.
+	void processCallbacks() const;
+
+	/// returns true if the evaluation running on the calling thread was cancelled
+	static bool cancelled();
+	/// throws EvaluationCancelled if the evaluation running on the calling thread was cancelled
+	static void checkCancelled();
+
+  private:
+	AsyncEvaluation(Port& port, std::weak_ptr<Graph> graph);
+
+	/// evaluates the port on the calling thread, and stores the result
+	void run();
+	void finish(const Data& result, std::exception_ptr error);
+
+	/// returns true if the dirty upstream of the port contains any node flagged as Metadata::kMainThreadOnly
+	bool requiresMainThread() const;
+
+	enum Callback { kStateChanged, kValueChanged, kFlagsChanged };
+
+	/// defers a callback of a node (or of its port) triggered on a thread other than the one that started
+	/// the evaluation running on the calling thread. Returns false if the callback should be called directly.
+	static bool defer(Callback callback, const NodeBase& node, std::size_t port = 0);
+
+	/// records a finished compute, for progress reporting
+	void computeFinished();
+
+	/// returns the evaluation running on the calling thread (null if none)
+	static AsyncEvaluation* current();
+
+	/// RAII guard, marking the calling thread as running an evaluation
+	class Scope : public boost::noncopyable {
+	  public:
+		Scope(AsyncEvaluation* eval);
+		~Scope();
+
+	  private:
+		AsyncEvaluation* m_previous;
+	};
+
+	Port* m_port;
+	// expires with the graph's evaluation queue - the deferred callbacks are dropped after that
+	std::weak_ptr<Graph> m_graph;
+	std::thread::id m_callerThread;
+
+	std::atomic<bool> m_cancelled;
+	std::atomic<std::size_t> m_computed, m_total;
+
+	mutable std::mutex m_mutex;
+	mutable std::condition_variable m_condition;
+	bool m_finished;
+	Data m_result;
+	std::exception_ptr m_error;
+
+	struct Deferred {
+		Callback callback;
+		UniqueId node;
+		std::size_t port;
+	};
+
+	mutable std::mutex m_callbacksMutex;
+	mutable std::vector<Deferred> m_callbacks;
+
+	friend class EvaluationQueue;
+	friend class Graph;
+	friend class Scheduler;
+	friend class NodeBase;
+	friend class Port;
+};
+
+/// A worker thread running the asynchronous evaluations of a single graph in the order
+/// of their submission. Evaluations of one graph are never run concurrently - the parallelism
+/// within one evaluation is controlled by Graph::setParallelEvaluation().
+class EvaluationQueue : public boost::noncopyable {
+  public:
+	EvaluationQueue(Graph& graph);
+	/// cancels all pending evaluations, and waits for the running one to finish
+	~EvaluationQueue();
+
+	/// queues an evaluation of a port (or evaluates it on the calling thread, if it requires the main thread)
+	std::shared_ptr<AsyncEvaluation> push(Port& port);
+
+	/// returns true if any evaluation is queued or running (and not finished yet)
+	bool isEvaluating();
+
+  private:
+	void worker();
+
+	// a non-owning pointer to the graph, observed by the evaluations to detect its destruction
+	std::shared_ptr<Graph> m_graph;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<std::shared_ptr<AsyncEvaluation>> m_queue;
+	std::shared_ptr<AsyncEvaluation> m_running;
+	bool m_quit;
+
+	std::thread m_thread;
+};
+
+}  // namespace dependency_graph
@@ -0,0 +1,8 @@
+#include "compute_cache.h"
+
+namespace dependency_graph {
+
+ComputeCache::~ComputeCache() {
+}
+
+}  // namespace dependency_graph
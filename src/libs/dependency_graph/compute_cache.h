@@ -0,0 +1,26 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <vector>
+
+namespace dependency_graph {
+
+class Port;
+
+/// Interface of a persistent cache of compute results (see Graph::setComputeCache()). The cache
+/// is consulted in NodeBase::computeOutput(), after all inputs influencing the output are
+/// evaluated - a successful load replaces the compute of the output.
+class ComputeCache : public boost::noncopyable {
+  public:
+	virtual ~ComputeCache();
+
+	/// attempts to set the value of an output port from the cache. Returns true on success.
+	virtual bool load(Port& output, const std::vector<std::size_t>& inputs) = 0;
+
+	/// called after each successful compute of an output port, with the duration of its compute
+	virtual void store(Port& output, const std::vector<std::size_t>& inputs,
+	                   std::chrono::steady_clock::duration computeTime) = 0;
+};
+
+}  // namespace dependency_graph
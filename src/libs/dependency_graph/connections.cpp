@@ -1,23 +1,16 @@
 #include "connections.h"
 
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+
 #include "graph.h"
 #include "port.h"
+#include "topological_order.h"
 
 namespace dependency_graph {
 
-Connections::PortId Connections::getId(const Port& p) const {
-	return Connections::PortId{p.node().index(), p.index()};
-}
-
-const Port& Connections::getPort(const Connections::PortId& id) const {
-	return m_parent->nodes()[id.nodeIndex].port(id.portIndex);
-}
-
-Port& Connections::getPort(const Connections::PortId& id) {
-	return m_parent->nodes()[id.nodeIndex].port(id.portIndex);
-}
-
-Connections::Connections(Network* parent) : m_parent(parent) {
+Connections::Connections(Network* parent) : m_parent(parent), m_size(0) {
 }
 
 void Connections::add(Port& src, Port& dest) {
@@ -27,8 +20,15 @@ void Connections::add(Port& src, Port& dest) {
 	if(dest.category() != Attr::kInput)
 		throw std::runtime_error("Attempting to connect an output as the target of a connection.");
 
+	if(dest.m_connectedFrom != nullptr)
+		throw std::runtime_error("Attempting to connect an already connected input.");
+
 	// make a new connection
-	m_connections.left.insert(std::make_pair(getId(src), getId(dest)));
+	src.m_connectedTo.push_back(&dest);
+	dest.m_connectedFrom = &src;
+	++m_size;
+
+	m_parent->graph().invalidateEvaluationPlans();
 
 	// and run the callback
 	m_parent->graph().connected(src, dest);
@@ -41,117 +41,197 @@ void Connections::remove(Port& src, Port& dest) {
 	if(dest.category() != Attr::kInput)
 		throw std::runtime_error("Attempting to connect an output as the target of a connection.");
 
-	// try to find the connection (from right - only one connection allowed that way)
-	auto it = m_connections.right.find(getId(dest));
-	if((it == m_connections.right.end()) || (it->second != getId(src)))
+	// try to find the connection (from the input - only one connection allowed that way)
+	if(dest.m_connectedFrom != &src)
 		throw std::runtime_error("Attempting to remove a non-existing connection.");
 
+	auto it = std::find(src.m_connectedTo.begin(), src.m_connectedTo.end(), &dest);
+	assert(it != src.m_connectedTo.end());
+
 	// run the callback
 	m_parent->graph().disconnected(src, dest);
 
 	// and remove it
-	m_connections.right.erase(it);
+	src.m_connectedTo.erase(it);
+	dest.m_connectedFrom = nullptr;
+	--m_size;
+
+	m_parent->graph().invalidateEvaluationPlans();
+}
+
+void Connections::connect(const std::vector<std::pair<Port*, Port*>>& connections) {
+	if(connections.empty())
+		return;
+
+	// test the ports of the batch
+	std::unordered_set<const Port*> inputs;
+	for(auto& c : connections) {
+		assert(c.first != nullptr && c.second != nullptr);
+
+		if(&c.first->node().network() != m_parent || &c.second->node().network() != m_parent) {
+			std::stringstream msg;
+			msg << "Ports " << c.first->node().name() << "/" << c.first->name() << " and " << c.second->node().name()
+			    << "/" << c.second->name() << " don't belong to nodes of this network";
+
+			throw std::runtime_error(msg.str());
+		}
+
+		if(c.first->category() != Attr::kOutput || c.second->category() != Attr::kInput) {
+			std::stringstream msg;
+			msg << "Ports " << c.first->node().name() << "/" << c.first->name() << " and " << c.second->node().name()
+			    << "/" << c.second->name() << " - a connection has to lead from an output to an input";
+
+			throw std::runtime_error(msg.str());
+		}
+
+		if(c.second->m_connectedFrom != nullptr || !inputs.insert(c.second).second) {
+			std::stringstream msg;
+			msg << "Port " << c.second->node().name() << "/" << c.second->name() << " is already connected";
+
+			throw std::runtime_error(msg.str());
+		}
+	}
+
+	// test the recursivity of the whole batch at once
+	auto cycle = TopologicalOrder::insert(connections);
+	if(cycle != connections.end()) {
+		std::stringstream msg;
+		msg << "A connection between " << cycle->first->node().name() << "/" << cycle->first->name() << " and "
+		    << cycle->second->node().name() << "/" << cycle->second->name() << " would cause a cyclical dependency";
+
+		throw std::runtime_error(msg.str());
+	}
+
+	// make the connections, reverting the batch on an error
+	std::size_t index = 0;
+	try {
+		for(; index < connections.size(); ++index)
+			connections[index].first->doConnect(*connections[index].second);
+	}
+	catch(...) {
+		while(index > 0) {
+			--index;
+			connections[index].first->disconnect(*connections[index].second);
+		}
+
+		throw;
+	}
 }
 
 bool Connections::isConnected(const NodeBase& n) const {
-	for(auto& c : m_connections.left)
-		if(c.first.nodeIndex == n.index() || c.second.nodeIndex == n.index())
+	for(std::size_t p = 0; p < n.portCount(); ++p)
+		if(n.port(p).m_connectedFrom != nullptr || !n.port(p).m_connectedTo.empty())
 			return true;
 	return false;
 }
 
 boost::optional<const Port&> Connections::connectedFrom(const Port& p) const {
-	auto it = m_connections.right.lower_bound(getId(p));
-
-	if((it == m_connections.right.end()) || (it->first != getId(p)))
+	if(p.m_connectedFrom == nullptr)
 		return boost::optional<const Port&>();
-	else {
-		assert(m_connections.right.count(getId(p)) == 1);
-		return getPort(it->second);
-	}
+	else
+		return *p.m_connectedFrom;
 }
 
-std::vector<std::reference_wrapper<const Port>> Connections::connectedTo(const Port& p) const {
-	auto it1 = m_connections.left.lower_bound(getId(p));
-	auto it2 = m_connections.left.upper_bound(getId(p));
-
-	std::vector<std::reference_wrapper<const Port>> result;
-	for(auto it = it1; it != it2; ++it)
-		result.push_back(std::cref(getPort(it->second)));
-	return result;
+Connections::const_port_range Connections::connectedTo(const Port& p) const {
+	return const_port_range(boost::make_transform_iterator(p.m_connectedTo.begin(), PortRef<const Port>()),
+	                        boost::make_transform_iterator(p.m_connectedTo.end(), PortRef<const Port>()));
 }
 
 boost::optional<Port&> Connections::connectedFrom(Port& p) {
 	if(p.category() != Attr::kInput)
 		throw std::runtime_error("Connected From request can be only run on input ports.");
 
-	auto it = m_connections.right.lower_bound(getId(p));
-
-	if((it == m_connections.right.end()) || (it->first != getId(p)))
+	if(p.m_connectedFrom == nullptr)
 		return boost::optional<Port&>();
-	else {
-		assert(m_connections.right.count(getId(p)) == 1);
-		return getPort(it->second);
-	}
+	else
+		return *p.m_connectedFrom;
 }
 
-std::vector<std::reference_wrapper<Port>> Connections::connectedTo(Port& p) {
+Connections::port_range Connections::connectedTo(Port& p) {
 	if(p.category() != Attr::kOutput)
 		throw std::runtime_error("Connected To request can be only run on output ports.");
 
-	auto it1 = m_connections.left.lower_bound(getId(p));
-	auto it2 = m_connections.left.upper_bound(getId(p));
-
-	std::vector<std::reference_wrapper<Port>> result;
-	for(auto it = it1; it != it2; ++it)
-		result.push_back(std::ref(getPort(it->second)));
-	return result;
+	return port_range(boost::make_transform_iterator(p.m_connectedTo.begin(), PortRef<Port>()),
+	                  boost::make_transform_iterator(p.m_connectedTo.end(), PortRef<Port>()));
 }
 
 size_t Connections::size() const {
-	return m_connections.size();
+	return m_size;
 }
 
 bool Connections::empty() const {
-	return m_connections.empty();
+	return m_size == 0;
 }
 
-/// dereferencing function to convert internal connection representation to a pair of port references
-const std::pair<const Port&, const Port&> Connections::convert(
-    const Connections::connections_container::left_value_type& val) const {
-	const Port& left = getPort(val.first);
-	const Port& right = getPort(val.second);
+Connections::const_iterator Connections::begin() const {
+	return const_iterator(m_parent->nodes().m_nodes.begin(), m_parent->nodes().m_nodes.end());
+}
 
-	return std::pair<const Port&, const Port&>(left, right);
+Connections::const_iterator Connections::end() const {
+	return const_iterator(m_parent->nodes().m_nodes.end(), m_parent->nodes().m_nodes.end());
 }
 
-/// dereferencing function to convert internal connection representation to a pair of port references
-const std::pair<Port&, Port&> Connections::convertConst(
-    const Connections::connections_container::left_value_type& val) {
-	Port& left = getPort(val.first);
-	Port& right = getPort(val.second);
+Connections::iterator Connections::begin() {
+	return iterator(m_parent->nodes().m_nodes.begin(), m_parent->nodes().m_nodes.end());
+}
 
-	return std::pair<Port&, Port&>(left, right);
+Connections::iterator Connections::end() {
+	return iterator(m_parent->nodes().m_nodes.end(), m_parent->nodes().m_nodes.end());
 }
 
-Connections::const_iterator Connections::begin() const {
-	auto fn = [this](const Connections::connections_container::left_value_type& val) { return convert(val); };
-	return const_iterator(m_connections.left.begin(), fn);
+/////
+
+template <typename PORT>
+Connections::Iterator<PORT>::Iterator() : m_port(0), m_connection(0) {
 }
 
-Connections::const_iterator Connections::end() const {
-	auto fn = [this](const Connections::connections_container::left_value_type& val) { return convert(val); };
-	return const_iterator(m_connections.left.end(), fn);
+template <typename PORT>
+Connections::Iterator<PORT>::Iterator(Nodes::NodeArray::const_iterator node, Nodes::NodeArray::const_iterator end)
+    : m_node(node), m_end(end), m_port(0), m_connection(0) {
+	settle();
 }
 
-Connections::iterator Connections::begin() {
-	auto fn = [this](const Connections::connections_container::left_value_type& val) { return convertConst(val); };
-	return iterator(m_connections.left.begin(), fn);
+template <typename PORT>
+void Connections::Iterator<PORT>::settle() {
+	while(m_node != m_end) {
+		const NodeBase& node = **m_node;
+
+		while(m_port < node.portCount()) {
+			if(m_connection < node.port(m_port).m_connectedTo.size())
+				return;
+
+			++m_port;
+			m_connection = 0;
+		}
+
+		++m_node;
+		m_port = 0;
+		m_connection = 0;
+	}
 }
 
-Connections::iterator Connections::end() {
-	auto fn = [this](const Connections::connections_container::left_value_type& val) { return convertConst(val); };
-	return iterator(m_connections.left.end(), fn);
+template <typename PORT>
+void Connections::Iterator<PORT>::increment() {
+	assert(m_node != m_end);
+
+	++m_connection;
+	settle();
+}
+
+template <typename PORT>
+bool Connections::Iterator<PORT>::equal(const Iterator& it) const {
+	return m_node == it.m_node && m_port == it.m_port && m_connection == it.m_connection;
 }
 
+template <typename PORT>
+const std::pair<PORT&, PORT&> Connections::Iterator<PORT>::dereference() const {
+	assert(m_node != m_end);
+
+	Port& out = (*m_node)->port(m_port);
+	return std::pair<PORT&, PORT&>(out, *out.m_connectedTo[m_connection]);
+}
+
+template class Connections::Iterator<Port>;
+template class Connections::Iterator<const Port>;
+
 }  // namespace dependency_graph
@@ -1,13 +1,14 @@
 #pragma once
 
-#include <boost/bimap.hpp>
-#include <boost/bimap/multiset_of.hpp>
+#include <boost/iterator/iterator_facade.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/optional.hpp>
-#include <boost/signals2.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <functional>
+#include <vector>
 
-#include "unique_id.h"
+#include "nodes.h"
 
 namespace dependency_graph {
 
@@ -15,76 +16,72 @@ class Port;
 class NodeBase;
 class Network;
 
-/// A simple container class for all connections. It stores connections as pointers to related
-/// ports and does *not* ensure that these are valid in any way. An external mechanism needs
-/// to call appropriate functions when needed.
+/// A simple container class for all connections. Connections are stored directly on the ports
+/// as adjacency lists (each input holds a pointer to its connected output, each output holds
+/// an array of pointers to its connected inputs), making all per-port queries O(degree) without
+/// any lookups or allocations. This class does *not* ensure that the stored ports are valid in
+/// any way - an external mechanism needs to call appropriate functions when needed.
 class Connections : public boost::noncopyable {
   private:
-	struct PortId {
-		UniqueId nodeIndex;
-		std::size_t portIndex;
-
-		bool operator==(const PortId& pi) const {
-			return nodeIndex == pi.nodeIndex && portIndex == pi.portIndex;
-		}
-
-		bool operator!=(const PortId& pi) const {
-			return nodeIndex != pi.nodeIndex || portIndex != pi.portIndex;
-		}
-
-		bool operator<(const PortId& pi) const {
-			if(nodeIndex != pi.nodeIndex)
-				return nodeIndex < pi.nodeIndex;
-			return portIndex < pi.portIndex;
+	/// dereferencing functor for port ranges
+	template <typename PORT>
+	struct PortRef {
+		std::reference_wrapper<PORT> operator()(Port* p) const {
+			return std::ref(*p);
 		}
 	};
 
-	/// the container for connection data (a helper define - not useable outside the implementation cpp)
-	typedef boost::bimap<boost::bimaps::multiset_of<PortId>,  // output
-	                     PortId                               // input (only one output to any input)
-	                     >
-	    connections_container;
+	template <typename PORT>
+	class Iterator;
 
   public:
+	/// a non-allocating range of input ports connected to an output port
+	typedef boost::iterator_range<boost::transform_iterator<PortRef<const Port>, std::vector<Port*>::const_iterator>>
+	    const_port_range;
+	/// a non-allocating range of input ports connected to an output port
+	typedef boost::iterator_range<boost::transform_iterator<PortRef<Port>, std::vector<Port*>::const_iterator>>
+	    port_range;
+
 	/// returns the connections of an input port (result contains references
 	///   to output ports connected to this input)
 	boost::optional<const Port&> connectedFrom(const Port& p) const;
 	/// returns the connections of an output port (result contains references
 	///   to input ports connected to this output)
-	std::vector<std::reference_wrapper<const Port>> connectedTo(const Port& p) const;
+	const_port_range connectedTo(const Port& p) const;
 
 	/// returns the connections of an input port (result contains references
 	///   to output ports connected to this input)
 	boost::optional<Port&> connectedFrom(Port& p);
 	/// returns the connections of an output port (result contains references
 	///   to input ports connected to this output)
-	std::vector<std::reference_wrapper<Port>> connectedTo(Port& p);
+	port_range connectedTo(Port& p);
 
 	/// returns true if a node has any connections
 	bool isConnected(const NodeBase& n) const;
 
+	/// creates a batch of connections between ports of this network (each pair is an output
+	/// and an input port). The whole batch is tested for cycles at once, which is much
+	/// faster than connecting the ports one by one when building large networks (e.g.,
+	/// when loading a scene). Throws std::runtime_error without making any connections if any
+	/// connection of the batch is invalid.
+	void connect(const std::vector<std::pair<Port*, Port*>>& connections);
+
 	/// returns the total number of valid connections in this graph
 	size_t size() const;
 
 	/// true if this graph contains no connections
 	bool empty() const;
 
-	/// allows iteration over connections
-	typedef boost::transform_iterator<
-	    std::function<const std::pair<const Port&, const Port&>(const connections_container::left_value_type&)>,
-	    connections_container::left_const_iterator>
-	    const_iterator;
+	/// allows iteration over connections (ordered by the output port's node and index)
+	typedef Iterator<const Port> const_iterator;
 
 	/// connections iteration
 	const_iterator begin() const;
 	/// connections iteration
 	const_iterator end() const;
 
-	/// allows iteration over connections
-	typedef boost::transform_iterator<
-	    std::function<const std::pair<Port&, Port&>(const connections_container::left_value_type&)>,
-	    connections_container::left_const_iterator>
-	    iterator;
+	/// allows iteration over connections (ordered by the output port's node and index)
+	typedef Iterator<Port> iterator;
 
 	/// connections iteration
 	iterator begin();
@@ -94,22 +91,40 @@ class Connections : public boost::noncopyable {
   private:
 	Connections(Network* parent);
 
-	Connections::PortId getId(const Port& p) const;
-	const Port& getPort(const Connections::PortId& id) const;
-	Port& getPort(const Connections::PortId& id);
-
-	const std::pair<const Port&, const Port&> convert(
-	    const Connections::connections_container::left_value_type& val) const;
-	const std::pair<Port&, Port&> convertConst(const Connections::connections_container::left_value_type& val);
-
 	void add(Port& src, Port& dest);
 	void remove(Port& src, Port& dest);
 
 	Network* m_parent;
-	connections_container m_connections;
+	std::size_t m_size;
 
 	friend class Network;
 	friend class Port;
 };
 
+/// Forward iterator over all connections of a network - walks the output ports of all nodes
+/// and their adjacency lists.
+template <typename PORT>
+class Connections::Iterator
+    : public boost::iterator_facade<Iterator<PORT>, const std::pair<PORT&, PORT&>, boost::forward_traversal_tag,
+                                    const std::pair<PORT&, PORT&>> {
+  public:
+	Iterator();
+
+  private:
+	Iterator(Nodes::NodeArray::const_iterator node, Nodes::NodeArray::const_iterator end);
+
+	void increment();
+	bool equal(const Iterator& it) const;
+	const std::pair<PORT&, PORT&> dereference() const;
+
+	/// moves the iterator to the next valid connection, if the current position is not valid
+	void settle();
+
+	Nodes::NodeArray::const_iterator m_node, m_end;
+	std::size_t m_port, m_connection;
+
+	friend class boost::iterator_core_access;
+	friend class Connections;
+};
+
 }  // namespace dependency_graph
@@ -1,13 +1,49 @@
 #include "data.inl"
 
+#include <mutex>
+
 namespace dependency_graph {
 
-Data::Data() {
+namespace {
+
+/// returns a unique integer ID of a type. Types are identified by their mangled names, which
+///   (unlike type_info addresses) are consistent across all loaded binaries.
+unsigned typeId(const std::type_info& type) {
+	static std::mutex s_mutex;
+	static std::map<std::string, unsigned> s_ids;
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	return s_ids.insert(std::make_pair(std::string(type.name()), s_ids.size() + 1)).first->second;
+}
+
+}  // namespace
+
+Data::TypeBase::TypeBase(const std::type_info& ti) : typeinfo(ti), id(typeId(ti)) {
+}
+
+Data::TypeBase::~TypeBase() {
+}
+
+Data::Data() : m_type(nullptr) {
 }
 
-Data::Data(const Data& d) {
-	m_data = d.m_data;
-	assert(std::string(d.typeinfo().name()) == std::string(typeinfo().name()));
+Data::Data(const Data& d) : m_type(d.m_type), m_heap(d.m_heap), m_inline(d.m_inline) {
+}
+
+Data::Data(Data&& d) noexcept : m_type(d.m_type), m_heap(std::move(d.m_heap)), m_inline(d.m_inline) {
+	d.m_type = nullptr;
+}
+
+Data& Data::operator=(Data&& d) noexcept {
+	assert(empty() || d.empty() || m_type->id == d.m_type->id);
+
+	m_type = d.m_type;
+	m_heap = std::move(d.m_heap);
+	m_inline = d.m_inline;
+
+	d.m_type = nullptr;
+
+	return *this;
 }
 
 Data& Data::operator=(const Data& d) {
@@ -15,25 +51,41 @@ Data& Data::operator=(const Data& d) {
 	// 1. assign values between the same types
 	// 2. assign a value to a null (void) data - connecting void ports
 	// 3. assign a null (void) to a value - disconnecting void ports
-	assert(std::string(d.typeinfo().name()) == std::string(typeinfo().name()) || empty() || d.empty());
-	m_data = d.m_data;
+	assert(empty() || d.empty() || m_type->id == d.m_type->id);
+
+	m_type = d.m_type;
+	m_heap = d.m_heap;
+	m_inline = d.m_inline;
+
 	return *this;
 }
 
 bool Data::operator==(const Data& d) const {
-	assert(m_data != nullptr && d.m_data != nullptr);
-	return m_data->isEqual(*d.m_data);
+	assert(m_type != nullptr && d.m_type != nullptr);
+
+	// a shared holder is trivially equal, without comparing the values
+	if(m_heap && m_heap == d.m_heap)
+		return true;
+
+	return m_type->id == d.m_type->id && m_type->isEqual(ptr(), d.ptr());
 }
 
 bool Data::operator!=(const Data& d) const {
-	assert(m_data != nullptr && d.m_data != nullptr);
-	return !m_data->isEqual(*d.m_data);
+	return !operator==(d);
 }
 
 const std::type_info& Data::typeinfo() const {
-	if(m_data == nullptr)
+	if(m_type == nullptr)
 		return typeid(void);
-	return m_data->typeinfo();
+	return m_type->typeinfo;
+}
+
+const void* Data::ptr() const {
+	assert(m_type != nullptr);
+
+	if(m_heap)
+		return m_heap.get();
+	return &m_inline;
 }
 
 Data Data::create(const std::string& type) {
@@ -45,13 +97,19 @@ std::string Data::type() const {
 }
 
 std::string Data::toString() const {
-	if(m_data == nullptr)
+	if(m_type == nullptr)
 		return "(null)";
-	return m_data->toString();
+	return m_type->toString(ptr());
+}
+
+std::size_t Data::size() const {
+	if(m_type == nullptr)
+		return 0;
+	return m_type->size(ptr());
 }
 
 bool Data::empty() const {
-	return m_data == nullptr;
+	return m_type == nullptr;
 }
 
 std::ostream& operator<<(std::ostream& out, const Data& bd) {
@@ -7,12 +7,17 @@
 #include <memory>
 #include <sstream>
 #include <type_traits>
+#include <typeinfo>
 
 #include "data_traits.h"
 #include "factory_handle.h"
 
 namespace dependency_graph {
 
+/// A type-erased value holder. Values held by Data are immutable - copying a Data instance never
+/// deep-copies the held value. Copies share a single reference-counted heap holder, or copy a small
+/// bitwise-copyable inline value. Passing values between ports (e.g., from an output to all its
+/// connected inputs) is therefore zero-copy, and rvalues are moved directly into their holder.
 class Data {
   public:
 	/// creates a new Data instance based on type name. Internally implements a factory mechanism to produce instances
@@ -22,19 +27,27 @@ class Data {
 	// creates empty data holder(null data with void type)
 	Data();
 
-	// creates a data instance of a particular type initialised to a value
-	template <typename T>
-	explicit Data(T value);
+	// creates a data instance of a particular type initialised to a value (moved into the holder if an rvalue)
+	template <typename T,
+	          typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, Data>::value>::type>
+	explicit Data(T&& value);
 
 	Data(const Data& d);
 	Data& operator=(const Data& d);
 
+	/// moves the value holder - the moved-from instance becomes empty (void)
+	Data(Data&& d) noexcept;
+	Data& operator=(Data&& d) noexcept;
+
 	/// returns true if this instance doesn't contain any data (i.e., doesn't have a type)
 	bool empty() const;
 
 	std::string type() const;
 	const std::type_info& typeinfo() const;
 
+	/// returns the approximate memory footprint of the held value in bytes (see DataSize)
+	std::size_t size() const;
+
 	template <typename T>
 	const T& get() const;
 
@@ -58,29 +71,54 @@ class Data {
 		FactoryHandle m_factoryHandle;
 	};
 
-	struct Holder {
-		virtual ~Holder(){};
+	/// Type-dependent operations on stored values. Each stored type has a single instance per
+	/// binary, identified by an integer ID unique across all binaries (plugins included).
+	struct TypeBase : public boost::noncopyable {
+		TypeBase(const std::type_info& typeinfo);
+		virtual ~TypeBase();
+
+		virtual bool isEqual(const void* v1, const void* v2) const = 0;
+		virtual std::string toString(const void* v) const = 0;
+		virtual std::size_t size(const void* v) const = 0;
 
-		virtual const std::type_info& typeinfo() const = 0;
-		virtual bool isEqual(const Holder& src) const = 0;
-		virtual std::string toString() const = 0;
+		const std::type_info& typeinfo;
+		const unsigned id;
 	};
 
 	template <typename T>
-	class TypedHolder : public Holder {
-	  public:
-		TypedHolder(T&& d);
-		virtual ~TypedHolder();
+	struct Type : public TypeBase {
+		Type();
 
-		virtual const std::type_info& typeinfo() const override;
-		virtual bool isEqual(const Holder& src) const override;
-		virtual std::string toString() const override;
+		virtual bool isEqual(const void* v1, const void* v2) const override;
+		virtual std::string toString(const void* v) const override;
+		virtual std::size_t size(const void* v) const override;
+
+		static const Type<T>& instance();
 
-		T data;
 		static Factory<T> m_factory;
 	};
 
-	std::shared_ptr<const Holder> m_data;
+	/// inline storage for small values, avoiding the heap allocation and atomic reference counting
+	typedef std::aligned_storage<16, alignof(double)>::type Storage;
+
+	/// true for types stored inline (small and bitwise-copyable)
+	template <typename T>
+	struct IsInline
+	    : public std::integral_constant<bool, IsBitwiseCopyable<T>::value && std::is_trivially_destructible<T>::value &&
+	                                              sizeof(T) <= sizeof(Storage) && alignof(T) <= alignof(Storage)> {};
+
+	/// stores a value of type U, either inline or in a new heap holder
+	template <typename U, typename T>
+	void assign(T&& value, std::true_type isInline);
+	template <typename U, typename T>
+	void assign(T&& value, std::false_type isInline);
+
+	/// returns a pointer to the stored value (inline or on the heap)
+	const void* ptr() const;
+
+	const TypeBase* m_type;
+	std::shared_ptr<const void> m_heap;
+	Storage m_inline;
 
 	friend std::ostream& operator<<(std::ostream& out, const Data& bd);
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <new>
 #include <sstream>
 
 #include "data.h"
@@ -10,44 +11,56 @@
 namespace dependency_graph {
 
 template <typename T>
-Data::Factory<T> Data::TypedHolder<T>::m_factory;
+Data::Factory<T> Data::Type<T>::m_factory;
 
-template <typename T>
-Data::Data(T value)
-    : m_data(new Data::TypedHolder<typename std::remove_const<typename std::remove_reference<T>::type>::type>(
-          std::move(value))) {
+template <typename T, typename ENABLE>
+Data::Data(T&& value) : m_type(nullptr) {
+	typedef typename std::decay<T>::type U;
+
+	assign<U>(std::forward<T>(value), IsInline<U>());
 }
 
 template <typename T>
 const T& Data::get() const {
-	if(std::string(typeinfo().name()) == typeid(void).name() || m_data == nullptr)
+	typedef typename std::remove_reference<typename std::remove_const<T>::type>::type U;
+
+	if(m_type == nullptr)
 		throw std::runtime_error("Attempting to use a void value!");
 
-	const TypedHolder<typename std::remove_reference<typename std::remove_const<T>::type>::type>* tmp =
-	    dynamic_cast<const TypedHolder<typename std::remove_reference<typename std::remove_const<T>::type>::type>*>(
-	        m_data.get());
-	if(!tmp)
+	if(m_type->id != Type<U>::instance().id)
 		throw std::runtime_error(std::string("Invalid type requested - requested ") + typeid(T).name() + ", found " +
-		                         m_data->typeinfo().name());
+		                         m_type->typeinfo.name());
 
-	return tmp->data;
+	return *static_cast<const U*>(ptr());
 }
 
 template <typename T>
 void Data::set(const T& val) {
-	assert(std::string(typeid(T).name()) == std::string(typeinfo().name()));
+	typedef typename std::remove_reference<typename std::remove_const<T>::type>::type U;
+	assert(m_type != nullptr && m_type->id == Type<U>::instance().id);
 
-	T tmp = val;
-	m_data = std::shared_ptr<const Holder>(
-	    new TypedHolder<typename std::remove_reference<typename std::remove_const<T>::type>::type>(std::move(tmp)));
+	assign<U>(val, IsInline<U>());
 }
 
 template <typename T>
 void Data::set(T&& val) {
-	assert(std::string(typeid(T).name()) == std::string(typeinfo().name()));
+	typedef typename std::decay<T>::type U;
+	assert(m_type != nullptr && m_type->id == Type<U>::instance().id);
+
+	assign<U>(std::forward<T>(val), IsInline<U>());
+}
+
+template <typename U, typename T>
+void Data::assign(T&& value, std::true_type) {
+	m_type = &Type<U>::instance();
+	m_heap.reset();
+	new(&m_inline) U(std::forward<T>(value));
+}
 
-	m_data = std::shared_ptr<const Holder>(
-	    new TypedHolder<typename std::remove_reference<typename std::remove_const<T>::type>::type>(std::move(val)));
+template <typename U, typename T>
+void Data::assign(T&& value, std::false_type) {
+	m_type = &Type<U>::instance();
+	m_heap = std::make_shared<const U>(std::forward<T>(value));
 }
 
 namespace {
@@ -77,32 +90,34 @@ Data::Factory<T>::~Factory() {
 ////////////
 
 template <typename T>
-Data::TypedHolder<T>::TypedHolder(T&& d) : data(std::move(d)) {
-}
-
-template <typename T>
-Data::TypedHolder<T>::~TypedHolder() {
+Data::Type<T>::Type() : TypeBase(typeid(T)) {
 	// just do something with the factory, to make sure it is instantiated
 	std::stringstream ss;
 	ss << &m_factory;
 }
 
 template <typename T>
-const std::type_info& Data::TypedHolder<T>::typeinfo() const {
-	return typeid(T);
+const Data::Type<T>& Data::Type<T>::instance() {
+	// intentionally never destroyed, as static Data instances can outlive it
+	static const Type<T>* s_instance = new Type<T>();
+	return *s_instance;
 }
 
 template <typename T>
-bool Data::TypedHolder<T>::isEqual(const Holder& src) const {
-	const TypedHolder<T>* h2 = dynamic_cast<const TypedHolder<T>*>(&src);
-	return h2 != nullptr && DataTraits<T>::isEqual(data, h2->data);
+bool Data::Type<T>::isEqual(const void* v1, const void* v2) const {
+	return DataTraits<T>::isEqual(*static_cast<const T*>(v1), *static_cast<const T*>(v2));
 }
 
 template <typename T>
-std::string Data::TypedHolder<T>::toString() const {
+std::string Data::Type<T>::toString(const void* v) const {
 	std::stringstream ss;
-	ss << data;
+	ss << *static_cast<const T*>(v);
 	return ss.str();
 }
 
+template <typename T>
+std::size_t Data::Type<T>::size(const void* v) const {
+	return DataSize<T>::size(*static_cast<const T*>(v));
+}
+
 }  // namespace dependency_graph
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <string>
 #include <type_traits>
+#include <vector>
 
 namespace dependency_graph {
 
@@ -29,4 +31,37 @@ struct DataTraits<T, typename std::enable_if<
 	}
 };
 
+/// Values of small types that can be copied bytewise are stored directly inside Data instances,
+/// without a heap allocation. Can be specialised for types with a user-provided copy constructor
+/// that is equivalent to a bytewise copy - the specialisation has to be declared together with
+/// the type itself, to be visible in all translation units using it.
+template <typename T>
+struct IsBitwiseCopyable : public std::is_trivially_copyable<T> {};
+
+/// Approximate memory footprint of a value in bytes, including its dynamically allocated data.
+/// Should be specialised for types holding large amounts of dynamically allocated data.
+template <typename T, typename ENABLE = void>
+struct DataSize {
+	static std::size_t size(const T& value) {
+		return sizeof(T);
+	}
+};
+
+template <typename T>
+struct DataSize<std::vector<T>> {
+	static std::size_t size(const std::vector<T>& value) {
+		std::size_t result = sizeof(std::vector<T>) + (value.capacity() - value.size()) * sizeof(T);
+		for(auto& v : value)
+			result += DataSize<T>::size(v);
+		return result;
+	}
+};
+
+template <>
+struct DataSize<std::string> {
+	static std::size_t size(const std::string& value) {
+		return sizeof(std::string) + value.capacity();
+	}
+};
+
 }  // namespace dependency_graph
@@ -1,5 +1,7 @@
 #include "datablock.h"
 
+#include <atomic>
+
 #include "attr.h"
 #include "data.inl"
 #include "metadata.h"
@@ -9,9 +11,16 @@
 
 namespace dependency_graph {
 
+std::size_t Datablock::nextVersion() {
+	static std::atomic<std::size_t> s_version(0);
+	return ++s_version;
+}
+
 Datablock::Datablock(const MetadataHandle& meta) : m_meta(meta) {
-	for(std::size_t a = 0; a < meta.metadata().attributeCount(); ++a)
+	for(std::size_t a = 0; a < meta.metadata().attributeCount(); ++a) {
 		m_data.push_back(meta.metadata().attr(a).createData());
+		m_versions.push_back(nextVersion());
+	}
 }
 
 const Data& Datablock::data(size_t index) const {
@@ -24,6 +33,10 @@ const Data& Datablock::data(size_t index) const {
 }
 
 void Datablock::setData(size_t index, const Data& data) {
+	setData(index, data, nextVersion());
+}
+
+void Datablock::setData(size_t index, const Data& data, std::size_t version) {
 	assert(m_data.size() > index);
 
 	if(m_data[index].typeinfo() == typeid(void))
@@ -33,6 +46,12 @@ void Datablock::setData(size_t index, const Data& data) {
 		throw std::runtime_error("Port value type does not match");
 
 	m_data[index] = data;
+	m_versions[index] = version;
+}
+
+std::size_t Datablock::version(size_t index) const {
+	assert(m_versions.size() > index);
+	return m_versions[index];
 }
 
 bool Datablock::isNull(std::size_t index) const {
@@ -51,11 +70,13 @@ void Datablock::set(size_t index, const Port& port) {
 	// and assign the value
 	assert(m_data[index].type() == dependency_graph::unmangledTypeId(port.type()));
 	m_data[index] = port.node().datablock().m_data[port.index()];
+	m_versions[index] = port.node().datablock().m_versions[port.index()];
 }
 
 void Datablock::reset(size_t index) {
 	assert(m_data.size() > index);
 	m_data[index] = m_meta.metadata().attr(index).createData();
+	m_versions[index] = nextVersion();
 }
 
 const MetadataHandle& Datablock::meta() const {
@@ -31,10 +31,20 @@ class Datablock {
 	void setData(size_t index, const Data& data);
 	bool isNull(std::size_t index) const;
 
+	/// returns the version of a value - each change of a value assigns it a new unique version
+	/// number, and copies of a value keep the version of their source. Equal versions
+	/// therefore guarantee equal values (but not vice versa).
+	std::size_t version(size_t index) const;
+	/// sets a value with an explicit version (i.e., a copy of a value from another datablock)
+	void setData(size_t index, const Data& data, std::size_t version);
+
 	const MetadataHandle& meta() const;
 
   private:
+	static std::size_t nextVersion();
+
 	std::vector<Data> m_data;
+	std::vector<std::size_t> m_versions;
 	MetadataHandle m_meta;
 };
 
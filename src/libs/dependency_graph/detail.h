@@ -6,7 +6,7 @@
 namespace dependency_graph {
 namespace detail {
 
-/// A simple accessor, allowing to add an untemplated attribute
+/// A simple accessor, allowing to add an untemplated attribute (or influence)
 /// to a metadata instance. Only to be used in Actions implementation.
 struct MetadataAccess {
 	static void addAttribute(Metadata& meta, Attr& attr) {
@@ -17,6 +17,10 @@ struct MetadataAccess {
 	                         unsigned flags) {
 		meta.doAddAttribute(name, cat, data, flags);
 	}
+
+	static void addInfluence(Metadata& meta, std::size_t in, std::size_t out) {
+		meta.m_influences.left.insert(std::make_pair(in, out));
+	}
 };
 
 }  // namespace detail
@@ -0,0 +1,179 @@
+#include "evaluation_plan.h"
+
+#include <cassert>
+#include <unordered_map>
+
+#include "async_evaluation.h"
+#include "graph.h"
+#include "node_base.inl"
+
+namespace dependency_graph {
+
+namespace {
+
+thread_local bool s_evaluating = false;
+
+}
+
+class EvaluationPlan::Compiler : public boost::noncopyable {
+  public:
+	Compiler(std::vector<Step>& steps, std::vector<std::size_t>& dependencies)
+	    : m_steps(steps), m_dependencies(dependencies) {
+	}
+
+	/// adds the steps evaluating a port and its whole upstream, returning the index of the port's step
+	std::size_t visit(Port& p) {
+		auto it = m_visited.find(&p);
+		if(it != m_visited.end())
+			return it->second;
+
+		Step step{Step::kClean, &p, nullptr, 0, 0};
+		std::vector<std::size_t> deps;
+
+		if(p.category() == Attr::kInput) {
+			boost::optional<Port&> out;
+			if(p.node().hasParentNetwork())
+				out = p.node().network().connections().connectedFrom(p);
+
+			if(out) {
+				step.kind = Step::kCopy;
+				step.source = &(*out);
+			}
+			else if(p.m_linkedFromPort) {
+				step.kind = Step::kLink;
+				step.source = p.m_linkedFromPort;
+			}
+
+			if(step.source)
+				deps.push_back(visit(*step.source));
+		}
+		else {
+			if(p.m_linkedFromPort) {
+				step.kind = Step::kLink;
+				step.source = p.m_linkedFromPort;
+
+				deps.push_back(visit(*step.source));
+			}
+			else {
+				step.kind = Step::kCompute;
+
+				for(std::size_t i : p.node().metadata()->influencedBy(p.index()))
+					deps.push_back(visit(p.node().port(i)));
+			}
+		}
+
+		// post-order - all dependencies are already in the step list
+		step.dependenciesBegin = m_dependencies.size();
+		m_dependencies.insert(m_dependencies.end(), deps.begin(), deps.end());
+		step.dependenciesEnd = m_dependencies.size();
+
+		m_steps.push_back(step);
+		m_visited.insert(std::make_pair(&p, m_steps.size() - 1));
+
+		return m_steps.size() - 1;
+	}
+
+  private:
+	std::vector<Step>& m_steps;
+	std::vector<std::size_t>& m_dependencies;
+
+	std::unordered_map<const Port*, std::size_t> m_visited;
+};
+
+EvaluationPlan::EvaluationPlan(Port& output) : m_output(&output) {
+	assert(output.category() == Attr::kOutput && "evaluation plans can be only compiled for output ports");
+	assert(output.m_linkedFromPort == nullptr && "linked outputs don't compute");
+
+	Compiler compiler(m_steps, m_dependencies);
+	for(std::size_t i : output.node().metadata()->influencedBy(output.index()))
+		m_roots.push_back(compiler.visit(output.node().port(i)));
+}
+
+const Port& EvaluationPlan::output() const {
+	return *m_output;
+}
+
+std::size_t EvaluationPlan::size() const {
+	return m_steps.size();
+}
+
+const EvaluationPlan::Step& EvaluationPlan::operator[](std::size_t index) const {
+	assert(index < m_steps.size());
+	return m_steps[index];
+}
+
+std::vector<std::size_t>::const_iterator EvaluationPlan::dependenciesBegin(std::size_t index) const {
+	return m_dependencies.begin() + (*this)[index].dependenciesBegin;
+}
+
+std::vector<std::size_t>::const_iterator EvaluationPlan::dependenciesEnd(std::size_t index) const {
+	return m_dependencies.begin() + (*this)[index].dependenciesEnd;
+}
+
+std::vector<bool> EvaluationPlan::requiredSteps() const {
+	std::vector<bool> result(m_steps.size(), false);
+
+	for(std::size_t r : m_roots)
+		result[r] = m_steps[r].port->isDirty();
+
+	// steps are topologically sorted - a reverse sweep visits all dependants of a step first
+	for(std::size_t i = m_steps.size(); i-- > 0;)
+		if(result[i])
+			for(auto d = dependenciesBegin(i); d != dependenciesEnd(i); ++d)
+				if(m_steps[*d].port->isDirty())
+					result[*d] = true;
+
+	return result;
+}
+
+void EvaluationPlan::run() const {
+	ScopedEvaluation guard;
+
+	const std::vector<bool> required = requiredSteps();
+
+	for(std::size_t i = 0; i < m_steps.size(); ++i)
+		if(required[i] && m_steps[i].port->isDirty()) {
+			AsyncEvaluation::checkCancelled();
+
+			evaluate(i);
+		}
+}
+
+void EvaluationPlan::evaluate(std::size_t index) const {
+	const Step& step = (*this)[index];
+
+	// the compute of another output of the same node might have evaluated this port already
+	if(!step.port->isDirty())
+		return;
+
+	switch(step.kind) {
+		case Step::kCompute:
+			step.port->node().computeOutput(step.port->index());
+			break;
+		case Step::kCopy:
+			step.port->node().computeInput(step.port->index(), *step.source);
+			break;
+		case Step::kLink:
+			step.port->setLinkedData();
+			break;
+		case Step::kClean:
+			step.port->setDirty(false);
+			break;
+	}
+
+	assert(!step.port->isDirty());
+}
+
+bool EvaluationPlan::isEvaluating() {
+	return s_evaluating;
+}
+
+EvaluationPlan::ScopedEvaluation::ScopedEvaluation() : m_previous(s_evaluating) {
+	s_evaluating = true;
+}
+
+EvaluationPlan::ScopedEvaluation::~ScopedEvaluation() {
+	s_evaluating = m_previous;
+}
+
+}  // namespace dependency_graph
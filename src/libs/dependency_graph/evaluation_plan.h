@@ -0,0 +1,85 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace dependency_graph {
+
+class Port;
+
+/// A flat, topologically sorted list of all evaluation steps required to compute an output port.
+/// Each step describes the evaluation of one upstream port (a compute, a copy of a connected
+/// value, or a transfer of a linked value), with direct pointers to source ports resolved
+/// during compilation. Evaluating an output then becomes a linear sweep over the steps,
+/// skipping the steps with clean ports, without any connection or node lookups.
+///
+/// A plan is only valid while the topology of the graph doesn't change - plans are cached and
+/// invalidated by the Graph instance on each connection, link or metadata change.
+class EvaluationPlan : public boost::noncopyable {
+  public:
+	struct Step {
+		enum Kind {
+			kCompute,  //< runs compute() of an output
+			kCopy,     //< copies the value of a connected output to an input
+			kLink,     //< transfers the value of a linked port
+			kClean     //< unconnected input port - just resets its dirty flag
+		};
+
+		Kind kind;
+		Port* port;
+		Port* source;  //< the source port for kCopy and kLink steps
+
+		/// range of indices of steps this step directly depends on (see dependencies())
+		std::size_t dependenciesBegin, dependenciesEnd;
+	};
+
+	/// compiles a plan for evaluating the upstream of an output port (not including the
+	/// compute of the port itself)
+	EvaluationPlan(Port& output);
+
+	const Port& output() const;
+
+	std::size_t size() const;
+	const Step& operator[](std::size_t index) const;
+
+	/// returns the indices of steps that a step directly depends on
+	std::vector<std::size_t>::const_iterator dependenciesBegin(std::size_t index) const;
+	std::vector<std::size_t>::const_iterator dependenciesEnd(std::size_t index) const;
+
+	/// returns a mask of the steps required to evaluate the output - dirty steps connected to the output
+	/// by a path of dirty steps. As dirtiness propagates downstream, this is the same as the dirty flags
+	/// of all steps, unless some of the values were evicted by a MemoryGovernor.
+	std::vector<bool> requiredSteps() const;
+
+	/// evaluates all required steps of this plan, in order
+	void run() const;
+
+	/// evaluates a single step, assuming all its dependencies are already evaluated
+	void evaluate(std::size_t index) const;
+
+	/// returns true if the current thread is evaluating steps of a plan (used to avoid
+	/// nested plan evaluation)
+	static bool isEvaluating();
+
+	/// RAII guard, marking the current thread as evaluating steps of a plan
+	class ScopedEvaluation : public boost::noncopyable {
+	  public:
+		ScopedEvaluation();
+		~ScopedEvaluation();
+
+	  private:
+		bool m_previous;
+	};
+
+  private:
+	class Compiler;
+
+	Port* m_output;
+
+	std::vector<Step> m_steps;
+	std::vector<std::size_t> m_dependencies;
+	// steps the output directly depends on
+	std::vector<std::size_t> m_roots;
+};
+
+}  // namespace dependency_graph
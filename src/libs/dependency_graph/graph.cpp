@@ -1,7 +1,13 @@
 #include "graph.h"
 
 #include <algorithm>
+#include <cassert>
 
+#include "async_evaluation.h"
+#include "compute_cache.h"
+#include "evaluation_plan.h"
+#include "memory_governor.h"
+#include "profiler.h"
 #include "nodes.inl"
 
 namespace dependency_graph {
@@ -11,13 +17,30 @@ struct Graph::Signals {
 	boost::signals2::signal<void(NodeBase&)> m_onNameChanged, m_onBlindDataChanged, m_onMetadataChanged;
 	boost::signals2::signal<void(Port&, Port&)> m_onConnect, m_onDisconnect;
 	boost::signals2::signal<void()> m_onDirty;
+	boost::signals2::signal<void(const std::vector<Port*>&)> m_onDirtyBatch;
 	boost::signals2::signal<void(const NodeBase&)> m_onStateChanged;
 };
 
-Graph::Graph() : Network("network", UniqueId(), Network::defaultMetadata(), nullptr), m_signals(new Signals) {
+Graph::Graph()
+    : Network("network", UniqueId(), Network::defaultMetadata(), nullptr),
+      m_signals(new Signals),
+      m_parallelEvaluation(false),
+      m_earlyCutoff(false),
+      m_partialRequests(0),
+      m_dirtyBatchDepth(0),
+      m_dirtyBatchChanged(false),
+      m_bulkBuildDepth(0),
+      m_deferredDirtyFlushes(0),
+      m_timeDependencyValid(false) {
 }
 
 Graph::~Graph() {
+	assert(m_dirtyBatchDepth == 0 && "all dirty batches should be finished before the graph is destroyed");
+	assert(m_bulkBuildDepth == 0 && "all bulk builds should be finished before the graph is destroyed");
+
+	// cancels all pending asynchronous evaluations, and waits for the running one
+	m_evaluationQueue.reset();
+
 	clear();
 }
 
@@ -49,6 +72,10 @@ boost::signals2::connection Graph::onDirty(std::function<void()> callback) {
 	return m_signals->m_onDirty.connect(callback);
 }
 
+boost::signals2::connection Graph::onDirtyBatch(std::function<void(const std::vector<Port*>&)> callback) {
+	return m_signals->m_onDirtyBatch.connect(callback);
+}
+
 boost::signals2::connection Graph::onStateChanged(std::function<void(const NodeBase&)> callback) {
 	return m_signals->m_onStateChanged.connect(callback);
 }
@@ -57,40 +84,404 @@ boost::signals2::connection Graph::onMetadataChanged(std::function<void(NodeBase
 	return m_signals->m_onMetadataChanged.connect(callback);
 }
 
+void Graph::setParallelEvaluation(bool enabled) {
+	m_parallelEvaluation = enabled;
+}
+
+bool Graph::parallelEvaluation() const {
+	return m_parallelEvaluation;
+}
+
+void Graph::setEarlyCutoff(bool enabled) {
+	m_earlyCutoff = enabled;
+}
+
+bool Graph::earlyCutoff() const {
+	return m_earlyCutoff;
+}
+
+void Graph::setComputeCache(std::shared_ptr<ComputeCache> cache) {
+	m_computeCache = cache;
+}
+
+const std::shared_ptr<ComputeCache>& Graph::computeCache() const {
+	return m_computeCache;
+}
+
+void Graph::setProfiler(std::shared_ptr<Profiler> profiler) {
+	m_profiler = profiler;
+}
+
+const std::shared_ptr<Profiler>& Graph::profiler() const {
+	return m_profiler;
+}
+
+void Graph::setMemoryGovernor(std::shared_ptr<MemoryGovernor> governor) {
+	if(m_memoryGovernor)
+		m_memoryGovernor->reset();
+
+	m_memoryGovernor = governor;
+}
+
+const std::shared_ptr<MemoryGovernor>& Graph::memoryGovernor() const {
+	return m_memoryGovernor;
+}
+
+const NodeIndex& Graph::nodeIndex() const {
+	return m_nodeIndex;
+}
+
+std::shared_ptr<const EvaluationPlan> Graph::evaluationPlan(Port& output) {
+	std::unique_lock<std::mutex> lock(m_evaluationPlansMutex);
+
+	auto it = m_evaluationPlans.find(&output);
+	if(it == m_evaluationPlans.end())
+		it = m_evaluationPlans.insert(std::make_pair(&output, std::make_shared<const EvaluationPlan>(output))).first;
+
+	return it->second;
+}
+
+bool Graph::isTimeDependent(const Port& port) {
+	std::unique_lock<std::mutex> lock(m_evaluationPlansMutex);
+
+	if(!m_timeDependencyValid) {
+		m_timeDependentPorts.clear();
+
+		for(NodeBase* n : m_nodeIndex.timeSources())
+			for(std::size_t p = 0; p < n->portCount(); ++p)
+				if(n->port(p).category() == Attr::kOutput)
+					n->collectDependants(p, m_timeDependentPorts);
+
+		m_timeDependencyValid = true;
+	}
+
+	return m_timeDependentPorts.find(&port) != m_timeDependentPorts.end();
+}
+
+void Graph::invalidateTimeSources() {
+	DirtyBatch batch(*this);
+
+	for(NodeBase* n : m_nodeIndex.timeSources())
+		for(std::size_t p = 0; p < n->portCount(); ++p)
+			if(n->port(p).category() == Attr::kOutput)
+				n->markAsDirty(p);
+}
+
+std::shared_ptr<AsyncEvaluation> Graph::evaluateAsync(Port& p) {
+	std::unique_lock<std::mutex> lock(m_evaluationQueueMutex);
+
+	// the worker thread is only started on the first asynchronous evaluation
+	if(m_evaluationQueue == nullptr)
+		m_evaluationQueue = std::unique_ptr<EvaluationQueue>(new EvaluationQueue(*this));
+
+	return m_evaluationQueue->push(p);
+}
+
+bool Graph::isEvaluatingAsync() {
+	// modifications made by the evaluation itself (e.g., by a compute) are allowed
+	if(AsyncEvaluation::current() != nullptr)
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_evaluationQueueMutex);
+	return m_evaluationQueue != nullptr && m_evaluationQueue->isEvaluating();
+}
+
+void Graph::invalidateEvaluationPlans() {
+	std::unique_lock<std::mutex> lock(m_evaluationPlansMutex);
+
+	m_evaluationPlans.clear();
+	m_timeDependencyValid = false;
+}
+
+void Graph::invalidateTimeDependency() {
+	std::unique_lock<std::mutex> lock(m_evaluationPlansMutex);
+
+	m_timeDependencyValid = false;
+}
+
+Graph::DirtyBatch::DirtyBatch(Graph& graph) : m_graph(&graph) {
+	++m_graph->m_dirtyBatchDepth;
+}
+
+Graph::DirtyBatch::~DirtyBatch() {
+	assert(m_graph->m_dirtyBatchDepth > 0);
+
+	if(--m_graph->m_dirtyBatchDepth == 0)
+		m_graph->flushDirtyBatch();
+}
+
+bool Graph::batchDirtyChange(Port& port) {
+	if(m_dirtyBatchDepth == 0)
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_dirtyBatchMutex);
+
+	// each port is recorded only once, with its dirty flag before the first change
+	if(port.m_dirtyBatchPosition == std::size_t(-1)) {
+		port.m_dirtyBatchPosition = m_dirtyBatch.size();
+		m_dirtyBatch.push_back(std::make_pair(&port, !port.isDirty()));
+	}
+
+	return true;
+}
+
+void Graph::forgetDirtyChange(Port& port) {
+	std::unique_lock<std::mutex> lock(m_dirtyBatchMutex);
+
+	// the record is only cleared (and skipped when flushing), to keep the positions of other ports valid
+	assert(port.m_dirtyBatchPosition < m_dirtyBatch.size() && m_dirtyBatch[port.m_dirtyBatchPosition].first == &port);
+	m_dirtyBatch[port.m_dirtyBatchPosition].first = nullptr;
+
+	port.m_dirtyBatchPosition = -1;
+}
+
+void Graph::flushDirtyBatch() {
+	std::vector<std::pair<Port*, bool>> batch;
+	{
+		std::unique_lock<std::mutex> lock(m_dirtyBatchMutex);
+		batch.swap(m_dirtyBatch);
+	}
+
+	// only ports with a different dirty flag than at the start of the batch are reported
+	std::vector<Port*> ports;
+	for(auto& p : batch) {
+		if(p.first == nullptr)
+			continue;
+
+		p.first->m_dirtyBatchPosition = -1;
+
+		if(p.first->isDirty() != p.second)
+			ports.push_back(p.first);
+	}
+
+	for(Port* p : ports)
+		p->m_flagsCallbacks();
+
+	if(m_dirtyBatchChanged.exchange(false) || !ports.empty()) {
+		m_signals->m_onDirty();
+		m_signals->m_onDirtyBatch(ports);
+	}
+}
+
+std::atomic<unsigned> Graph::s_bulkBuilds(0);
+std::atomic<unsigned> Graph::s_deferredNetworks(0);
+
+Graph::BulkBuild::BulkBuild(Graph& graph) : m_graph(&graph), m_dirtyBatch(graph) {
+	if(m_graph->m_bulkBuildDepth++ == 0)
+		++s_bulkBuilds;
+}
+
+Graph::BulkBuild::~BulkBuild() {
+	assert(m_graph->m_bulkBuildDepth > 0);
+
+	if(--m_graph->m_bulkBuildDepth == 0) {
+		--s_bulkBuilds;
+
+		m_graph->flushBulkBuild();
+	}
+
+	// m_dirtyBatch is destroyed afterwards, firing the consolidated dirtiness callbacks
+}
+
+bool Graph::isBulkBuilding() const {
+	return m_bulkBuildDepth > 0;
+}
+
+bool Graph::hasDeferredNetworks() {
+	return s_deferredNetworks > 0;
+}
+
+bool Graph::deferDirtyPropagation(Port& port) {
+	if(m_bulkBuildDepth == 0 || m_deferredDirtyFlushes > 0)
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+
+	if(port.m_dirtyDeferredPosition == std::size_t(-1)) {
+		port.m_dirtyDeferredPosition = m_deferredDirty.size();
+		m_deferredDirty.push_back(&port);
+	}
+
+	return true;
+}
+
+void Graph::forgetDeferredDirty(Port& port) {
+	std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+
+	// the record is only cleared (and skipped when flushing), to keep the positions of other ports valid
+	assert(port.m_dirtyDeferredPosition < m_deferredDirty.size() &&
+	       m_deferredDirty[port.m_dirtyDeferredPosition] == &port);
+	m_deferredDirty[port.m_dirtyDeferredPosition] = nullptr;
+
+	port.m_dirtyDeferredPosition = -1;
+}
+
+void Graph::flushDeferredDirty() {
+	std::vector<Port*> ports;
+	{
+		std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+		ports.swap(m_deferredDirty);
+	}
+
+	if(ports.empty())
+		return;
+
+	++m_deferredDirtyFlushes;
+
+	// each port was marked dirty itself, or (if it is not dirty) had its value set - in both cases
+	//   all its dependants have to be marked dirty (propagation stops at already dirty ports, but
+	//   all ports marked dirty during the build are in the list)
+	ports.erase(std::remove(ports.begin(), ports.end(), nullptr), ports.end());
+	for(Port* p : ports)
+		p->m_dirtyDeferredPosition = -1;
+
+	for(Port* p : ports)
+		p->node().propagateDirty(p->index(), !p->isDirty());
+
+	--m_deferredDirtyFlushes;
+}
+
+void Graph::flushBulkBuild() {
+	flushDeferredDirty();
+
+	std::vector<UniqueId> nodes;
+	std::unordered_set<UniqueId> nodeIds;
+	std::vector<std::pair<Port*, Port*>> connections;
+	{
+		std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+
+		nodes.swap(m_bulkNodes);
+		nodeIds.swap(m_bulkNodeIds);
+		connections.swap(m_bulkConnections);
+	}
+
+	// nodes removed during the build are not reported (including the nodes of removed networks),
+	//   a node removed and added again is reported only once
+	for(const UniqueId& id : nodes)
+		if(nodeIds.erase(id) > 0) {
+			NodeBase* node = m_nodeIndex.find(id);
+			if(node != nullptr)
+				m_signals->m_onAddNode(*node);
+		}
+
+	// connections removed during the build are not in the list anymore
+	for(auto& c : connections) {
+		assert(c.second->m_connectedFrom == c.first);
+		m_signals->m_onConnect(*c.first, *c.second);
+	}
+}
+
+void Graph::deferredNetworkPulled(Network& network) {
+	std::unique_lock<std::mutex> lock(m_pulledNetworksMutex);
+
+	if(std::find(m_pulledNetworks.begin(), m_pulledNetworks.end(), network.index()) == m_pulledNetworks.end())
+		m_pulledNetworks.push_back(network.index());
+}
+
+void Graph::loadPulledNetworks() {
+	std::vector<UniqueId> networks;
+	{
+		std::unique_lock<std::mutex> lock(m_pulledNetworksMutex);
+		networks.swap(m_pulledNetworks);
+	}
+
+	// the networks are found by their ids - they could have been removed since the pull
+	for(const UniqueId& id : networks) {
+		NodeBase* node = m_nodeIndex.find(id);
+		if(node != nullptr && node->is<Network>())
+			node->as<Network>().load();
+	}
+}
+
+bool Graph::isBulkAdded(const NodeBase& node) {
+	if(m_bulkBuildDepth == 0)
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+	return m_bulkNodeIds.find(node.index()) != m_bulkNodeIds.end();
+}
+
 void Graph::connected(Port& p1, Port& p2) {
-	m_signals->m_onConnect(p1, p2);
+	assert(!isEvaluatingAsync() && "the graph can't be modified during an asynchronous evaluation");
+
+	if(m_bulkBuildDepth > 0) {
+		std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+		m_bulkConnections.push_back(std::make_pair(&p1, &p2));
+	}
+	else
+		m_signals->m_onConnect(p1, p2);
 }
 
 void Graph::disconnected(Port& p1, Port& p2) {
+	assert(!isEvaluatingAsync() && "the graph can't be modified during an asynchronous evaluation");
+
+	// removing a connection made during the current bulk build - it was never reported
+	if(m_bulkBuildDepth > 0) {
+		std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+
+		auto it = std::find(m_bulkConnections.begin(), m_bulkConnections.end(), std::make_pair(&p1, &p2));
+		if(it != m_bulkConnections.end()) {
+			m_bulkConnections.erase(it);
+			return;
+		}
+	}
+
 	m_signals->m_onDisconnect(p1, p2);
 }
 
 void Graph::nameChanged(NodeBase& node) {
-	m_signals->m_onNameChanged(node);
+	if(!isBulkAdded(node))
+		m_signals->m_onNameChanged(node);
 }
 
 void Graph::stateChanged(NodeBase& node) {
-	m_signals->m_onStateChanged(node);
+	if(!isBulkAdded(node))
+		m_signals->m_onStateChanged(node);
 }
 
 void Graph::metadataChanged(NodeBase& node) {
-	m_signals->m_onMetadataChanged(node);
+	if(!isBulkAdded(node))
+		m_signals->m_onMetadataChanged(node);
 }
 
 void Graph::dirtyChanged() {
-	m_signals->m_onDirty();
+	// deferred to the end of the current dirty batch
+	if(m_dirtyBatchDepth > 0)
+		m_dirtyBatchChanged = true;
+	else
+		m_signals->m_onDirty();
 }
 
 void Graph::nodeAdded(NodeBase& node) {
-	m_signals->m_onAddNode(node);
+	assert(!isEvaluatingAsync() && "the graph can't be modified during an asynchronous evaluation");
+
+	if(m_bulkBuildDepth > 0) {
+		std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+
+		m_bulkNodes.push_back(node.index());
+		m_bulkNodeIds.insert(node.index());
+	}
+	else
+		m_signals->m_onAddNode(node);
 }
 
 void Graph::nodeRemoved(NodeBase& node) {
+	assert(!isEvaluatingAsync() && "the graph can't be modified during an asynchronous evaluation");
+
+	// removing a node added during the current bulk build - it was never reported
+	if(m_bulkBuildDepth > 0) {
+		std::unique_lock<std::mutex> lock(m_bulkBuildMutex);
+
+		if(m_bulkNodeIds.erase(node.index()) > 0)
+			return;
+	}
+
 	m_signals->m_onRemoveNode(node);
 }
 
 void Graph::blindDataChanged(NodeBase& node) {
-	m_signals->m_onBlindDataChanged(node);
+	if(!isBulkAdded(node))
+		m_signals->m_onBlindDataChanged(node);
 }
 
 }  // namespace dependency_graph
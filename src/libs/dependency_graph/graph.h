@@ -1,17 +1,30 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <atomic>
 #include <boost/signals2.hpp>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "connections.h"
 #include "network.h"
 #include "node.h"
+#include "node_index.h"
 #include "nodes.h"
 
 namespace dependency_graph {
 
+class EvaluationPlan;
+class EvaluationQueue;
+class AsyncEvaluation;
+class ComputeCache;
+class Profiler;
+class MemoryGovernor;
+
 /// The graph data structure - holds node instances and connections.
 class Graph : public Network {
   public:
@@ -29,12 +42,143 @@ class Graph : public Network {
 
 	/// dirtiness callback - called when any dirty flag of any port changes (usable for viewport refresh)
 	boost::signals2::connection onDirty(std::function<void()> callback);
+	/// consolidated dirtiness callback - called once at the end of each outermost DirtyBatch, with
+	/// all ports whose dirty flag changed during the batch
+	boost::signals2::connection onDirtyBatch(std::function<void(const std::vector<Port*>&)> callback);
+
+	/// A scoped batch of dirty flag changes. While a batch exists, the flags callbacks of ports
+	/// and the onDirty() callback are deferred. When the outermost batch is destroyed, each port
+	/// whose dirty flag differs from its state at the start of the batch fires its flags callbacks
+	/// once, followed by a single onDirty() and onDirtyBatch() notification. Batches can be nested.
+	class DirtyBatch : public boost::noncopyable {
+	  public:
+		DirtyBatch(Graph& graph);
+		~DirtyBatch();
+
+	  private:
+		Graph* m_graph;
+	};
+
+	/// A scoped bulk build of the graph (e.g., loading a scene or pasting a large network). While
+	/// a bulk build exists, the onAddNode() and onConnect() callbacks are deferred, other callbacks
+	/// of nodes added during the build are suppressed, and dirtiness propagation is deferred
+	/// (only the changed ports themselves are marked dirty). When the outermost bulk build is
+	/// destroyed, the dirtiness is propagated once from all changed ports, the deferred callbacks
+	/// are fired for the nodes and connections that still exist, followed by a single
+	/// consolidated dirtiness notification (see DirtyBatch). Pulling on a value during a bulk
+	/// build propagates the deferred dirtiness first. Bulk builds can be nested.
+	class BulkBuild : public boost::noncopyable {
+	  public:
+		BulkBuild(Graph& graph);
+		~BulkBuild();
+
+	  private:
+		Graph* m_graph;
+		DirtyBatch m_dirtyBatch;
+	};
+
+	/// returns true while a bulk build of this graph is in progress
+	bool isBulkBuilding() const;
+
+	/// returns true if any network of any graph is waiting for a deferred load (see Network::setDeferredLoad())
+	static bool hasDeferredNetworks();
+
 	/// per-node state change callback
 	boost::signals2::connection onStateChanged(std::function<void(const NodeBase&)> callback);
 
 	boost::signals2::connection onMetadataChanged(std::function<void(NodeBase&)> callback);
 
+	/// enables parallel evaluation - when pulling on an output, its dirty upstream
+	/// is collected first, and independent computes are run as TBB tasks. Nodes
+	/// with the Metadata::kMainThreadOnly flag are always evaluated on the pulling thread.
+	/// Graph and port callbacks can be called from worker threads in this mode.
+	void setParallelEvaluation(bool enabled);
+	bool parallelEvaluation() const;
+
+	/// enables early cutoff - each output records the versions of its inputs after a compute,
+	/// and a dirty output is not recomputed if none of its inputs changed their value since.
+	/// As values that compare equal keep their version, an upstream change that doesn't
+	/// change a value stops the propagation of recomputation. Only valid for computes that
+	/// don't depend on anything else than their inputs.
+	void setEarlyCutoff(bool enabled);
+	bool earlyCutoff() const;
+
+	/// sets a persistent cache of compute results - an output whose compute result is found
+	/// in the cache is loaded instead of being computed (null to disable caching)
+	void setComputeCache(std::shared_ptr<ComputeCache> cache);
+	const std::shared_ptr<ComputeCache>& computeCache() const;
+
+	/// sets a profiler, recording the timings of all evaluations (null to disable profiling)
+	void setProfiler(std::shared_ptr<Profiler> profiler);
+	const std::shared_ptr<Profiler>& profiler() const;
+
+	/// sets a memory governor, limiting the memory held by intermediate output values by evicting
+	/// the least recently pulled ones (null to disable)
+	void setMemoryGovernor(std::shared_ptr<MemoryGovernor> governor);
+	const std::shared_ptr<MemoryGovernor>& memoryGovernor() const;
+
+	/// returns the graph-wide index of all nodes, including the nodes of nested networks
+	const NodeIndex& nodeIndex() const;
+
+	/// returns the evaluation plan of an output port - a topologically sorted list of all
+	/// its upstream evaluation steps. Plans are compiled on first request, and cached until
+	/// the next change of the graph's topology (connections, links, metadata or node removal).
+	std::shared_ptr<const EvaluationPlan> evaluationPlan(Port& output);
+
+	/// returns true if the value of a port depends on the application time, i.e., if it is an output of
+	/// a time source node (see Metadata::kTimeSource) or has one in its upstream. Computed by a single
+	/// sweep over the downstream of all time sources, and cached until the next change of the graph's
+	/// topology. Ports that are not time-dependent keep their values when the time changes.
+	bool isTimeDependent(const Port& port);
+
+	/// marks the outputs of all time source nodes dirty, to be re-evaluated on the next pull (called by
+	/// the application on each change of its time). Only the time-dependent part of the graph is
+	/// invalidated, and a time source evaluating to the same value keeps its version, allowing the
+	/// early cutoff of its downstream (see setEarlyCutoff()).
+	void invalidateTimeSources();
+
+	/// starts an asynchronous evaluation of a port on a background worker thread, returning its handle.
+	/// Evaluations are queued and run one at a time, in the order of their submission. Graph and port
+	/// callbacks are deferred to the calling thread (see AsyncEvaluation), and the graph must not be
+	/// modified while an evaluation is running (cancel it and wait for it to finish first; asserted on
+	/// adding or removing nodes, connecting ports and setting input values in debug builds). An upstream
+	/// with Metadata::kMainThreadOnly nodes is evaluated synchronously instead. Networks with a deferred
+	/// load are not loaded by the evaluation (see Port::loadDeferredNetworks()).
+	std::shared_ptr<AsyncEvaluation> evaluateAsync(Port& port);
+
   private:
+	/// returns true if an asynchronous evaluation of this graph is queued or running, and the calling
+	/// thread is not evaluating it (used to assert that the graph is not modified during the evaluation)
+	bool isEvaluatingAsync();
+
+	void invalidateEvaluationPlans();
+	/// drops the cached time dependency of all ports (called on topology changes, and when a time source is added)
+	void invalidateTimeDependency();
+
+	/// records a dirty flag change of a port in the current dirty batch (returns false if there is none)
+	bool batchDirtyChange(Port& port);
+	/// removes a port from the current dirty batch (used on port destruction)
+	void forgetDirtyChange(Port& port);
+	/// fires the deferred callbacks of the finished dirty batch
+	void flushDirtyBatch();
+
+	/// defers the dirtiness propagation from a port to the end of the current bulk build
+	/// (returns false if there is none)
+	bool deferDirtyPropagation(Port& port);
+	/// removes a port from the deferred dirtiness propagation (used on port destruction)
+	void forgetDeferredDirty(Port& port);
+	/// propagates the deferred dirtiness (at the end of a bulk build, or before a pull during one)
+	void flushDeferredDirty();
+	/// fires the deferred callbacks of the finished bulk build
+	void flushBulkBuild();
+
+	/// records a pull of a network waiting for a deferred load (the pull can't load it)
+	void deferredNetworkPulled(Network& network);
+	/// loads the networks recorded by deferredNetworkPulled() (called by Port::loadDeferredNetworks())
+	void loadPulledNetworks();
+	/// returns true if the callbacks of a node are suppressed by the current bulk build
+	bool isBulkAdded(const NodeBase& node);
+
 	void nameChanged(NodeBase& node);
 	void stateChanged(NodeBase& node);
 	void metadataChanged(NodeBase& node);
@@ -49,11 +193,56 @@ class Graph : public Network {
 	struct Signals;
 	std::unique_ptr<Signals> m_signals;
 
+	NodeIndex m_nodeIndex;
+
+	bool m_parallelEvaluation;
+	bool m_earlyCutoff;
+	std::shared_ptr<ComputeCache> m_computeCache;
+	std::shared_ptr<Profiler> m_profiler;
+	std::shared_ptr<MemoryGovernor> m_memoryGovernor;
+
+	// number of ports of this graph holding a value or a pending evaluation of a partial (not full) request
+	std::atomic<std::size_t> m_partialRequests;
+
+	std::atomic<unsigned> m_dirtyBatchDepth;
+	std::atomic<bool> m_dirtyBatchChanged;
+	std::mutex m_dirtyBatchMutex;
+	// ports changed in the current dirty batch, with their original dirty flags
+	std::vector<std::pair<Port*, bool>> m_dirtyBatch;
+
+	std::atomic<unsigned> m_bulkBuildDepth, m_deferredDirtyFlushes;
+	std::mutex m_bulkBuildMutex;
+	// ports with deferred dirtiness propagation
+	std::vector<Port*> m_deferredDirty;
+	// nodes (in the order of addition) and connections added during the current bulk build
+	std::vector<UniqueId> m_bulkNodes;
+	std::unordered_set<UniqueId> m_bulkNodeIds;
+	std::vector<std::pair<Port*, Port*>> m_bulkConnections;
+	// number of bulk builds in progress in all graphs - allows a cheap test on each pull
+	static std::atomic<unsigned> s_bulkBuilds;
+	// number of networks waiting for a deferred load in all graphs (see Network::setDeferredLoad())
+	static std::atomic<unsigned> s_deferredNetworks;
+	// networks pulled while waiting for a deferred load
+	std::mutex m_pulledNetworksMutex;
+	std::vector<UniqueId> m_pulledNetworks;
+
+	std::mutex m_evaluationQueueMutex;
+	std::unique_ptr<EvaluationQueue> m_evaluationQueue;
+
+	std::mutex m_evaluationPlansMutex;
+	std::unordered_map<const Port*, std::shared_ptr<const EvaluationPlan>> m_evaluationPlans;
+	// all time-dependent ports (guarded by the evaluation plans mutex, valid only if the flag is set)
+	std::unordered_set<const Port*> m_timeDependentPorts;
+	bool m_timeDependencyValid;
+
 	friend class NodeBase;
 	friend class Node;
 	friend class Nodes;
 	friend class Connections;
 	friend class Network;
+	friend class Port;
+	friend class MemoryGovernor;
+	friend class AsyncEvaluation;
 };
 
 }  // namespace dependency_graph
@@ -0,0 +1,184 @@
+#include "memory_governor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "graph.h"
+#include "node_base.inl"
+
+namespace dependency_graph {
+
+MemoryGovernor::MemoryGovernor(std::size_t budget) : m_budget(budget), m_usage(0), m_evictions(0) {
+}
+
+void MemoryGovernor::setBudget(std::size_t budget) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_budget = budget;
+}
+
+std::size_t MemoryGovernor::budget() const {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_budget;
+}
+
+std::size_t MemoryGovernor::usage() const {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_usage;
+}
+
+std::size_t MemoryGovernor::evictions() const {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_evictions;
+}
+
+void MemoryGovernor::setExternalUsage(const void* owner, std::size_t size) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	auto it = m_external.find(owner);
+	if(it != m_external.end()) {
+		m_usage -= it->second;
+		m_external.erase(it);
+	}
+
+	if(size > 0) {
+		m_external.insert(std::make_pair(owner, size));
+		m_usage += size;
+	}
+}
+
+void MemoryGovernor::record(Port& output) {
+	assert(output.category() == Attr::kOutput);
+
+	// the values of previous requests kept by the port are included (see Port::cacheRequest())
+	std::size_t size = output.node().datablock().data(output.index()).size();
+	for(auto& c : output.m_requestCache)
+		size += c.value.size();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	std::size_t& current = m_sizes[&output];
+	m_usage = m_usage - current + size;
+	current = size;
+
+	output.m_memoryTracked = true;
+}
+
+void MemoryGovernor::forget(Port& output) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	auto it = m_sizes.find(&output);
+	if(it != m_sizes.end()) {
+		m_usage -= it->second;
+		m_sizes.erase(it);
+	}
+
+	output.m_memoryTracked = false;
+}
+
+void MemoryGovernor::reset() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	for(auto& s : m_sizes)
+		s.first->m_memoryTracked = false;
+
+	m_sizes.clear();
+
+	// the external values are not held by the ports of the graph
+	m_usage = 0;
+	for(auto& e : m_external)
+		m_usage += e.second;
+}
+
+bool MemoryGovernor::isEvictable(const Port& output) {
+	if(output.isDirty() || output.isPinned() || output.m_connectedTo.empty())
+		return false;
+
+	// linked values are shared with another network - evicting them would invalidate it
+	if(output.m_linkedToPort != nullptr || output.m_linkedFromPort != nullptr)
+		return false;
+
+	for(const Port* in : output.m_connectedTo)
+		if(in->isPinned())
+			return false;
+
+	return true;
+}
+
+void MemoryGovernor::evictPort(Port& output) {
+	// connected inputs share the value holder of the output - they have to release it as well
+	for(Port* in : output.m_connectedTo)
+		if(!in->isDirty()) {
+			in->node().datablock().reset(in->index());
+			in->setDirty(true);
+			in->m_evicted = true;
+		}
+
+	output.node().datablock().reset(output.index());
+	output.setComputedFrom(std::vector<std::size_t>());
+	output.m_requestCache.clear();
+	output.setDirty(true);
+	output.m_evicted = true;
+
+	forget(output);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	++m_evictions;
+}
+
+void MemoryGovernor::evict(Port& keep) {
+	// values pulled concurrently might be still in use - the next pull will evict them
+	std::unique_lock<std::shared_timed_mutex> pulls(m_pullMutex, std::try_to_lock);
+	if(!pulls.owns_lock())
+		return;
+
+	std::vector<Port*> candidates;
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if(m_usage <= m_budget)
+			return;
+
+		for(auto& s : m_sizes)
+			if(s.first != &keep && isEvictable(*s.first))
+				candidates.push_back(s.first);
+	}
+
+	// values of time-dependent ports first (they are recomputed after the next time change anyway, unlike
+	//   the static parts of the graph), then the least recently pulled values
+	Graph& graph = keep.node().graph();
+
+	std::vector<std::pair<bool, Port*>> order;
+	for(Port* p : candidates)
+		order.push_back(std::make_pair(!graph.isTimeDependent(*p), p));
+
+	std::sort(order.begin(), order.end(), [](const std::pair<bool, Port*>& p1, const std::pair<bool, Port*>& p2) {
+		if(p1.first != p2.first)
+			return p2.first;
+		return p1.second->m_lastPulled < p2.second->m_lastPulled;
+	});
+
+	bool evicted = false;
+	for(auto& o : order) {
+		Port* p = o.second;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if(m_usage <= m_budget)
+				break;
+		}
+
+		evictPort(*p);
+		evicted = true;
+	}
+
+	if(evicted)
+		keep.node().graph().dirtyChanged();
+}
+
+std::size_t MemoryGovernor::tick() {
+	static std::atomic<std::size_t> s_counter(0);
+	return ++s_counter;
+}
+
+}  // namespace dependency_graph
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace dependency_graph {
+
+class Port;
+
+/// Limits the memory held by the values of intermediate outputs (see Graph::setMemoryGovernor()).
+///
+/// The approximate size of each computed output value is tracked using its DataSize traits. When
+/// the total size exceeds the budget, intermediate outputs (outputs with connections) are evicted -
+/// time-dependent ones first (see Graph::isTimeDependent()), as they are recomputed after each time
+/// change anyway, followed by the least recently pulled ones. Their values, and the values of
+/// connected inputs sharing them, are reset and marked dirty, to be recomputed on demand. Unlike a
+/// normal dirty flag change, an eviction doesn't invalidate the downstream of the evicted ports.
+///
+/// Eviction only happens at the end of an outermost pull, never during an evaluation, and never while
+/// any other thread is pulling on the graph (see Port::getData()). Pinned
+/// ports (see Port::setPinned()), outputs connected to pinned inputs and linked ports are
+/// never evicted.
+class MemoryGovernor : public boost::noncopyable {
+  public:
+	/// creates a governor with a budget in bytes
+	MemoryGovernor(std::size_t budget);
+
+	void setBudget(std::size_t budget);
+	std::size_t budget() const;
+
+	/// returns the approximate total size of all tracked output values in bytes
+	std::size_t usage() const;
+
+	/// returns the number of values evicted so far
+	std::size_t evictions() const;
+
+	/// records the approximate size of values held outside of the graph's ports by an owner (e.g., a cache
+	/// of compute results), replacing the owner's previous record (a zero size removes it). These values
+	/// are included in usage(), but they are never evicted - the owner is responsible for releasing them.
+	void setExternalUsage(const void* owner, std::size_t size);
+
+  private:
+	/// records the size of a freshly computed output value, including the values of its request cache
+	void record(Port& output);
+	/// stops tracking a port (used on port destruction)
+	void forget(Port& output);
+	/// evicts least recently pulled values until the usage fits the budget (keeping one port intact).
+	/// Does nothing if any pull holds the pull lock.
+	void evict(Port& keep);
+	/// stops tracking all ports (used when the governor is removed from its graph)
+	void reset();
+
+	static bool isEvictable(const Port& output);
+	void evictPort(Port& output);
+
+	/// returns a new "time" of a pull, for the least-recently-pulled ordering
+	static std::size_t tick();
+
+	mutable std::mutex m_mutex;
+	std::size_t m_budget, m_usage, m_evictions;
+
+	// held shared by all running outermost pulls, and exclusively by the eviction
+	std::shared_timed_mutex m_pullMutex;
+	std::unordered_map<Port*, std::size_t> m_sizes;
+	std::unordered_map<const void*, std::size_t> m_external;
+
+	friend class Graph;
+	friend class NodeBase;
+	friend class Port;
+};
+
+}  // namespace dependency_graph
@@ -8,7 +8,7 @@
 
 namespace dependency_graph {
 
-Metadata::Metadata(const std::string& nodeType) : m_type(nodeType) {
+Metadata::Metadata(const std::string& nodeType) : m_type(nodeType), m_flags(kNoFlags) {
 }
 
 Metadata::~Metadata() {
@@ -26,6 +26,14 @@ void Metadata::setCompute(std::function<State(Values&)> compute) {
 	m_compute = compute;
 }
 
+void Metadata::setFlags(unsigned flags) {
+	m_flags = flags;
+}
+
+unsigned Metadata::flags() const {
+	return m_flags;
+}
+
 size_t Metadata::attributeCount() const {
 	return m_attrs.size();
 }
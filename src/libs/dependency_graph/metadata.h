@@ -38,6 +38,14 @@ struct MetadataAccess;
 
 class Metadata : public boost::noncopyable, public std::enable_shared_from_this<Metadata> {
   public:
+	/// node-level evaluation flags
+	enum Flags {
+		kNoFlags = 0,
+		kMainThreadOnly = 1,    //< compute has to run on the main thread (e.g., touches GL or Qt)
+		kSupportsRequests = 2,  //< compute evaluates only the part of the result required by Values::request()
+		kTimeSource = 4,        //< compute depends on the application time (see Graph::invalidateTimeSources())
+	};
+
 	Metadata(const std::string& nodeType);
 	virtual ~Metadata();
 
@@ -70,6 +78,11 @@ class Metadata : public boost::noncopyable, public std::enable_shared_from_this<
 	/// compute method of this node
 	void setCompute(std::function<State(Values&)> compute);
 
+	/// sets the node-level evaluation flags (a combination of Flags values)
+	void setFlags(unsigned flags);
+	/// returns the node-level evaluation flags
+	unsigned flags() const;
+
 	/// returns the number of attributes currently present
 	size_t attributeCount() const;
 
@@ -100,12 +113,16 @@ class Metadata : public boost::noncopyable, public std::enable_shared_from_this<
 	std::string m_type;
 	std::vector<Attr> m_attrs;
 	std::function<State(Values&)> m_compute;
+	unsigned m_flags;
 
 	boost::bimap<boost::bimaps::multiset_of<unsigned>, boost::bimaps::multiset_of<unsigned>> m_influences;
 
 	friend class Node;
 	friend class NodeBase;
 	friend class Port;
+	friend class EvaluationPlan;
+	friend class TopologicalOrder;
+	friend class AsyncEvaluation;
 
 	/// allow actions to access untemplated doAddAttribute
 	friend struct detail::MetadataAccess;
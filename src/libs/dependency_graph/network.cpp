@@ -20,12 +20,13 @@ bool Network::empty() const {
 }
 
 void Network::clear() {
-	// disconnect everything first
-	while(!m_connections.empty()) {
-		auto& conn = *m_connections.begin();
+	// a cleared network has no content to load
+	setDeferredLoad(Loader());
 
-		conn.first.disconnect(conn.second);
-	}
+	// disconnect everything first
+	for(auto& n : m_nodes)
+		n.disconnectAll();
+	assert(m_connections.empty());
 
 	// first, unlink all the ports
 	for(unsigned i = 0; i < portCount(); ++i) {
@@ -72,6 +73,37 @@ const boost::filesystem::path& Network::source() const {
 	return m_source;
 }
 
+void Network::setDeferredLoad(Loader loader) {
+	const bool changed = static_cast<bool>(m_loader) != static_cast<bool>(loader);
+	if(changed) {
+		if(loader)
+			++Graph::s_deferredNetworks;
+		else
+			--Graph::s_deferredNetworks;
+	}
+
+	m_loader = loader;
+
+	if(changed)
+		graph().stateChanged(*this);
+}
+
+bool Network::isLoaded() const {
+	return !m_loader;
+}
+
+void Network::load() {
+	if(m_loader) {
+		// the loader is removed first - the loading itself can pull on ports without loading again
+		Loader loader;
+		std::swap(loader, m_loader);
+		--Graph::s_deferredNetworks;
+
+		m_state = loader(*this);
+		graph().stateChanged(*this);
+	}
+}
+
 const MetadataHandle& Network::defaultMetadata() {
 	static std::unique_ptr<MetadataHandle> s_handle;
 	if(s_handle == nullptr) {
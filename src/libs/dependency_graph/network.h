@@ -1,6 +1,7 @@
 #pragma once
 
 #include <boost/filesystem/path.hpp>
+#include <functional>
 
 #include "connections.h"
 #include "nodes.h"
@@ -25,6 +26,20 @@ class Network : public NodeBase {
 	void setSource(const boost::filesystem::path& path);
 	const boost::filesystem::path& source() const;
 
+	/// Deferred loading of the network's content (e.g., a network with a source file, with its ports known
+	/// upfront, but its nodes only instantiated when needed). The loader is called once by load(), triggered
+	/// explicitly on the main thread (e.g., by a UI displaying the network, or by Port::loadDeferredNetworks()
+	/// before drawing or evaluating its downstream) - the loading changes the graph, and never happens
+	/// during a pull (pulling an output of a network that is not loaded sets an error state instead). The
+	/// state returned by the loader is used as the state of the network.
+	typedef std::function<State(Network&)> Loader;
+	void setDeferredLoad(Loader loader);
+
+	/// returns false if the content of this network is still waiting for a deferred load
+	bool isLoaded() const;
+	/// loads the content of a network with a deferred load (does nothing otherwise)
+	void load();
+
   protected:
 	Network(const std::string& name, const UniqueId& id, const MetadataHandle& md, Network* parent);
 
@@ -35,6 +50,7 @@ class Network : public NodeBase {
 	Connections m_connections;
 
 	boost::filesystem::path m_source;
+	Loader m_loader;
 
 	friend class Nodes;
 	friend class Metadata;
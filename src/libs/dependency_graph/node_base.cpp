@@ -1,6 +1,17 @@
 #include "node_base.h"
 
+#include <tbb/task_arena.h>
+
+#include <chrono>
+
+#include "async_evaluation.h"
+#include "compute_cache.h"
+#include "evaluation_plan.h"
 #include "graph.h"
+#include "memory_governor.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "topological_order.h"
 #include "values.h"
 
 namespace dependency_graph {
@@ -13,6 +24,8 @@ NodeBase::NodeBase(const std::string& name, const UniqueId& id, const MetadataHa
 
 		m_ports.push_back(Port(meta.offset(), this));
 	}
+
+	TopologicalOrder::assign(m_ports);
 }
 
 NodeBase::~NodeBase() {
@@ -24,15 +37,12 @@ NodeBase::~NodeBase() {
 }
 
 void NodeBase::disconnectAll() {
-	if(hasParentNetwork()) {
-		auto it = network().connections().begin();
-		while(it != network().connections().end())
-			if(&it->first.node() == this || &it->second.node() == this) {
-				it->first.disconnect(it->second);
-				it = network().connections().begin();  // inefficient!
-			}
-			else
-				++it;
+	for(auto& p : m_ports) {
+		if(p.m_connectedFrom)
+			p.m_connectedFrom->disconnect(p);
+
+		while(!p.m_connectedTo.empty())
+			p.disconnect(*p.m_connectedTo.front());
 	}
 }
 
@@ -84,30 +94,65 @@ UniqueId NodeBase::index() const {
 void NodeBase::markAsDirty(size_t portIndex, bool dependantsOnly) {
 	Port& p = port(portIndex);
 
-	// mark the port itself as dirty
-	if(!p.isDirty()) {
+	// mark the port itself as dirty (an evicted port is dirty, but its dependants might not be)
+	if(!p.isDirty() || p.m_evicted) {
+		p.m_evicted = false;
+
+		// values evaluated for previous requests are not valid anymore (unless only re-evaluated
+		//   for another request)
+		if(!Port::isPulling())
+			p.m_requestCache.clear();
+
 		if(!dependantsOnly) {
 			p.setDirty(true);
 
 			graph().dirtyChanged();
 		}
 
-		// recurse + handle each port type slightly differently
-		if(p.category() == Attr::kInput) {
-			// all outputs influenced by this input are marked dirty
-			for(std::size_t i : metadata()->influences(p.index()))
-				markAsDirty(i);
-		}
-		else if(hasParentNetwork()) {
-			// all inputs connected to this output are marked dirty
-			for(Port& o : network().connections().connectedTo(port(portIndex)))
-				o.node().markAsDirty(o.index());
-		}
+		// during a bulk build, the propagation is deferred to its end
+		if(Graph::s_bulkBuilds == 0 || !graph().deferDirtyPropagation(p))
+			propagateDirty(portIndex, dependantsOnly);
+	}
+}
 
-		// propagate to linked ports
-		if(p.isLinked())
-			p.linkedTo().node().markAsDirty(p.linkedTo().m_id, dependantsOnly);
+void NodeBase::propagateDirty(size_t portIndex, bool dependantsOnly) {
+	Port& p = port(portIndex);
+
+	// recurse + handle each port type slightly differently
+	if(p.category() == Attr::kInput) {
+		// all outputs influenced by this input are marked dirty
+		for(std::size_t i : metadata()->influences(p.index()))
+			markAsDirty(i);
+	}
+	else if(hasParentNetwork()) {
+		// all inputs connected to this output are marked dirty
+		for(Port& o : network().connections().connectedTo(p))
+			o.node().markAsDirty(o.index());
 	}
+
+	// propagate to linked ports
+	if(p.isLinked())
+		p.linkedTo().node().markAsDirty(p.linkedTo().m_id, dependantsOnly);
+}
+
+void NodeBase::collectDependants(size_t portIndex, std::unordered_set<const Port*>& ports) {
+	Port& p = port(portIndex);
+
+	// each port is visited only once
+	if(!ports.insert(&p).second)
+		return;
+
+	if(p.category() == Attr::kInput) {
+		for(std::size_t i : metadata()->influences(p.index()))
+			collectDependants(i, ports);
+	}
+	else if(hasParentNetwork()) {
+		for(Port& o : network().connections().connectedTo(p))
+			o.node().collectDependants(o.index(), ports);
+	}
+
+	if(p.isLinked())
+		p.linkedTo().node().collectDependants(p.linkedTo().m_id, ports);
 }
 
 const MetadataHandle& NodeBase::metadata() const {
@@ -133,15 +178,21 @@ void NodeBase::setMetadata(const MetadataHandle& handle) {
 			auto& meta = handle->attr(a);
 			m_ports.push_back(Port(meta.offset(), this));
 		}
+		TopologicalOrder::assign(m_ports);
 
-		// fire the callback
-		if(hasParentNetwork())
+		// invalidate the evaluation plans and fire the callback
+		if(hasParentNetwork()) {
+			graph().m_nodeIndex.update(*this);
+			graph().invalidateEvaluationPlans();
 			graph().metadataChanged(*this);
+		}
 		else {
 			// on destruction, the graph() call and its dynamic cast might fail, lets work around it
 			Graph* g = dynamic_cast<Graph*>(this);
-			if(g != nullptr)
+			if(g != nullptr) {
+				g->invalidateEvaluationPlans();
 				g->metadataChanged(*this);
+			}
 		}
 
 		// mark everything as dirty
@@ -188,7 +239,6 @@ void NodeBase::set(size_t index, const Data& value) {
 
 void NodeBase::computeInput(size_t index) {
 	assert(port(index).category() == Attr::kInput && "computeInput can be only called on inputs");
-	assert(port(index).isDirty() && "input should be dirty for recomputation");
 	assert(port(index).isConnected() && "input has to be connected to be computed");
 
 	// pull on the single connected output if needed
@@ -197,31 +247,104 @@ void NodeBase::computeInput(size_t index) {
 	if(out->isDirty()) {
 		out->getData();  // throw away (bad)
 	}
-	assert(not out->isDirty());
 
-	// assign the value directly
-	const NodeBase& srcNode = out->node();
+	computeInput(index, *out);
+}
+
+void NodeBase::computeInput(size_t index, const Port& out) {
+	assert(not out.isDirty());
+
+	// least-recently-pulled order for the memory governor
+	out.m_lastPulled = MemoryGovernor::tick();
+
+	// concurrent pulls - the value might have been assigned by another thread already
+	std::unique_lock<std::recursive_mutex> lock(m_valuesMutex);
+	if(!port(index).isDirty())
+		return;
+
+	const std::shared_ptr<Profiler>& profiler = graph().profiler();
+	const auto start = profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+	// assign the value directly (keeping its version, to allow early cutoff)
+	const NodeBase& srcNode = out.node();
 	const Datablock& srcData = srcNode.datablock();
-	datablock().setData(index, srcData.data(out->index()));
+	datablock().setData(index, srcData.data(out.index()), srcData.version(out.index()));
+	port(index).setRequest(port(index).m_request, out.m_request);
+
+	if(profiler)
+		profiler->record(Profiler::Event::kInput, port(index), start, std::chrono::steady_clock::duration::zero(),
+		                 std::chrono::steady_clock::now() - start);
 
 	// and mark as not dirty
 	port(index).setDirty(false);
 	assert(not port(index).isDirty());
 
 	// run the watcher callbacks
-	port(index).m_valueCallbacks();
+	if(!AsyncEvaluation::defer(AsyncEvaluation::kValueChanged, *this, index))
+		port(index).m_valueCallbacks();
 }
 
 void NodeBase::computeOutput(size_t index) {
 	assert(port(index).category() == Attr::kOutput && "computeOutput can be only called on outputs");
+
+	// concurrent pulls - a port evaluated by another thread while waiting for the lock is already clean
+	//   (the lock is per output - a lock of the whole node held during the evaluation of its upstream
+	//   could deadlock with a pull of another output, if one output is in the upstream of the other)
+	std::unique_lock<std::recursive_mutex> lock(port(index).m_evaluationMutex);
+	if(!port(index).isDirty())
+		return;
+
+	// tasks spawned while holding the lock (parallel evaluation of the upstream, or TBB tasks of the compute
+	//   itself) are isolated - the waiting thread can't pick up an unrelated task requiring another node's lock
+	tbb::this_task_arena::isolate([&]() { evaluateOutput(index); });
+}
+
+void NodeBase::evaluateOutput(size_t index) {
 	assert(port(index).isDirty() && "output should be dirty for recomputation");
 
 	// first, figure out which inputs need pulling, if any
 	std::vector<std::size_t> inputs = metadata()->influencedBy(index);
 
-	// main computation
+	// the request to evaluate the output for (nodes not supporting requests compute the full result)
+	const Request request =
+	    (metadata()->flags() & Metadata::kSupportsRequests) ? port(index).m_pendingRequest : Request();
+
+	// profiling timestamps - the start of the evaluation, and the start of the compute after pulling the inputs
+	const std::shared_ptr<Profiler>& profiler = graph().profiler();
+	const auto evaluationStart =
+	    profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+	auto computeStart = evaluationStart;
+
+	// main computation, with the computes of all outputs of this node serialized (they share the
+	//   node's state and datablock)
+	std::unique_lock<std::recursive_mutex> computeLock(m_computeMutex, std::defer_lock);
+
 	State result;
 	try {
+		// a network waiting for a deferred load has no content to evaluate - it is not loaded by a pull,
+		//   as the loading changes the graph, but by the next Port::loadDeferredNetworks() call
+		if(is<Network>() && !as<Network>().isLoaded()) {
+			graph().deferredNetworkPulled(as<Network>());
+			throw std::runtime_error("Network " + name() + " is not loaded.");
+		}
+
+		// evaluate the whole dirty upstream first, as a linear sweep over the cached
+		// evaluation plan (or in parallel, with independent computes running concurrently)
+		if(!EvaluationPlan::isEvaluating()) {
+			bool dirty = false;
+			for(std::size_t& i : inputs)
+				dirty |= port(i).isDirty();
+
+			if(dirty) {
+				std::shared_ptr<const EvaluationPlan> plan = graph().evaluationPlan(port(index));
+
+				if(graph().parallelEvaluation())
+					Scheduler::run(*plan);
+				else
+					plan->run();
+			}
+		}
+
 		// pull on all inputs - triggers their recomputation
 		for(std::size_t& i : inputs) {
 			if(port(i).isDirty())
@@ -231,19 +354,75 @@ void NodeBase::computeOutput(size_t index) {
 			assert(!port(i).isDirty());
 		}
 
-		// now run compute, as all inputs are fine
-		//  -> this will change the output value (if the compute method works)
-		Values vals(*this);
-		result = metadata()->m_compute(vals);
+		computeLock.lock();
+
+		if(profiler)
+			computeStart = std::chrono::steady_clock::now();
+
+		// the result of a time source depends on more than its inputs - it can't be skipped or cached
+		const bool timeSource = metadata()->flags() & Metadata::kTimeSource;
+
+		// early cutoff - if neither the output nor any of its inputs changed since the last
+		//   successful compute for the same request, the output value is still valid and the compute
+		//   can be skipped
+		if(graph().earlyCutoff() && !timeSource && !m_state.errored() && port(index).m_request == request &&
+		   port(index).isComputedFrom(inputs)) {
+			port(index).setDirty(false);
+
+			if(AsyncEvaluation* async = AsyncEvaluation::current())
+				async->computeFinished();
+
+			if(profiler)
+				profiler->record(Profiler::Event::kCompute, port(index), evaluationStart,
+				                 computeStart - evaluationStart, std::chrono::steady_clock::now() - computeStart);
+
+			return;
+		}
+
+		// persistent cache - a stored result of a compute with the same inputs replaces the compute
+		//   (only results of full requests are cached)
+		const std::shared_ptr<ComputeCache> cache =
+		    (request.isFull() && !timeSource) ? graph().computeCache() : std::shared_ptr<ComputeCache>();
+		if(!cache || !cache->load(port(index), inputs)) {
+			// now run compute, as all inputs are fine
+			//  -> this will change the output value (if the compute method works)
+			const auto start = std::chrono::steady_clock::now();
+
+			Values vals(*this, request);
+			{
+				Port::ScopedRequest scope(request);
+				result = metadata()->m_compute(vals);
+			}
+
+			if(cache && !result.errored())
+				cache->store(port(index), inputs, std::chrono::steady_clock::now() - start);
+		}
+	}
+	catch(EvaluationCancelled&) {
+		// a cancelled evaluation leaves the output dirty, to be evaluated on the next pull
+		throw;
 	}
 	catch(std::exception& e) {
 		result.addError(e.what());
 	}
 
-	// mark as not dirty
+	// an error while pulling the inputs still updates the node's state
+	if(!computeLock.owns_lock())
+		computeLock.lock();
+
+	// record the versions of the inputs for early cutoff of the next evaluation
+	if(graph().earlyCutoff() && !result.errored())
+		port(index).setComputedFrom(inputs);
+	else
+		port(index).setComputedFrom(std::vector<std::size_t>());
+
+	// mark as not dirty, evaluated for the request
+	port(index).setRequest(port(index).m_request, request);
 	port(index).setDirty(false);
 	assert(not port(index).isDirty());
 
+	const std::shared_ptr<MemoryGovernor>& governor = graph().memoryGovernor();
+
 	// errored - reset the output to default value
 	std::string error_to_throw;
 	if(result.errored()) {
@@ -273,14 +452,28 @@ void NodeBase::computeOutput(size_t index) {
 		}
 	}
 
+	if(profiler)
+		profiler->record(Profiler::Event::kCompute, port(index), evaluationStart, computeStart - evaluationStart,
+		                 std::chrono::steady_clock::now() - computeStart, result.errored());
+
+	if(governor)
+		governor->record(port(index));
+
 	// and run the watcher callbacks
-	port(index).m_valueCallbacks();
+	if(!AsyncEvaluation::defer(AsyncEvaluation::kValueChanged, *this, index))
+		port(index).m_valueCallbacks();
+
+	// if the state changed, run state changed callback (an asynchronous evaluation
+	// runs it after each compute, to report its progress)
+	AsyncEvaluation* async = AsyncEvaluation::current();
+	if(async)
+		async->computeFinished();
 
-	// if the state changed, run state changed callback
-	if(result != m_state) {
+	if(result != m_state || async) {
 		m_state = result;
 
-		network().graph().stateChanged(*this);
+		if(!AsyncEvaluation::defer(AsyncEvaluation::kStateChanged, *this))
+			network().graph().stateChanged(*this);
 	}
 
 	// throw an exception if errored and no reset could be done
@@ -2,7 +2,9 @@
 
 #include <boost/optional.hpp>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_set>
 
 #include "data.h"
 #include "datablock.h"
@@ -69,6 +71,10 @@ class NodeBase {
 
 	const State& state() const;
 
+	/// evaluates a dirty input or output port. Thread-safe - an output is evaluated under its own
+	/// evaluation lock (and its compute under the node's compute lock), an input is assigned under
+	/// the node's values lock. A port evaluated by another thread while waiting for a lock is not
+	/// evaluated again (see Port::getData()).
 	void computeInput(size_t index);
 	void computeOutput(size_t index);
 
@@ -100,6 +106,16 @@ class NodeBase {
 
 	// used by Port instances
 	void markAsDirty(size_t portIndex, bool dependantsOnly = false);
+	// marks all dependants of a port as dirty (deferred by markAsDirty() during a bulk build)
+	void propagateDirty(size_t portIndex, bool dependantsOnly);
+	// collects a port and all its dependants (following the same rules as the dirtiness propagation)
+	void collectDependants(size_t portIndex, std::unordered_set<const Port*>& ports);
+
+	// used by evaluation plans - assigns the value of an already evaluated connected output to an input
+	void computeInput(size_t index, const Port& connectedOutput);
+
+	// evaluates the upstream of an output and runs the compute, with the evaluation lock held
+	void evaluateOutput(size_t index);
 
 	// used during destruction
 	void disconnectAll();
@@ -116,10 +132,20 @@ class NodeBase {
 
 	State m_state;
 
+	// concurrent pulls - each output is evaluated under its own lock, including its upstream (which can
+	//   include other outputs of the same node). The compute lock is only held while computing, after all
+	//   inputs are evaluated, and the values lock only guards the assignment of input and linked values -
+	//   neither is held while pulling.
+	std::recursive_mutex m_computeMutex, m_valuesMutex;
+
 	// blind data access
 	// friend struct io::adl_serializer<NodeBase>;
 	friend class Nodes;
 	friend class Port;
+	friend class Network;
+	friend class EvaluationPlan;
+	friend class MemoryGovernor;
+	friend class Graph;
 };
 
 }  // namespace dependency_graph
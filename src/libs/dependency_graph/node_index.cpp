@@ -0,0 +1,84 @@
+#include "node_index.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "node_base.h"
+
+namespace dependency_graph {
+
+NodeIndex::NodeIndex() {
+}
+
+bool NodeIndex::empty() const {
+	return m_nodes.empty();
+}
+
+std::size_t NodeIndex::size() const {
+	return m_nodes.size();
+}
+
+NodeBase* NodeIndex::find(const UniqueId& id) const {
+	auto it = m_positions.find(id);
+	if(it == m_positions.end())
+		return nullptr;
+
+	return m_nodes[it->second];
+}
+
+NodeIndex::const_iterator NodeIndex::begin() const {
+	return const_iterator(m_nodes.begin());
+}
+
+NodeIndex::const_iterator NodeIndex::end() const {
+	return const_iterator(m_nodes.end());
+}
+
+const std::vector<NodeBase*>& NodeIndex::timeSources() const {
+	return m_timeSources;
+}
+
+void NodeIndex::add(NodeBase& node) {
+	assert(m_positions.find(node.index()) == m_positions.end());
+
+	m_positions.insert(std::make_pair(node.index(), m_nodes.size()));
+	m_nodes.push_back(&node);
+
+	if(node.metadata()->flags() & Metadata::kTimeSource)
+		m_timeSources.push_back(&node);
+}
+
+void NodeIndex::remove(NodeBase& node) {
+	auto it = m_positions.find(node.index());
+	assert(it != m_positions.end());
+
+	// swap-remove, keeping the array dense
+	const std::size_t pos = it->second;
+	m_positions.erase(it);
+
+	if(pos + 1 != m_nodes.size()) {
+		m_nodes[pos] = m_nodes.back();
+		m_positions[m_nodes[pos]->index()] = pos;
+	}
+	m_nodes.pop_back();
+
+	auto ts = std::find(m_timeSources.begin(), m_timeSources.end(), &node);
+	if(ts != m_timeSources.end())
+		m_timeSources.erase(ts);
+}
+
+void NodeIndex::update(NodeBase& node) {
+	// nodes changing their metadata during construction are not indexed yet
+	if(m_positions.find(node.index()) == m_positions.end())
+		return;
+
+	auto ts = std::find(m_timeSources.begin(), m_timeSources.end(), &node);
+	const bool isTimeSource = node.metadata()->flags() & Metadata::kTimeSource;
+
+	if(isTimeSource && ts == m_timeSources.end())
+		m_timeSources.push_back(&node);
+	else if(!isTimeSource && ts != m_timeSources.end())
+		m_timeSources.erase(ts);
+}
+
+}  // namespace dependency_graph
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <boost/iterator/indirect_iterator.hpp>
+#include <boost/noncopyable.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "unique_id.h"
+
+namespace dependency_graph {
+
+class NodeBase;
+
+/// A graph-wide index of all nodes, including the nodes of nested networks. Nodes are held in
+/// a dense array for fast iteration (in no particular order), with a hash-based lookup by their
+/// UniqueId. As an UniqueId is never reused, an id of a removed node simply doesn't resolve.
+/// Also keeps a registry of all time source nodes (nodes with the Metadata::kTimeSource flag).
+/// Maintained by Nodes::add(), Nodes::erase() and NodeBase::setMetadata().
+class NodeIndex : public boost::noncopyable {
+  public:
+	bool empty() const;
+	std::size_t size() const;
+
+	/// returns the node with an id, or nullptr if no such node exists in the graph
+	NodeBase* find(const UniqueId& id) const;
+
+	typedef boost::indirect_iterator<std::vector<NodeBase*>::const_iterator> const_iterator;
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	/// all nodes with the Metadata::kTimeSource flag (in no particular order)
+	const std::vector<NodeBase*>& timeSources() const;
+
+  private:
+	NodeIndex();
+
+	void add(NodeBase& node);
+	void remove(NodeBase& node);
+	/// updates the time source registry after a metadata change of a node
+	void update(NodeBase& node);
+
+	std::vector<NodeBase*> m_nodes;
+	// position of each node in the dense array
+	std::unordered_map<UniqueId, std::size_t> m_positions;
+	// the time source nodes - usually only a handful, searched linearly on removal
+	std::vector<NodeBase*> m_timeSources;
+
+	friend class Graph;
+	friend class Nodes;
+	friend class NodeBase;
+};
+
+}  // namespace dependency_graph
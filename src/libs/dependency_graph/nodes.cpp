@@ -1,5 +1,6 @@
 #include "nodes.inl"
 
+#include <algorithm>
 #include <cassert>
 
 #include "graph.h"
@@ -48,7 +49,13 @@ NodeBase& Nodes::add(const MetadataHandle& type,
 		node->setDatablock(*datablock);
 	}
 
-	auto it = m_nodes.insert(std::move(node)).first;
+	// new nodes usually have the highest id - inserting at the end keeps the array sorted
+	auto pos = std::upper_bound(m_nodes.begin(), m_nodes.end(), node, Compare());
+	auto it = m_nodes.insert(pos, std::move(node));
+
+	m_parent->graph().m_nodeIndex.add(**it);
+	if((*it)->metadata()->flags() & Metadata::kTimeSource)
+		m_parent->graph().invalidateTimeDependency();
 
 	m_parent->graph().nodeAdded(**it);
 	m_parent->graph().dirtyChanged();
@@ -68,13 +75,18 @@ Nodes::iterator Nodes::erase(const iterator& i) {
 	m_parent->graph().nodeRemoved(*i);
 	m_parent->graph().dirtyChanged();
 
+	m_parent->graph().m_nodeIndex.remove(*i);
+
 	auto it = m_nodes.erase(i.base());
+	m_parent->graph().invalidateEvaluationPlans();
+
 	return Nodes::iterator(it, m_nodes.end(), false);
 }
 
 void Nodes::clear() {
+	// removing from the back, to avoid moving the remaining nodes on each removal
 	while(!m_nodes.empty())
-		erase(Nodes::iterator(m_nodes.begin(), m_nodes.end(), false));
+		erase(Nodes::iterator(m_nodes.end() - 1, m_nodes.end(), false));
 }
 
 bool Nodes::empty() const {
@@ -95,15 +107,18 @@ Nodes::const_iterator Nodes::end() const {
 
 Nodes::const_iterator Nodes::find(const UniqueId& id, const SearchType& st) const {
 	if(st == kThisNetwork)
-		return const_iterator(m_nodes.find(id), m_nodes.end(), false);
-
-	// linear search, for now
-	else {
-		auto it = begin(kRecursive);
-		while(it != end() && it->index() != id)
-			++it;
-		return it;
-	}
+		return const_iterator(m_nodes.begin() + position(id), m_nodes.end(), false);
+
+	const auto p = path(id);
+	if(p.empty())
+		return end();
+
+	// a recursive iterator, with the positions of all parent networks on its stack
+	const_iterator result(m_nodes.begin() + p.front().second, m_nodes.end(), true);
+	for(auto it = p.begin() + 1; it != p.end(); ++it)
+		result.push(it->first->m_nodes.begin() + it->second, it->first->m_nodes.end());
+
+	return result;
 }
 
 Nodes::iterator Nodes::begin(const SearchType& st) {
@@ -116,29 +131,65 @@ Nodes::iterator Nodes::end() {
 
 Nodes::iterator Nodes::find(const UniqueId& id, const SearchType& st) {
 	if(st == kThisNetwork)
-		return Nodes::iterator(m_nodes.find(id), m_nodes.end(), false);
-
-	// linear search, for now
-	else {
-		auto it = begin(kRecursive);
-		while(it != end() && it->index() != id)
-			++it;
-		return it;
+		return Nodes::iterator(m_nodes.begin() + position(id), m_nodes.end(), false);
+
+	const auto p = path(id);
+	if(p.empty())
+		return end();
+
+	// a recursive iterator, with the positions of all parent networks on its stack
+	Nodes::iterator result(m_nodes.begin() + p.front().second, m_nodes.end(), true);
+	for(auto it = p.begin() + 1; it != p.end(); ++it) {
+		Nodes& nodes = const_cast<Nodes&>(*it->first);
+		result.push(nodes.m_nodes.begin() + it->second, nodes.m_nodes.end());
 	}
+
+	return result;
+}
+
+std::size_t Nodes::position(const UniqueId& id) const {
+	auto it = std::lower_bound(m_nodes.begin(), m_nodes.end(), id, Compare());
+	if(it == m_nodes.end() || (*it)->index() != id)
+		return m_nodes.size();
+
+	return it - m_nodes.begin();
+}
+
+std::vector<std::pair<const Nodes*, std::size_t>> Nodes::path(const UniqueId& id) const {
+	std::vector<std::pair<const Nodes*, std::size_t>> result;
+
+	// the graph-wide index resolves the node directly, without walking the nested networks
+	const NodeBase* node = m_parent->graph().nodeIndex().find(id);
+
+	while(node != nullptr && node->hasParentNetwork()) {
+		const Nodes& nodes = node->network().nodes();
+		result.push_back(std::make_pair(&nodes, nodes.position(node->index())));
+		assert(result.back().second < nodes.size());
+
+		if(&nodes == this) {
+			std::reverse(result.begin(), result.end());
+			return result;
+		}
+
+		node = &node->network();
+	}
+
+	// the node is not in this network or in any of its nested networks
+	return std::vector<std::pair<const Nodes*, std::size_t>>();
 }
 
 NodeBase& Nodes::operator[](const dependency_graph::UniqueId& index) {
-	auto it = m_nodes.find(index);
-	assert(it != m_nodes.end());
+	const std::size_t pos = position(index);
+	assert(pos < m_nodes.size());
 
-	return **it;
+	return *m_nodes[pos];
 }
 
 const NodeBase& Nodes::operator[](const dependency_graph::UniqueId& index) const {
-	auto it = m_nodes.find(index);
-	assert(it != m_nodes.end());
+	const std::size_t pos = position(index);
+	assert(pos < m_nodes.size());
 
-	return **it;
+	return *m_nodes[pos];
 }
 
 }  // namespace dependency_graph
@@ -4,7 +4,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/optional.hpp>
 #include <memory>
-#include <set>
+#include <vector>
 
 #include "data.h"
 #include "node.h"
@@ -21,11 +21,11 @@ class Network;
 
 /// Data structure holding node instances.
 /// Iterators are not guaranteed to remain valid after operations,
-/// but the node instances are stored in a vector container (their
-/// positions in the array will not change after add, and erase
-/// shifts subsequent indices), and each node instance's memory
-/// address is guaranteed not to change during its lifetime (Nodes
-/// are stored as pointers).
+/// but the node instances are stored in a vector container, sorted
+/// by their UniqueId (lookups are binary searches in a contiguous
+/// array), and each node instance's memory address is guaranteed
+/// not to change during its lifetime (Nodes are stored as pointers).
+/// Recursive lookups use the graph-wide NodeIndex.
 class Nodes : public boost::noncopyable {
   private:
 	struct Compare {
@@ -41,7 +41,7 @@ class Nodes : public boost::noncopyable {
 		typedef bool is_transparent;
 	};
 
-	using NodeSet = std::set<std::unique_ptr<NodeBase>, Compare>;
+	using NodeArray = std::vector<std::unique_ptr<NodeBase>>;
 
   public:
 	enum SearchType { kThisNetwork, kRecursive };
@@ -52,12 +52,12 @@ class Nodes : public boost::noncopyable {
 	NodeBase& operator[](const UniqueId& index);
 	const NodeBase& operator[](const UniqueId& index) const;
 
-	typedef NodesIterator<NodeSet::const_iterator> const_iterator;
+	typedef NodesIterator<NodeArray::const_iterator> const_iterator;
 	const_iterator begin(const SearchType& st = kThisNetwork) const;
 	const_iterator end() const;
 	const_iterator find(const UniqueId& id, const SearchType& st = kThisNetwork) const;
 
-	typedef NodesIterator<NodeSet::iterator> iterator;
+	typedef NodesIterator<NodeArray::iterator> iterator;
 	iterator begin(const SearchType& st = kThisNetwork);
 	iterator end();
 	iterator find(const UniqueId& id, const SearchType& st = kThisNetwork);  // will use is<Network>()
@@ -73,16 +73,23 @@ class Nodes : public boost::noncopyable {
   private:
 	Nodes(Network* parent);
 
+	/// returns the position of a node in this container (m_nodes.size() if not found)
+	std::size_t position(const UniqueId& id) const;
+	/// returns the path to a node in this network or any of its nested networks - the containers
+	/// and positions of the node and all its parent networks, starting from this container
+	std::vector<std::pair<const Nodes*, std::size_t>> path(const UniqueId& id) const;
+
 	Network* m_parent;
 
 	// stored in a pointer container, to keep parent pointers
 	//   stable without too much effort (might change)
-	NodeSet m_nodes;
+	NodeArray m_nodes;
 
 	friend class Graph;
 	friend class NodeBase;
 	friend class Node;
 	friend class Network;
+	friend class Connections;
 };
 
 }  // namespace dependency_graph
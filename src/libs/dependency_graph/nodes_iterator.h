@@ -2,6 +2,8 @@
 
 #include <boost/iterator/iterator_facade.hpp>
 #include <stack>
+#include <type_traits>
+#include <vector>
 
 namespace dependency_graph {
 
@@ -17,9 +19,27 @@ class NodesIterator
 	NodesIterator();
 	NodesIterator(ITERATOR i, ITERATOR end, bool recursive);
 
+	/// conversion from a non-const iterator
+	template <typename OTHER, typename = typename std::enable_if<std::is_convertible<OTHER, ITERATOR>::value>::type>
+	NodesIterator(const NodesIterator<OTHER>& other) : m_recursive(other.m_recursive) {
+		// std::stack can't be iterated - copy it via its top element
+		std::vector<typename NodesIterator<OTHER>::Item> items;
+		auto its = other.m_its;
+		while(!its.empty()) {
+			items.push_back(its.top());
+			its.pop();
+		}
+
+		for(auto it = items.rbegin(); it != items.rend(); ++it)
+			m_its.push(Item{it->current, it->end});
+	}
+
 	// corresponds to the interface of boost::indirect_iterator
 	ITERATOR base() const;
 
+	/// descends into a nested network (used to construct recursive iterators pointing to nested nodes)
+	void push(ITERATOR i, ITERATOR end);
+
   private:
 	struct Item {
 		ITERATOR current;
@@ -35,6 +55,9 @@ class NodesIterator
 
 	friend class boost::iterator_core_access;
 
+	template <typename OTHER>
+	friend class NodesIterator;
+
 	void increment();
 	bool equal(const NodesIterator<ITERATOR>& other) const;
 	typename ITERATOR::value_type::element_type& dereference() const;
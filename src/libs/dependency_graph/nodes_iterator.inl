@@ -20,6 +20,12 @@ ITERATOR NodesIterator<ITERATOR>::NodesIterator::base() const {
 	return m_its.top().current;
 }
 
+template <typename ITERATOR>
+void NodesIterator<ITERATOR>::push(ITERATOR i, ITERATOR end) {
+	assert(m_recursive);
+	m_its.push(Item{i, end});
+}
+
 template <typename ITERATOR>
 bool NodesIterator<ITERATOR>::NodesIterator::Item::operator==(const Item& i) const {
 	return current == i.current && end == i.end;
@@ -1,21 +1,100 @@
 #include "port.inl"
 
+#include <algorithm>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "async_evaluation.h"
+#include "evaluation_plan.h"
 #include "graph.h"
 #include "io.h"
+#include "memory_governor.h"
+#include "network.h"
+#include "node_base.inl"
 #include "rtti.h"
+#include "topological_order.h"
 
 namespace dependency_graph {
 
+namespace {
+
+// number of pulls running on the current thread (computes pull on their inputs)
+thread_local unsigned s_pullDepth = 0;
+
+struct ScopedPull : public boost::noncopyable {
+	ScopedPull() {
+		++s_pullDepth;
+	}
+
+	~ScopedPull() {
+		--s_pullDepth;
+	}
+};
+
+// the request of the compute running on the current thread (null for a full request)
+thread_local const Request* s_computeRequest = nullptr;
+
+// the number of values of previous requests cached per output
+const std::size_t s_requestCacheSize = 4;
+
+}  // namespace
+
+
+Port::ScopedRequest::ScopedRequest(const Request& request) : m_previous(s_computeRequest) {
+	s_computeRequest = &request;
+}
+
+Port::ScopedRequest::~ScopedRequest() {
+	s_computeRequest = m_previous;
+}
+
 Port::Port(unsigned id, NodeBase* parent)
     : m_parent(parent),
       m_id(id),
       m_dirty(parent->metadata()->attr(id).category() == Attr::kOutput),
+      m_dirtyBatchPosition(-1),
+      m_dirtyDeferredPosition(-1),
+      m_evicted(false),
+      m_pinned(false),
+      m_memoryTracked(false),
+      m_lastPulled(0),
       m_linkedToPort(nullptr),
-      m_linkedFromPort(nullptr) {
+      m_linkedFromPort(nullptr),
+      m_connectedFrom(nullptr),
+      m_order(0),
+      m_computedVersion(0) {
 }
 
 Port::Port(Port&& p)
-    : m_parent(p.m_parent), m_id(p.m_id), m_dirty(p.m_dirty), m_linkedToPort(nullptr), m_linkedFromPort(nullptr) {
+    : m_parent(p.m_parent),
+      m_id(p.m_id),
+      m_dirty(p.m_dirty.load()),
+      m_dirtyBatchPosition(-1),
+      m_dirtyDeferredPosition(-1),
+      m_evicted(p.m_evicted),
+      m_pinned(p.m_pinned),
+      m_memoryTracked(false),
+      m_lastPulled(p.m_lastPulled.load()),
+      m_linkedToPort(nullptr),
+      m_linkedFromPort(nullptr),
+      m_connectedFrom(nullptr),
+      m_order(p.m_order),
+      m_computedVersion(0),
+      m_request(p.m_request),
+      m_pendingRequest(p.m_pendingRequest),
+      m_requestCache(std::move(p.m_requestCache)) {
+	// the partial requests are transferred to the new port
+	p.m_request = Request();
+	p.m_pendingRequest = Request();
+
+	// connections refer to port addresses - only unconnected ports can be moved
+	assert(p.m_connectedFrom == nullptr && p.m_connectedTo.empty());
+	// same for ports recorded in a dirty batch or a bulk build, or tracked by the memory governor
+	assert(p.m_dirtyBatchPosition == std::size_t(-1));
+	assert(p.m_dirtyDeferredPosition == std::size_t(-1));
+	assert(!p.m_memoryTracked);
+
 	if(p.m_linkedFromPort)
 		p.m_linkedFromPort->unlink();
 	if(p.m_linkedToPort)
@@ -27,6 +106,9 @@ Port::Port(Port&& p)
 }
 
 Port::~Port() {
+	setRequest(m_request, Request());
+	setRequest(m_pendingRequest, Request());
+
 	if(m_parent) {
 		// this port should not be connected
 		assert(!isConnected());
@@ -36,6 +118,18 @@ Port::~Port() {
 
 		if(m_linkedToPort)
 			unlink();
+
+		// a removed port can't be part of the dirty batch notification
+		if(m_dirtyBatchPosition != std::size_t(-1))
+			m_parent->graph().forgetDirtyChange(*this);
+
+		// or the deferred dirtiness of a bulk build
+		if(m_dirtyDeferredPosition != std::size_t(-1))
+			m_parent->graph().forgetDeferredDirty(*this);
+
+		// same for the memory governor
+		if(m_memoryTracked && m_parent->graph().memoryGovernor())
+			m_parent->graph().memoryGovernor()->forget(*this);
 	}
 }
 
@@ -69,14 +163,12 @@ std::type_index Port::type() const {
 	// void port "type" can be determined by any connected other ports
 	if(t == typeid(void)) {
 		if(category() == Attr::kInput) {
-			auto out = node().network().connections().connectedFrom(*this);
-			if(out)
-				t = out->type();
+			if(m_connectedFrom)
+				t = m_connectedFrom->type();
 		}
 		else if(category() == Attr::kOutput) {
-			auto in = node().network().connections().connectedTo(*this);
-			if(!in.empty())
-				t = in[0].get().type();
+			if(!m_connectedTo.empty())
+				t = m_connectedTo.front()->type();
 		}
 	}
 
@@ -87,6 +179,51 @@ bool Port::isDirty() const {
 	return m_dirty;
 }
 
+std::size_t Port::version() const {
+	return m_parent->datablock().version(m_id);
+}
+
+const Request& Port::request() const {
+	return m_request;
+}
+
+void Port::setRequest(Request& target, const Request& request) {
+	if(target.isFull() != request.isFull()) {
+		std::atomic<std::size_t>& partialRequests = m_parent->graph().m_partialRequests;
+
+		if(request.isFull())
+			--partialRequests;
+		else
+			++partialRequests;
+	}
+
+	target = request;
+}
+
+bool Port::isPulling() {
+	return s_pullDepth > 0 || EvaluationPlan::isEvaluating();
+}
+
+void Port::setComputedFrom(const std::vector<std::size_t>& inputs) {
+	m_computedVersion = version();
+
+	m_computedInputVersions.resize(inputs.size());
+	for(std::size_t i = 0; i < inputs.size(); ++i)
+		m_computedInputVersions[i] = m_parent->port(inputs[i]).version();
+}
+
+bool Port::isComputedFrom(const std::vector<std::size_t>& inputs) const {
+	if(m_computedInputVersions.empty() || m_computedInputVersions.size() != inputs.size() ||
+	   m_computedVersion != version())
+		return false;
+
+	for(std::size_t i = 0; i < inputs.size(); ++i)
+		if(m_computedInputVersions[i] != m_parent->port(inputs[i]).version())
+			return false;
+
+	return true;
+}
+
 NodeBase& Port::node() {
 	assert(m_parent != NULL);
 	return *m_parent;
@@ -97,22 +234,214 @@ const NodeBase& Port::node() const {
 	return *m_parent;
 }
 
+Port& Port::loadDeferredNetworks() {
+	// without any deferred networks in any graph, there is nothing to load
+	if(Graph::s_deferredNetworks == 0)
+		return *this;
+
+	// the loading can recreate the ports of a network (including this port) - the port is found by its index
+	NodeBase& node = *m_parent;
+	const unsigned id = m_id;
+
+	// networks pulled before being loaded are loaded first - their downstream, evaluated with the default
+	//   values of their outputs, is not dirty anymore (the loading makes it dirty again)
+	node.graph().loadPulledNetworks();
+
+	bool loaded = true;
+	while(loaded) {
+		loaded = false;
+
+		if(id >= node.portCount())
+			throw std::runtime_error("Port #" + std::to_string(id) + " of node " + node.name() +
+			                         " doesn't exist after loading its network.");
+
+		std::vector<Port*> stack(1, &node.port(id));
+		std::unordered_set<const Port*> visited;
+
+		// only dirty ports can trigger a compute
+		while(!stack.empty() && !loaded) {
+			Port* p = stack.back();
+			stack.pop_back();
+
+			if(p->m_dirty && visited.insert(p).second) {
+				if(p->m_linkedFromPort)
+					stack.push_back(p->m_linkedFromPort);
+
+				else if(p->category() == Attr::kInput) {
+					if(p->m_connectedFrom)
+						stack.push_back(p->m_connectedFrom);
+				}
+
+				else if(p->m_parent->is<Network>() && !p->m_parent->as<Network>().isLoaded()) {
+					p->m_parent->as<Network>().load();
+					loaded = true;
+				}
+
+				else
+					for(std::size_t i : p->m_parent->metadata()->influencedBy(p->m_id))
+						stack.push_back(&p->m_parent->port(i));
+			}
+		}
+	}
+
+	return node.port(id);
+}
+
+void Port::prepareRequest(const Request& request) {
+	std::vector<std::pair<Port*, Request>> stack(1, std::make_pair(this, request));
+	std::unordered_map<const Port*, Request> visited;
+
+	while(!stack.empty()) {
+		Port* p = stack.back().first;
+		Request r = stack.back().second;
+		stack.pop_back();
+
+		// nodes not supporting requests always compute their full result, from full inputs
+		const bool computed = p->category() == Attr::kOutput && !p->m_linkedFromPort;
+		if(computed && !(p->m_parent->metadata()->flags() & Metadata::kSupportsRequests))
+			r = Request();
+
+		// a port required by different requests is evaluated for a request covering all of them (approximated
+		//   by the full request)
+		auto it = visited.find(p);
+		if(it != visited.end()) {
+			if(it->second.covers(r))
+				continue;
+
+			if(!r.covers(it->second))
+				r = Request();
+			it->second = r;
+		}
+		else
+			visited.insert(std::make_pair(p, r));
+
+		// concurrent pulls - the port is validated under the same lock as its evaluation (or as the assignment
+		//   of an input value), held only while visiting the port (the outermost pull doesn't hold any other)
+		std::unique_lock<std::recursive_mutex> lock(computed ? p->m_evaluationMutex : p->m_parent->m_valuesMutex);
+
+		if(!p->m_dirty) {
+			// the current value is valid for the request, or a value of a previous request can be reused
+			if(p->m_request.covers(r) || p->restoreRequest(r))
+				continue;
+
+			// otherwise the port has to be recomputed - without invalidating its downstream, which holds
+			//   values valid for their own requests (same as an evicted value, see MemoryGovernor)
+			p->cacheRequest();
+			p->setDirty(true);
+			p->m_evicted = true;
+		}
+
+		p->setRequest(p->m_pendingRequest, r);
+
+		if(p->m_linkedFromPort)
+			stack.push_back(std::make_pair(p->m_linkedFromPort, r));
+
+		else if(p->category() == Attr::kInput) {
+			if(p->m_connectedFrom)
+				stack.push_back(std::make_pair(p->m_connectedFrom, r));
+		}
+
+		else
+			for(std::size_t i : p->m_parent->metadata()->influencedBy(p->m_id))
+				stack.push_back(std::make_pair(&p->m_parent->port(i), r));
+	}
+}
+
+void Port::cacheRequest() {
+	// inputs share the value holders of their connected outputs
+	if(category() != Attr::kOutput || m_linkedFromPort)
+		return;
+
+	m_requestCache.erase(
+	    std::remove_if(m_requestCache.begin(), m_requestCache.end(),
+	                   [this](const CachedRequest& c) { return c.request == m_request; }),
+	    m_requestCache.end());
+
+	m_requestCache.insert(m_requestCache.begin(), CachedRequest{m_request, m_parent->get(m_id), version()});
+	if(m_requestCache.size() > s_requestCacheSize)
+		m_requestCache.pop_back();
+
+	// the cached values are accounted for by the memory governor
+	if(const std::shared_ptr<MemoryGovernor>& governor = m_parent->graph().memoryGovernor())
+		governor->record(*this);
+}
+
+bool Port::restoreRequest(const Request& request) {
+	auto it = std::find_if(m_requestCache.begin(), m_requestCache.end(),
+	                       [&request](const CachedRequest& c) { return c.request.covers(request); });
+	if(it == m_requestCache.end())
+		return false;
+
+	CachedRequest cached = *it;
+	m_requestCache.erase(it);
+
+	cacheRequest();
+
+	// the restored value keeps its version - the downstream evaluated for the same request stays valid
+	m_parent->datablock().setData(m_id, cached.value, cached.version);
+	setRequest(m_request, cached.request);
+
+	if(const std::shared_ptr<MemoryGovernor>& governor = m_parent->graph().memoryGovernor())
+		governor->record(*this);
+
+	if(!AsyncEvaluation::defer(AsyncEvaluation::kValueChanged, *m_parent, m_id))
+		m_valueCallbacks();
+
+	return true;
+}
+
 const Data& Port::getData() {
+	return getData(Request());
+}
+
+const Data& Port::getData(const Request& request) {
+	// least-recently-pulled order for the memory governor
+	m_lastPulled = MemoryGovernor::tick();
+
+	// pulling during a bulk build requires the deferred dirtiness to be propagated first
+	if(Graph::s_bulkBuilds > 0)
+		m_parent->graph().flushDeferredDirty();
+
+	// values evaluated for partial requests are validated by the outermost pull (a full pull only has to
+	//   do that if there are any in its graph)
+	if(!isPulling() && (!request.isFull() || m_parent->graph().m_partialRequests > 0))
+		prepareRequest(request);
+
 	// do the computation if needed, to get rid of the dirty flag
 	if(m_dirty) {
-		if(category() == Attr::kInput) {
-			if(isConnected())
-				m_parent->computeInput(m_id);
-			else if(m_linkedFromPort)
-				setData(m_linkedFromPort->getData());
-			else
-				setDirty(false);
+		// the outermost pull of this thread holds a shared lock of the memory governor - the values are
+		//   evicted at the end of the pull, but never while any other pull is running
+		std::shared_ptr<MemoryGovernor> governor;
+		std::shared_lock<std::shared_timed_mutex> pulling;
+		if(s_pullDepth == 0 && !EvaluationPlan::isEvaluating()) {
+			governor = m_parent->graph().memoryGovernor();
+			if(governor)
+				pulling = std::shared_lock<std::shared_timed_mutex>(governor->m_pullMutex);
 		}
-		else if(category() == Attr::kOutput) {
-			if(!m_linkedFromPort)
-				m_parent->computeOutput(m_id);
-			else
-				setData(m_linkedFromPort->getData());
+
+		{
+			ScopedPull pull;
+
+			if(category() == Attr::kInput) {
+				if(isConnected())
+					m_parent->computeInput(m_id);
+				else if(m_linkedFromPort)
+					setLinkedData();
+				else
+					setDirty(false);
+			}
+			else if(category() == Attr::kOutput) {
+				if(!m_linkedFromPort)
+					m_parent->computeOutput(m_id);
+				else
+					setLinkedData();
+			}
+		}
+
+		// evict the least recently pulled values if over the memory budget (keeping the value of this port)
+		if(governor) {
+			pulling.unlock();
+			governor->evict(m_connectedFrom ? *m_connectedFrom : *this);
 		}
 	}
 
@@ -127,19 +456,57 @@ void Port::setData(const Data& val) {
 	// setting a value in the middle of the graph might do
 	//   weird things, so lets assert it
 	assert(category() == Attr::kOutput || !isConnected());
+	// input values are only set from outside of the evaluation, and not while an asynchronous one is running
+	assert(category() == Attr::kOutput || !m_parent->graph().isEvaluatingAsync());
+
+	// a value set by a compute is evaluated for the compute's request - an explicitly set value
+	//   replaces the results of all requests
+	if(s_computeRequest)
+		setRequest(m_request, *s_computeRequest);
+	else {
+		setRequest(m_request, Request());
+		m_requestCache.clear();
+	}
 
-	// set the value in the data block
+	// set the value in the data block (an equal value keeps its original version)
 	const bool valueWasSet = (m_parent->get(m_id).type() != val.type()) || (m_parent->get(m_id) != val);
-	m_parent->set(m_id, val);
+	if(valueWasSet)
+		m_parent->set(m_id, val);
+	else
+		m_parent->datablock().setData(m_id, val, version());
 
+	valueChanged(valueWasSet);
+}
+
+void Port::setLinkedData() {
+	assert(m_linkedFromPort != nullptr);
+	assert(category() == Attr::kOutput || !isConnected());
+
+	const Data& val = m_linkedFromPort->getData();
+
+	// concurrent pulls - the value might have been transferred by another thread already
+	std::unique_lock<std::recursive_mutex> lock(m_parent->m_valuesMutex);
+	if(!m_dirty)
+		return;
+
+	// transfer the value including its version - a linked port holds the same value as its source
+	const bool valueWasSet = (m_parent->get(m_id).type() != val.type()) || (m_parent->get(m_id) != val);
+	m_parent->datablock().setData(m_id, val, m_linkedFromPort->version());
+	setRequest(m_request, m_linkedFromPort->m_request);
+
+	valueChanged(valueWasSet);
+}
+
+void Port::valueChanged(bool valueWasSet) {
 	// explicitly setting a value makes it not dirty, but makes everything that
-	//   depends on it dirty
-	setDirty(false);
+	//   depends on it dirty (a dirty port's dependants are dirty already). The dependants are
+	//   marked first - a concurrent pull can use the value as soon as it is not dirty.
 	m_parent->markAsDirty(m_id, true);
+	setDirty(false);
 	assert(!isDirty());
 
 	// call the values callback
-	if(valueWasSet)
+	if(valueWasSet && !AsyncEvaluation::defer(AsyncEvaluation::kValueChanged, *m_parent, m_id))
 		m_valueCallbacks();
 
 	// and make linked port dirty, to allow it to pull on next evaluation
@@ -148,12 +515,21 @@ void Port::setData(const Data& val) {
 }
 
 void Port::setDirty(bool d) {
-	// change in dirtiness flag
-	if(m_dirty != d) {
-		m_dirty = d;
-
-		// call all flags change callbacks (intended to update UIs accordingly)
-		m_flagsCallbacks();
+	// change in dirtiness flag (made by a single thread, if called concurrently)
+	bool current = !d;
+	if(m_dirty.compare_exchange_strong(current, d)) {
+		m_evicted = false;
+
+		// the request of a pending evaluation is only relevant for dirty ports
+		if(!d)
+			setRequest(m_pendingRequest, Request());
+
+		// call all flags change callbacks (intended to update UIs accordingly), unless
+		//   deferred to the end of the current dirty batch, or to the thread that started
+		//   an asynchronous evaluation
+		if(!m_parent->graph().batchDirtyChange(*this) &&
+		   !AsyncEvaluation::defer(AsyncEvaluation::kFlagsChanged, *m_parent, m_id))
+			m_flagsCallbacks();
 
 		// if linked, mark the linked network as dirty as well
 		if(isLinked() && d)
@@ -163,43 +539,27 @@ void Port::setDirty(bool d) {
 
 void Port::connect(Port& p) {
 	// test if the input is not connected already
-	if(p.node().network().connections().connectedFrom(p)) {
+	if(p.m_connectedFrom) {
 		std::stringstream msg;
 		msg << "Port " << node().name() << "/" << name() << " is already connected";
 
 		throw std::runtime_error(msg.str());
 	}
 
-	// test the recursivity
-	{
-		std::set<Port*> addedPorts;
-		addedPorts.insert(&p);
-
-		while(!addedPorts.empty()) {
-			// collect all connected ports
-			std::set<Port*> newAddedPorts;
-			for(auto& current : addedPorts) {
-				if(current->category() == Attr::kInput)
-					for(std::size_t i : current->node().metadata()->influences(current->m_id))
-						newAddedPorts.insert(&current->node().port(i));
-				else {
-					for(Port& i : current->node().network().connections().connectedTo(*current))
-						newAddedPorts.insert(&i);
-				}
-			}
-
-			if(newAddedPorts.find(this) != newAddedPorts.end()) {
-				std::stringstream msg;
-				msg << "A connection between " << node().name() << "/" << name() << " and " << p.node().name() << "/"
-				    << p.name() << " would cause a cyclical dependency";
-
-				throw(std::runtime_error(msg.str()));
-			}
+	// test the recursivity - only searches the ports between the two ends in the topological order
+	//   (invalid port categories are reported by Connections::add())
+	if(category() == Attr::kOutput && p.category() == Attr::kInput && !TopologicalOrder::insert(*this, p)) {
+		std::stringstream msg;
+		msg << "A connection between " << node().name() << "/" << name() << " and " << p.node().name() << "/"
+		    << p.name() << " would cause a cyclical dependency";
 
-			addedPorts = newAddedPorts;
-		}
+		throw(std::runtime_error(msg.str()));
 	}
 
+	doConnect(p);
+}
+
+void Port::doConnect(Port& p) {
 	// test for datatype
 	{
 		const unsigned voidCount = (type() == typeid(void)) + (p.type() == typeid(void));
@@ -311,8 +671,15 @@ void Port::disconnect(Port& p) {
 
 bool Port::isConnected() const {
 	// return true if there are no connections leading to/from this input/output port
-	return m_parent->hasParentNetwork() && (static_cast<bool>(m_parent->network().connections().connectedFrom(*this)) ||
-	                                        not m_parent->network().connections().connectedTo(*this).empty());
+	return m_connectedFrom != nullptr || not m_connectedTo.empty();
+}
+
+void Port::setPinned(bool pinned) {
+	m_pinned = pinned;
+}
+
+bool Port::isPinned() const {
+	return m_pinned;
 }
 
 void Port::linkTo(Port& targetPort) {
@@ -322,6 +689,8 @@ void Port::linkTo(Port& targetPort) {
 	m_linkedToPort = &targetPort;
 	targetPort.m_linkedFromPort = this;
 
+	node().graph().invalidateEvaluationPlans();
+
 	targetPort.node().markAsDirty(targetPort.index());
 }
 
@@ -338,6 +707,8 @@ void Port::unlink() {
 	m_linkedToPort->m_linkedFromPort = nullptr;
 	m_linkedToPort = nullptr;
 
+	node().graph().invalidateEvaluationPlans();
+
 	node().markAsDirty(index());
 }
 
@@ -1,11 +1,16 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <atomic>
 #include <boost/signals2.hpp>
+#include <mutex>
 #include <string>
 #include <typeindex>
+#include <vector>
 
 #include "attr.h"
+#include "data.h"
+#include "request.h"
 
 namespace dependency_graph {
 
@@ -29,7 +34,7 @@ class Port : public boost::noncopyable {
 	template <typename T>
 	void set(const T& value);
 
-	/// sets a value on the port.
+	/// sets a value on the port, moving an rvalue directly into the value holder.
 	/// Marks all downstream values dirty.
 	template <typename T>
 	void set(T&& value);
@@ -40,11 +45,36 @@ class Port : public boost::noncopyable {
 	template <typename T>
 	const T& get();
 
+	/// gets a value from the port, evaluated for a request (see getData(const Request&))
+	template <typename T>
+	const T& get(const Request& request);
+
 	/// gets a value from the port.
 	/// Pulls on the inputs and causes recomputation if the value is
 	/// marked as dirty.
+	///
+	/// Concurrency model - values can be pulled from any number of threads concurrently, as long as
+	/// the graph is not modified at the same time (no value changes, connections, node changes or
+	/// loading of deferred networks; see Network::load()). Each dirty output is computed only once -
+	/// its evaluation runs under a per-output lock, and threads waiting for the lock reuse the result.
+	/// The computes of the outputs of a single node are serialized by a per-node compute lock, and
+	/// input values are assigned under a per-node values lock. The returned reference stays valid until
+	/// the next modification of the graph, or until the value is evicted by a MemoryGovernor
+	/// (which never happens while any other pull is running).
 	const Data& getData();
 
+	/// gets a value from the port, evaluated for a request (a region of interest and a downscale level).
+	/// Nodes flagged with Metadata::kSupportsRequests compute only the requested part of their result,
+	/// with their inputs evaluated for the same request, while other nodes compute their full result.
+	/// Values evaluated for a request not covering the requested one are recomputed without invalidating
+	/// their downstream, or reused from a small per-port cache of results of previous requests.
+	/// Unlike getData(), pulls with a request can't run concurrently with other pulls.
+	const Data& getData(const Request& request);
+
+	/// returns the request the current value of this port was evaluated for (a full request for all values
+	/// not computed by nodes supporting requests)
+	const Request& request() const;
+
 	/// sets a value on the port.
 	/// Marks all downstream values dirty.
 	void setData(const Data& val);
@@ -52,6 +82,18 @@ class Port : public boost::noncopyable {
 	/// returns true if given port is dirty and will require recomputation
 	bool isDirty() const;
 
+	/// loads all networks with a deferred load in the dirty upstream of this port (see Network::load()).
+	/// Pulls never load networks - this has to be called explicitly on the main thread before an
+	/// evaluation (e.g., before drawing). A pulled output of a network that is not loaded evaluates to
+	/// its default value, with the network in an error state - such a network is loaded by the next call,
+	/// on any port of its graph. Returns this port, or its replacement if the loading recreated the ports
+	/// of its node.
+	Port& loadDeferredNetworks();
+
+	/// returns the version of the current value of this port. A new version is assigned
+	/// on each value change, and equal versions guarantee equal values.
+	std::size_t version() const;
+
 	/// returns a reference to the parent node
 	NodeBase& node();
 	/// returns a reference to the parent node
@@ -68,6 +110,11 @@ class Port : public boost::noncopyable {
 	/// returns true if this port is connected to anything
 	bool isConnected() const;
 
+	/// pins a port - the value of a pinned port (or of an output connected to a pinned input) is
+	/// never evicted by the graph's MemoryGovernor (e.g., values displayed in a viewport)
+	void setPinned(bool pinned);
+	bool isPinned() const;
+
 	/// adds a "value changed" callback - to be used by the UI
 	boost::signals2::connection valueCallback(const std::function<void()>& fn);
 	/// adds a "flags changed" callback - to be used by the UI
@@ -92,17 +139,96 @@ class Port : public boost::noncopyable {
 
 	void setDirty(bool dirty);
 
+	// transfers the value of the linked source port, including its version
+	void setLinkedData();
+	// runs the callbacks and dirtiness propagation after a value change
+	void valueChanged(bool valueWasSet);
+
+	// early cutoff - records the versions of this output and its influencing inputs after a compute
+	void setComputedFrom(const std::vector<std::size_t>& inputs);
+	// early cutoff - returns true if this output and all its influencing inputs have the recorded versions
+	bool isComputedFrom(const std::vector<std::size_t>& inputs) const;
+
+	// creates a connection already tested for cycles (the remaining tests are run here)
+	void doConnect(Port& p);
+
+	// requests - marks the ports in the upstream holding values evaluated for requests not covering the
+	//   requested one as dirty (without invalidating their downstream), and assigns the requests
+	//   their dirty upstream is going to be evaluated for
+	void prepareRequest(const Request& request);
+	// requests - stores the current value of an output in the request cache
+	void cacheRequest();
+	// requests - replaces the current value of an output with a cached value evaluated for a covering
+	//   request (returns false if there is none)
+	bool restoreRequest(const Request& request);
+	// requests - assigns the request of the value or of the pending evaluation, counting partial requests
+	void setRequest(Request& target, const Request& request);
+	// true if the current thread evaluates a pull (values changed by a pull are evaluated for a different
+	//   request, but don't invalidate the cached values of other requests)
+	static bool isPulling();
+
+	// the request of the compute running on the current thread, assigned to all values it sets
+	class ScopedRequest : public boost::noncopyable {
+	  public:
+		ScopedRequest(const Request& request);
+		~ScopedRequest();
+
+	  private:
+		const Request* m_previous;
+	};
+
 	NodeBase* m_parent;
 	unsigned m_id;
-	bool m_dirty;
+	// atomic - read by concurrent pulls without any locking (see NodeBase::computeOutput())
+	std::atomic<bool> m_dirty;
+	// concurrent pulls - held during the evaluation of this output, including its upstream
+	std::recursive_mutex m_evaluationMutex;
+	// position of this port in the graph's current dirty batch (or -1 if its dirty flag change is not recorded)
+	std::size_t m_dirtyBatchPosition;
+	// position of this port in the deferred dirtiness of the graph's current bulk build (or -1 if not deferred)
+	std::size_t m_dirtyDeferredPosition;
+
+	// memory governor - true if the value of this port was evicted (dirty, but its dependants
+	// don't have to be), true if the value size is tracked, and the "time" of the last pull
+	bool m_evicted, m_pinned, m_memoryTracked;
+	mutable std::atomic<std::size_t> m_lastPulled;
 
 	Port* m_linkedToPort;
 	Port* m_linkedFromPort;
 
+	// connections adjacency - input ports can be connected to a single output,
+	//   output ports can be connected to any number of inputs
+	Port* m_connectedFrom;
+	std::vector<Port*> m_connectedTo;
+
+	// index in the incremental topological order of all ports (see TopologicalOrder)
+	std::size_t m_order;
+
+	// early cutoff - versions of the value and of influencing inputs after the last compute
+	std::size_t m_computedVersion;
+	std::vector<std::size_t> m_computedInputVersions;
+
+	// requests - the request the value was evaluated for, the request of the pending evaluation, and
+	//   values of previous requests (outputs only)
+	Request m_request, m_pendingRequest;
+
+	struct CachedRequest {
+		Request request;
+		Data value;
+		std::size_t version;
+	};
+	std::vector<CachedRequest> m_requestCache;
+
 	boost::signals2::signal<void()> m_valueCallbacks, m_flagsCallbacks;
 
 	friend class Node;
 	friend class NodeBase;
+	friend class EvaluationPlan;
+	friend class Connections;
+	friend class Graph;
+	friend class AsyncEvaluation;
+	friend class MemoryGovernor;
+	friend class TopologicalOrder;
 };
 
 }  // namespace dependency_graph
@@ -13,7 +13,7 @@ void Port::set(const T& value) {
 
 template <typename T>
 void Port::set(T&& value) {
-	setData(dependency_graph::Data(std::move(value)));
+	setData(dependency_graph::Data(std::forward<T>(value)));
 }
 
 template <typename T>
@@ -21,4 +21,9 @@ const T& Port::get() {
 	return getData().get<T>();
 }
 
+template <typename T>
+const T& Port::get(const Request& request) {
+	return getData(request).get<T>();
+}
+
 }  // namespace dependency_graph
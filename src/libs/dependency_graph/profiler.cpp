@@ -0,0 +1,112 @@
+#include "profiler.h"
+
+#include <iomanip>
+#include <map>
+
+#include "node_base.h"
+#include "port.h"
+
+namespace dependency_graph {
+
+namespace {
+
+/// writes a JSON-escaped string, including the quotes
+void writeString(std::ostream& out, const std::string& str) {
+	out << '"';
+
+	for(const char& c : str) {
+		if(c == '"' || c == '\\')
+			out << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20)
+			out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+		else
+			out << c;
+	}
+
+	out << '"';
+}
+
+double microseconds(std::chrono::steady_clock::duration d) {
+	return std::chrono::duration<double, std::micro>(d).count();
+}
+
+}  // namespace
+
+Profiler::Profiler() : m_start(std::chrono::steady_clock::now()) {
+}
+
+void Profiler::record(Event::Kind kind, const Port& port, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::duration pull, std::chrono::steady_clock::duration compute,
+                      bool errored) {
+	Event e;
+	e.kind = kind;
+	e.port = port.fullName();
+	e.nodeType = port.node().metadata()->type();
+	e.thread = std::this_thread::get_id();
+	e.start = start;
+	e.pull = pull;
+	e.compute = compute;
+	e.size = 0;
+	e.errored = errored;
+
+	const Datablock& data = port.node().datablock();
+	if(!data.isNull(port.index()))
+		e.size = data.data(port.index()).size();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_events.push_back(std::move(e));
+}
+
+std::vector<Profiler::Event> Profiler::events() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_events;
+}
+
+void Profiler::clear() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_events.clear();
+	m_start = std::chrono::steady_clock::now();
+}
+
+void Profiler::writeChromeTrace(std::ostream& out) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// threads are numbered in the order of their first event
+	std::map<std::thread::id, unsigned> threads;
+	for(auto& e : m_events)
+		threads.insert(std::make_pair(e.thread, threads.size() + 1));
+
+	out << "{\"traceEvents\":[" << std::endl;
+
+	bool first = true;
+	for(auto& t : threads) {
+		if(!first)
+			out << "," << std::endl;
+		first = false;
+
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t.second
+		    << ",\"args\":{\"name\":\"thread " << t.second << "\"}}";
+	}
+
+	for(auto& e : m_events) {
+		if(!first)
+			out << "," << std::endl;
+		first = false;
+
+		out << "{\"name\":";
+		writeString(out, e.port);
+		out << ",\"cat\":\"" << (e.kind == Event::kCompute ? "compute" : "input") << "\"";
+		out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threads[e.thread];
+		out << ",\"ts\":" << microseconds(e.start - m_start);
+		out << ",\"dur\":" << microseconds(e.pull + e.compute);
+		out << ",\"args\":{\"node_type\":";
+		writeString(out, e.nodeType);
+		out << ",\"pull_us\":" << microseconds(e.pull) << ",\"compute_us\":" << microseconds(e.compute)
+		    << ",\"size\":" << e.size << ",\"errored\":" << (e.errored ? "true" : "false") << "}}";
+	}
+
+	out << std::endl << "]}" << std::endl;
+}
+
+}  // namespace dependency_graph
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dependency_graph {
+
+class Port;
+
+/// Records the timings of all port evaluations in a graph (see Graph::setProfiler()). Each
+/// evaluated output records the time spent pulling on its inputs (including the evaluation of
+/// the whole upstream), the time of the compute itself and the size of the resulting value.
+/// All methods are thread-safe.
+class Profiler : public boost::noncopyable {
+  public:
+	struct Event {
+		enum Kind {
+			kCompute,  //< compute of an output port
+			kInput     //< transfer of a value from an output to a connected input
+		};
+
+		Kind kind;
+		std::string port;      //< full name of the evaluated port
+		std::string nodeType;  //< metadata type of the port's node
+		std::thread::id thread;
+
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::duration pull;     //< time spent evaluating the inputs
+		std::chrono::steady_clock::duration compute;  //< time spent in the compute (or the value transfer)
+
+		std::size_t size;  //< approximate size of the resulting value in bytes
+		bool errored;
+	};
+
+	Profiler();
+
+	/// records an evaluation of a port
+	void record(Event::Kind kind, const Port& port, std::chrono::steady_clock::time_point start,
+	            std::chrono::steady_clock::duration pull, std::chrono::steady_clock::duration compute,
+	            bool errored = false);
+
+	/// returns all recorded events, in the order of their completion
+	std::vector<Event> events() const;
+	/// removes all recorded events
+	void clear();
+
+	/// writes all recorded events in the Chrome trace event JSON format (readable by
+	/// chrome://tracing or Perfetto)
+	void writeChromeTrace(std::ostream& out) const;
+
+  private:
+	mutable std::mutex m_mutex;
+	std::vector<Event> m_events;
+
+	std::chrono::steady_clock::time_point m_start;
+};
+
+}  // namespace dependency_graph
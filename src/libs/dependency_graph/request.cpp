@@ -0,0 +1,83 @@
+#include "request.h"
+
+#include <cassert>
+
+namespace dependency_graph {
+
+Request::Request() : m_x(0), m_y(0), m_width(0), m_height(0), m_level(0) {
+}
+
+Request::Request(unsigned level) : m_x(0), m_y(0), m_width(0), m_height(0), m_level(level) {
+}
+
+Request::Request(int x, int y, int width, int height, unsigned level)
+    : m_x(x), m_y(y), m_width(width), m_height(height), m_level(level) {
+	assert(width > 0 && height > 0);
+}
+
+bool Request::isFull() const {
+	return !hasRegion() && m_level == 0;
+}
+
+bool Request::hasRegion() const {
+	return m_width > 0;
+}
+
+int Request::x() const {
+	return m_x;
+}
+
+int Request::y() const {
+	return m_y;
+}
+
+int Request::width() const {
+	return m_width;
+}
+
+int Request::height() const {
+	return m_height;
+}
+
+unsigned Request::level() const {
+	return m_level;
+}
+
+float Request::scale() const {
+	return 1.0f / (float)(1u << m_level);
+}
+
+bool Request::covers(const Request& r) const {
+	if(m_level > r.m_level)
+		return false;
+
+	if(!hasRegion())
+		return true;
+
+	if(!r.hasRegion())
+		return false;
+
+	return m_x <= r.m_x && m_y <= r.m_y && m_x + m_width >= r.m_x + r.m_width &&
+	       m_y + m_height >= r.m_y + r.m_height;
+}
+
+bool Request::operator==(const Request& r) const {
+	return m_x == r.m_x && m_y == r.m_y && m_width == r.m_width && m_height == r.m_height && m_level == r.m_level;
+}
+
+bool Request::operator!=(const Request& r) const {
+	return !(*this == r);
+}
+
+std::ostream& operator<<(std::ostream& out, const Request& r) {
+	if(r.hasRegion())
+		out << "(" << r.x() << ", " << r.y() << ", " << r.width() << "x" << r.height() << ")";
+	else
+		out << "(full)";
+
+	out << " @ level " << r.level();
+
+	return out;
+}
+
+}  // namespace dependency_graph
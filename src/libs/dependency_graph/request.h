@@ -0,0 +1,49 @@
+#pragma once
+
+#include <iostream>
+
+namespace dependency_graph {
+
+/// A request context of a pull (see Port::getData()) - an optional region of interest in the pixels of
+/// the full-resolution result, and a downscale level (each level halves the resolution). Passed to
+/// the computes of nodes flagged with Metadata::kSupportsRequests via Values::request(), allowing them
+/// to compute only the required part of their result. A default-constructed request is a request
+/// for the full result.
+class Request {
+  public:
+	/// a request for the full result
+	Request();
+	/// a request for the whole result at a downscale level
+	explicit Request(unsigned level);
+	/// a request for a region of the result at a downscale level
+	Request(int x, int y, int width, int height, unsigned level = 0);
+
+	/// returns true for a request of the full result (no region, full resolution)
+	bool isFull() const;
+	/// returns false for a request of the whole result
+	bool hasRegion() const;
+
+	int x() const;
+	int y() const;
+	int width() const;
+	int height() const;
+
+	unsigned level() const;
+	/// returns the scaling factor of the downscale level (1 / 2^level)
+	float scale() const;
+
+	/// returns true if a result evaluated for this request can be used for another request - it
+	/// contains the other request's region, at the same or higher resolution
+	bool covers(const Request& r) const;
+
+	bool operator==(const Request& r) const;
+	bool operator!=(const Request& r) const;
+
+  private:
+	int m_x, m_y, m_width, m_height;
+	unsigned m_level;
+};
+
+std::ostream& operator<<(std::ostream& out, const Request& r);
+
+}  // namespace dependency_graph
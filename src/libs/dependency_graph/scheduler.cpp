@@ -0,0 +1,173 @@
+#include "scheduler.h"
+
+#include <tbb/task_group.h>
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include "async_evaluation.h"
+#include "evaluation_plan.h"
+#include "graph.h"
+#include "node_base.inl"
+
+namespace dependency_graph {
+
+namespace {
+
+/// a single scheduled evaluation of a dirty plan step
+struct Task {
+	Task(std::size_t s, const Port& p)
+	    : step(s), pending(0), mainThread(p.node().metadata()->flags() & Metadata::kMainThreadOnly) {
+	}
+
+	std::size_t step;
+	std::vector<Task*> dependants;
+	std::atomic<unsigned> pending;
+	bool mainThread;
+};
+
+}  // namespace
+
+class Scheduler::Evaluation : public boost::noncopyable {
+  public:
+	Evaluation(const EvaluationPlan& plan);
+
+	void run();
+
+	bool empty() const {
+		return m_tasks.empty();
+	}
+
+  private:
+	void schedule(Task* t);
+	void execute(Task* t);
+
+	const EvaluationPlan& m_plan;
+
+	std::vector<std::unique_ptr<Task>> m_tasks;
+
+	tbb::task_group m_group;
+
+	std::mutex m_mutex;
+	std::deque<Task*> m_mainThreadQueue;
+	std::atomic<std::size_t> m_remaining;
+	std::exception_ptr m_error;
+
+	// the asynchronous evaluation of the calling thread, made current on the worker threads as well
+	AsyncEvaluation* m_async;
+};
+
+Scheduler::Evaluation::Evaluation(const EvaluationPlan& plan)
+    : m_plan(plan), m_remaining(0), m_async(AsyncEvaluation::current()) {
+	// one task per dirty step - steps are topologically sorted, so all dependencies
+	// already have their tasks when a step is processed
+	std::vector<Task*> tasks(plan.size(), nullptr);
+	const std::vector<bool> required = plan.requiredSteps();
+
+	for(std::size_t s = 0; s < plan.size(); ++s) {
+		const Port& port = *plan[s].port;
+
+		// clean steps don't need any evaluation (and neither does the dirty upstream of clean steps,
+		// left by evicted values)
+		if(required[s]) {
+			m_tasks.push_back(std::unique_ptr<Task>(new Task(s, port)));
+			Task* task = m_tasks.back().get();
+			tasks[s] = task;
+
+			for(auto d = plan.dependenciesBegin(s); d != plan.dependenciesEnd(s); ++d)
+				if(tasks[*d] != nullptr) {
+					tasks[*d]->dependants.push_back(task);
+					++task->pending;
+				}
+		}
+	}
+}
+
+void Scheduler::Evaluation::schedule(Task* t) {
+	if(t->mainThread) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_mainThreadQueue.push_back(t);
+	}
+	else
+		m_group.run([this, t]() { execute(t); });
+}
+
+void Scheduler::Evaluation::execute(Task* t) {
+	EvaluationPlan::ScopedEvaluation guard;
+	AsyncEvaluation::Scope async(m_async);
+
+	bool errored = false;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		errored = m_error != nullptr;
+	}
+
+	// after an error, the remaining tasks are only "drained" without evaluation,
+	// and the error is rethrown on the calling thread
+	if(!errored) {
+		try {
+			AsyncEvaluation::checkCancelled();
+
+			// outputs of a single node are never computed concurrently (see NodeBase::computeOutput())
+			m_plan.evaluate(t->step);
+		}
+		catch(...) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if(m_error == nullptr)
+				m_error = std::current_exception();
+		}
+	}
+
+	for(Task* d : t->dependants)
+		if(--d->pending == 0)
+			schedule(d);
+
+	--m_remaining;
+}
+
+void Scheduler::Evaluation::run() {
+	m_remaining = m_tasks.size();
+
+	// start with all tasks without any dependencies
+	std::vector<Task*> initial;
+	for(auto& t : m_tasks)
+		if(t->pending == 0)
+			initial.push_back(t.get());
+	for(auto& t : initial)
+		schedule(t);
+
+	// alternate between waiting for the worker tasks (the calling thread participates
+	// in their evaluation) and evaluating the tasks pinned to the calling thread
+	while(true) {
+		m_group.wait();
+
+		std::deque<Task*> mainThreadTasks;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			mainThreadTasks.swap(m_mainThreadQueue);
+		}
+
+		if(mainThreadTasks.empty())
+			break;
+
+		for(Task* t : mainThreadTasks)
+			execute(t);
+	}
+
+	assert(m_remaining == 0);
+
+	if(m_error != nullptr)
+		std::rethrow_exception(m_error);
+}
+
+void Scheduler::run(const EvaluationPlan& plan) {
+	Evaluation eval(plan);
+
+	if(!eval.empty())
+		eval.run();
+}
+
+}  // namespace dependency_graph
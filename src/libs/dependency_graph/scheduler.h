@@ -0,0 +1,24 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+namespace dependency_graph {
+
+class EvaluationPlan;
+
+/// Parallel evaluation of the dirty steps of an evaluation plan. The dirty steps are
+/// run as TBB tasks in dependency order - each step is evaluated only after all steps
+/// it depends on are up to date, which makes computes of independent upstream branches
+/// run concurrently. Nodes flagged as Metadata::kMainThreadOnly are always computed on
+/// the calling thread.
+class Scheduler : public boost::noncopyable {
+  public:
+	/// evaluates all dirty steps of an evaluation plan. Rethrows the first exception
+	/// thrown during the evaluation.
+	static void run(const EvaluationPlan& plan);
+
+  private:
+	class Evaluation;
+};
+
+}  // namespace dependency_graph
@@ -0,0 +1,254 @@
+#include "topological_order.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "network.h"
+#include "port.h"
+
+namespace dependency_graph {
+
+void TopologicalOrder::assign(std::vector<Port>& ports) {
+	static std::atomic<std::size_t> s_counter(0);
+
+	// influences always lead from inputs to outputs
+	for(Port& p : ports)
+		if(p.category() == Attr::kInput)
+			p.m_order = ++s_counter;
+
+	for(Port& p : ports)
+		if(p.category() != Attr::kInput)
+			p.m_order = ++s_counter;
+}
+
+void TopologicalOrder::successors(Port& p, std::vector<Port*>& result) {
+	if(p.category() == Attr::kInput) {
+		for(std::size_t i : p.node().metadata()->influences(p.index()))
+			result.push_back(&p.node().port(i));
+	}
+	else
+		result.insert(result.end(), p.m_connectedTo.begin(), p.m_connectedTo.end());
+}
+
+void TopologicalOrder::predecessors(Port& p, std::vector<Port*>& result) {
+	if(p.category() == Attr::kInput) {
+		if(p.m_connectedFrom)
+			result.push_back(p.m_connectedFrom);
+	}
+	else
+		for(std::size_t i : p.node().metadata()->influencedBy(p.index()))
+			result.push_back(&p.node().port(i));
+}
+
+bool TopologicalOrder::insert(Port& src, Port& dest) {
+	assert(&src != &dest);
+
+	// an edge agreeing with the order keeps it valid
+	const std::size_t lower = dest.m_order;
+	const std::size_t upper = src.m_order;
+	if(lower > upper)
+		return true;
+
+	std::vector<Port*> forward, backward, stack, adjacent;
+	std::unordered_set<Port*> visited;
+
+	// forward search from the target, limited to the affected region - reaching the source means a cycle
+	stack.push_back(&dest);
+	visited.insert(&dest);
+	while(!stack.empty()) {
+		Port* current = stack.back();
+		stack.pop_back();
+		forward.push_back(current);
+
+		adjacent.clear();
+		successors(*current, adjacent);
+		for(Port* p : adjacent) {
+			if(p == &src)
+				return false;
+
+			if(p->m_order < upper && visited.insert(p).second)
+				stack.push_back(p);
+		}
+	}
+
+	// backward search from the source, limited to the affected region (can't meet the forward
+	// search - that would mean a cycle)
+	stack.push_back(&src);
+	visited.insert(&src);
+	while(!stack.empty()) {
+		Port* current = stack.back();
+		stack.pop_back();
+		backward.push_back(current);
+
+		adjacent.clear();
+		predecessors(*current, adjacent);
+		for(Port* p : adjacent)
+			if(p->m_order > lower && visited.insert(p).second)
+				stack.push_back(p);
+	}
+
+	// reuse the indices of both regions - the backward region goes first, the forward region after,
+	//   each keeping its relative order
+	auto byOrder = [](const Port* p1, const Port* p2) { return p1->m_order < p2->m_order; };
+	std::sort(forward.begin(), forward.end(), byOrder);
+	std::sort(backward.begin(), backward.end(), byOrder);
+
+	std::vector<std::size_t> indices;
+	indices.reserve(forward.size() + backward.size());
+	for(Port* p : backward)
+		indices.push_back(p->m_order);
+	for(Port* p : forward)
+		indices.push_back(p->m_order);
+	std::sort(indices.begin(), indices.end());
+
+	auto index = indices.begin();
+	for(Port* p : backward)
+		p->m_order = *(index++);
+	for(Port* p : forward)
+		p->m_order = *(index++);
+
+	return true;
+}
+
+TopologicalOrder::Edges::const_iterator TopologicalOrder::insert(const Edges& edges) {
+	// the affected region spans the ends of all edges that disagree with the current order
+	std::size_t lower = std::numeric_limits<std::size_t>::max();
+	std::size_t upper = 0;
+	for(auto& e : edges)
+		if(e.first->m_order > e.second->m_order) {
+			lower = std::min(lower, e.second->m_order);
+			upper = std::max(upper, e.first->m_order);
+		}
+
+	// all edges agree with the order - no cycle is possible
+	if(lower > upper)
+		return edges.end();
+
+	// collect all ports of the network within the affected region. Any cycle has to be within
+	//   the region - the order is only decreasing along the disagreeing edges.
+	Network& network = edges.front().first->node().network();
+
+	std::unordered_map<Port*, std::size_t> inDegree;
+	std::vector<Port*> region;
+	for(NodeBase& n : network.nodes())
+		for(std::size_t pi = 0; pi < n.portCount(); ++pi) {
+			Port& p = n.port(pi);
+			if(p.m_order >= lower && p.m_order <= upper) {
+				region.push_back(&p);
+				inDegree.insert(std::make_pair(&p, 0));
+			}
+		}
+
+	// successors within the region, including the new edges
+	std::unordered_multimap<Port*, Port*> added, addedFrom;
+	for(auto& e : edges) {
+		assert(&e.first->node().network() == &network && &e.second->node().network() == &network);
+		added.insert(std::make_pair(e.first, e.second));
+		addedFrom.insert(std::make_pair(e.second, e.first));
+	}
+
+	auto regionSuccessors = [&](Port& p, std::vector<Port*>& result) {
+		result.clear();
+		successors(p, result);
+
+		auto range = added.equal_range(&p);
+		for(auto it = range.first; it != range.second; ++it)
+			result.push_back(it->second);
+
+		result.erase(std::remove_if(result.begin(), result.end(), [&](Port* s) { return inDegree.count(s) == 0; }),
+		             result.end());
+	};
+
+	std::vector<Port*> adjacent;
+	for(Port* p : region) {
+		regionSuccessors(*p, adjacent);
+		for(Port* s : adjacent)
+			++inDegree[s];
+	}
+
+	// Kahn's sort of the region
+	std::vector<Port*> sorted, stack;
+	sorted.reserve(region.size());
+	for(Port* p : region)
+		if(inDegree[p] == 0)
+			stack.push_back(p);
+
+	while(!stack.empty()) {
+		Port* current = stack.back();
+		stack.pop_back();
+		sorted.push_back(current);
+
+		regionSuccessors(*current, adjacent);
+		for(Port* s : adjacent)
+			if(--inDegree[s] == 0)
+				stack.push_back(s);
+	}
+
+	// unsorted ports are on a cycle, or downstream of one
+	if(sorted.size() != region.size()) {
+		// peel off the ports only downstream of a cycle (in reverse), leaving the ports on cycles
+		std::unordered_map<Port*, std::size_t> outDegree;
+		for(Port* p : region)
+			if(inDegree[p] > 0)
+				outDegree.insert(std::make_pair(p, 0));
+
+		for(auto& o : outDegree) {
+			regionSuccessors(*o.first, adjacent);
+			for(Port* s : adjacent)
+				if(outDegree.count(s) > 0)
+					++o.second;
+		}
+
+		for(auto& o : outDegree)
+			if(o.second == 0)
+				stack.push_back(o.first);
+
+		while(!stack.empty()) {
+			Port* current = stack.back();
+			stack.pop_back();
+
+			adjacent.clear();
+			predecessors(*current, adjacent);
+			auto range = addedFrom.equal_range(current);
+			for(auto it = range.first; it != range.second; ++it)
+				adjacent.push_back(it->second);
+
+			for(Port* p : adjacent) {
+				auto it = outDegree.find(p);
+				if(it != outDegree.end() && it->second > 0 && --it->second == 0)
+					stack.push_back(p);
+			}
+		}
+
+		// each cycle contains at least one of the new edges
+		auto onCycle = [&](Port* p) {
+			auto it = outDegree.find(p);
+			return it != outDegree.end() && it->second > 0;
+		};
+
+		for(auto it = edges.begin(); it != edges.end(); ++it)
+			if(onCycle(it->first) && onCycle(it->second))
+				return it;
+
+		assert(false && "a cycle has to contain one of the new edges");
+		return edges.begin();
+	}
+
+	// reuse the indices of the region in the new order
+	std::vector<std::size_t> indices;
+	indices.reserve(region.size());
+	for(Port* p : region)
+		indices.push_back(p->m_order);
+	std::sort(indices.begin(), indices.end());
+
+	for(std::size_t i = 0; i < sorted.size(); ++i)
+		sorted[i]->m_order = indices[i];
+
+	return edges.end();
+}
+
+}  // namespace dependency_graph
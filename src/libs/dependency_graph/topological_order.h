@@ -0,0 +1,45 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace dependency_graph {
+
+class Port;
+
+/// Incremental topological order of ports (Pearce-Kelly). Each port holds an order index, maintained
+/// such that the source of each influence (input -> output of a node) and of each connection
+/// (output -> input) has a lower index than its target. A connection that agrees with the order
+/// can't introduce a cycle and needs no search at all; any other connection only searches the
+/// ports with indices between its two ends (the "affected region"), and reorders them.
+///
+/// Disconnecting never invalidates the order. Used by Port::connect() and Connections::connect()
+/// for cycle detection; not intended to be used directly.
+class TopologicalOrder {
+  public:
+	typedef std::vector<std::pair<Port*, Port*>> Edges;
+
+	/// assigns new indices to the ports of a newly created node (all inputs before all outputs),
+	/// higher than any index assigned before
+	static void assign(std::vector<Port>& ports);
+
+	/// updates the order for a new edge src -> dest. Returns false, without changing the
+	/// order, if the new edge would create a cycle.
+	static bool insert(Port& src, Port& dest);
+
+	/// updates the order for a batch of new edges of a single network at once - a single sort of
+	/// the network's ports with indices between the ends of the edges disagreeing with the order.
+	/// Returns an iterator to an edge on a cycle (without changing the order), or edges.end()
+	/// if the batch is acyclic.
+	static Edges::const_iterator insert(const Edges& edges);
+
+  private:
+	TopologicalOrder() = delete;
+
+	/// collects the direct successors of a port - influenced outputs or connected inputs
+	static void successors(Port& p, std::vector<Port*>& result);
+	/// collects the direct predecessors of a port - influencing inputs or the connected output
+	static void predecessors(Port& p, std::vector<Port*>& result);
+};
+
+}  // namespace dependency_graph
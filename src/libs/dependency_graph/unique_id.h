@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <iostream>
 
 namespace dependency_graph {
@@ -24,8 +25,20 @@ class UniqueId {
 	std::size_t m_id;
 
 	friend std::ostream& operator<<(std::ostream& out, const UniqueId& id);
+	friend struct std::hash<UniqueId>;
 };
 
 std::ostream& operator<<(std::ostream& out, const UniqueId& id);
 
 }  // namespace dependency_graph
+
+namespace std {
+
+template <>
+struct hash<dependency_graph::UniqueId> {
+	std::size_t operator()(const dependency_graph::UniqueId& id) const {
+		return id.m_id;
+	}
+};
+
+}  // namespace std
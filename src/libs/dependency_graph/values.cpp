@@ -1,15 +1,19 @@
 #include "values.h"
 
+#include "async_evaluation.h"
+#include "graph.h"
+
 namespace dependency_graph {
 
-Values::Values(NodeBase& n) : m_node(&n) {
+Values::Values(NodeBase& n, const Request& request) : m_node(&n), m_request(request) {
 }
 
-Values::Values(Values&& vals) : m_node(vals.m_node) {
+Values::Values(Values&& vals) : m_node(vals.m_node), m_request(vals.m_request) {
 }
 
 Values& Values::operator=(Values&& vals) {
 	m_node = vals.m_node;
+	m_request = vals.m_request;
 
 	return *this;
 }
@@ -18,6 +22,18 @@ void Values::copy(const InAttr<void>& inAttr, const OutAttr<void>& outAttr) {
 	m_node->port(outAttr.offset()).setData(m_node->port(inAttr.offset()).getData());
 }
 
+const Request& Values::request() const {
+	return m_request;
+}
+
+bool Values::isCancelled() const {
+	return AsyncEvaluation::cancelled();
+}
+
+void Values::checkCancelled() const {
+	AsyncEvaluation::checkCancelled();
+}
+
 const Data& Values::data(std::size_t index) const {
 	return m_node->port(index).getData();
 }
@@ -26,4 +42,8 @@ void Values::setData(std::size_t index, const Data& data) {
 	m_node->port(index).setData(data);
 }
 
+std::shared_ptr<MemoryGovernor> Values::memoryGovernor() const {
+	return m_node->graph().memoryGovernor();
+}
+
 }  // namespace dependency_graph
@@ -3,12 +3,15 @@
 #include <boost/noncopyable.hpp>
 
 #include "node.h"
+#include "request.h"
 
 namespace dependency_graph {
 
+class MemoryGovernor;
+
 class Values : public boost::noncopyable {
   public:
-	Values(NodeBase& n);
+	Values(NodeBase& n, const Request& request = Request());
 
 	Values(Values&& vals);
 
@@ -44,16 +47,37 @@ class Values : public boost::noncopyable {
 	/// (useful for switch nodes, for example)
 	void copy(const InAttr<void>& inAttr, const OutAttr<void>& outAttr);
 
+	/// passes the value of an input to an output without copying it - the output shares
+	/// the input's value holder
+	template <typename T>
+	void copy(const InAttr<T>& inAttr, const OutAttr<T>& outAttr);
+
 	/// untyped attribute type testing.
 	/// Only useful for untyped attributes - typed attribute have an explicit T
 	template <typename T>
 	bool is(const TypedAttr<void>& attr) const;
 
+	/// returns the request this compute evaluates its outputs for - nodes flagged with
+	/// Metadata::kSupportsRequests can compute only the requested part of their result (see Port::getData()),
+	/// other nodes always receive a full request
+	const Request& request() const;
+
+	/// returns true if the asynchronous evaluation running this compute was cancelled
+	/// (can be polled from long-running computes, see Graph::evaluateAsync())
+	bool isCancelled() const;
+	/// throws EvaluationCancelled if the asynchronous evaluation running this compute was cancelled
+	void checkCancelled() const;
+
 	const Data& data(std::size_t index) const;
 	void setData(std::size_t index, const Data& data);
 
+	/// returns the memory governor of the graph running this compute (or nullptr) - computes keeping
+	/// their own caches of values can report their size (see MemoryGovernor::setExternalUsage())
+	std::shared_ptr<MemoryGovernor> memoryGovernor() const;
+
   private:
 	NodeBase* m_node;
+	Request m_request;
 };
 
 }  // namespace dependency_graph
@@ -46,6 +46,11 @@ void Values::set(const OutAttr<void>& attr, const T& value) {
 	m_node->port(attr.offset()).set(value);
 }
 
+template <typename T>
+void Values::copy(const InAttr<T>& inAttr, const OutAttr<T>& outAttr) {
+	m_node->port(outAttr.offset()).setData(m_node->port(inAttr.offset()).getData());
+}
+
 template <typename T>
 bool Values::is(const TypedAttr<void>& attr) const {
 	return m_node->port(attr.offset()).type() == typeid(T);
@@ -1,6 +1,7 @@
 #include "app.h"
 
 #include <actions/actions.h>
+#include <actions/binary_scene.h>
 #include <dependency_graph/node.h>
 #include <possumwood_sdk/gl.h>
 #include <possumwood_sdk/metadata.h>
@@ -95,6 +96,9 @@ void App::newFile() {
 }
 
 dependency_graph::State App::loadFile(const nlohmann::json& json) {
+	// all dirtiness changes of the loading are reported as a single notification
+	dependency_graph::Graph::DirtyBatch dirtyBatch(graph());
+
 	// read the graph
 	graph().clear();
 	undoStack().clear();
@@ -148,15 +152,22 @@ dependency_graph::State App::loadFile(const nlohmann::json& json) {
 dependency_graph::State App::loadFile(const Filepath& filename, bool alterCurrentFilename) {
 	if(!filesystem().exists(filename))
 		throw std::runtime_error("Cannot open " + filename.toString() + " - file not found.");
-	// read the json file
 	auto in = filesystem().read(filename);
-	nlohmann::json json;
-	(*in) >> json;
 
 	// update the opened filename
 	if(alterCurrentFilename)
 		m_filename = filename;
 
+	// a binary scene - its values are read from the stream during the loading
+	if(BinarySceneReader::isBinaryScene(*in)) {
+		BinarySceneReader reader(*in);
+		return loadFile(reader.scene());
+	}
+
+	// read the json file
+	nlohmann::json json;
+	(*in) >> json;
+
 	const dependency_graph::State state = loadFile(json);
 
 	return state;
@@ -195,12 +206,25 @@ void App::saveFile(nlohmann::json& json, bool saveSceneConfig) {
 }
 
 void App::saveFile(const Filepath& fn, bool saveSceneConfig) {
-	nlohmann::json json;
-	saveFile(json, saveSceneConfig);
+	// binary scene - values with a binary serialization are stored outside of the json
+	if(BinarySceneReader::isBinarySceneFilename(fn.toString())) {
+		BinarySceneWriter writer;
+
+		nlohmann::json json;
+		saveFile(json, saveSceneConfig);
 
-	// save the json to the file
-	auto out = filesystem().write(fn);
-	(*out) << std::setw(4) << json;
+		auto out = filesystem().write(fn);
+		writer.write(*out, json);
+	}
+
+	else {
+		nlohmann::json json;
+		saveFile(json, saveSceneConfig);
+
+		// save the json to the file
+		auto out = filesystem().write(fn);
+		(*out) << std::setw(4) << json;
+	}
 
 	// and update the filename
 	m_filename = fn;
@@ -219,6 +243,24 @@ void App::draw(const possumwood::ViewportState& viewport,
                std::function<void(const dependency_graph::NodeBase&)> stateChangedCallback) {
 	GL_CHECK_ERR;
 
+	// networks with a deferred load in the upstream of the drawables are loaded before drawing (pulls never
+	//   load them, as the loading changes the graph) - repeated while the loading adds more drawables
+	std::size_t drawableCount = 0;
+	while(dependency_graph::Graph::hasDeferredNetworks()) {
+		std::vector<dependency_graph::NodeBase*> drawables;
+		for(auto it = graph().nodes().begin(dependency_graph::Nodes::kRecursive); it != graph().nodes().end(); ++it)
+			if(possumwood::Metadata::getDrawable(*it))
+				drawables.push_back(&(*it));
+
+		if(drawables.size() == drawableCount)
+			break;
+		drawableCount = drawables.size();
+
+		for(dependency_graph::NodeBase* n : drawables)
+			for(std::size_t p = 0; p < n->portCount(); ++p)
+				n->port(p).loadDeferredNetworks();
+	}
+
 	for(auto it = graph().nodes().begin(dependency_graph::Nodes::kRecursive); it != graph().nodes().end(); ++it) {
 		GL_CHECK_ERR;
 
@@ -245,14 +287,10 @@ void App::setTime(float time) {
 		m_time = time;
 		m_timeChanged(time);
 
-		// TERRIBLE HACK - a special node type that outputs time is handled here
-		for(dependency_graph::Nodes::iterator i = graph().nodes().begin(dependency_graph::Nodes::kRecursive);
-		    i != graph().nodes().end(); ++i) {
-			if(i->metadata()->type() == "time")
-				i->port(0).set<float>(time);
-			if(i->metadata()->type() == "frame")
-				i->port(0).set<unsigned>(time * possumwood::App::instance().sceneConfig()["fps"].as<float>());
-		}
+		// only the registered time source nodes (e.g., "time" and "frame") and their downstream are
+		//   invalidated - the time sources are re-evaluated from their own computes on the next pull,
+		//   and all dirtiness changes are reported as a single notification
+		graph().invalidateTimeSources();
 	}
 }
 
@@ -32,8 +32,10 @@ class App : public AppCore {
 	const Filepath& filename() const;
 
 	void newFile();
+	/// loads a scene, either in JSON (.psw) or binary (.pswb) format, detected from the file content
 	dependency_graph::State loadFile(const Filepath& fn, bool alterCurrentFilename = true);
 	void saveFile();
+	/// saves the scene, in the binary format (see BinarySceneWriter) for filenames with .pswb extension
 	void saveFile(const Filepath& fn, bool saveSceneConfig = true);
 
 	QMainWindow* mainWindow() const;
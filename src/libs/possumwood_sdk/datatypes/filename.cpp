@@ -1,5 +1,6 @@
 #include "filename.h"
 
+#include <actions/disk_cache.h>
 #include <possumwood_sdk/app.h>
 
 namespace possumwood {
@@ -62,6 +63,14 @@ void fromJson(const ::nlohmann::json& json, Filename& value) {
 	value.setFilename(json.get<std::string>());
 }
 
+/// the compute cache key of a filename includes the file's timestamp and size - a changed file
+///   invalidates all cached values computed from it
+std::string cacheKey(const Filename& value) {
+	return DiskCache::fileKey(value.filename());
+}
+
+CacheKey<Filename> s_cacheKey(&cacheKey);
+
 }  // namespace
 
 IO<Filename> Traits<Filename>::io(&toJson, &fromJson);
@@ -1,5 +1,6 @@
 #include "filenames.h"
 
+#include "actions/disk_cache.h"
 #include "possumwood_sdk/app.h"
 
 namespace possumwood {
@@ -91,6 +92,16 @@ void fromJson(const ::nlohmann::json& json, Filenames& value) {
 	}
 }
 
+/// the compute cache key of a set of filenames includes the files' timestamps and sizes
+std::string cacheKey(const Filenames& value) {
+	std::string result;
+	for(auto& f : value.filenames())
+		result += DiskCache::fileKey(f.toPath()) + ";";
+	return result;
+}
+
+CacheKey<Filenames> s_cacheKey(&cacheKey);
+
 }  // namespace
 
 IO<Filenames> Traits<Filenames>::io(&toJson, &fromJson);
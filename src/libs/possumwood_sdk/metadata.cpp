@@ -14,6 +14,12 @@ class PossumwoodNode : public dependency_graph::Node {
 		const possumwood::Metadata& meta = dynamic_cast<const possumwood::Metadata&>(def.metadata());
 
 		m_drawable = meta.createDrawable(dependency_graph::Values(*this));
+
+		// values displayed in the viewport are never evicted by the memory governor
+		if(m_drawable)
+			for(std::size_t p = 0; p < portCount(); ++p)
+				if(port(p).category() == dependency_graph::Attr::kInput)
+					port(p).setPinned(true);
 	}
 
 	boost::optional<Drawable&> drawable() const {
@@ -13,10 +13,12 @@ void init(possumwood::Metadata& meta) {
 
 		return dependency_graph::State();
 	});
+
+	meta.setFlags(dependency_graph::Metadata::kTimeSource);
 }
 
-/// This is a hack - "time" nodes have a single output, set by a callback in the
-/// possumwood SDK's App object
+/// "time" nodes have a single output, re-evaluated on each time change of the possumwood
+/// SDK's App object
 possumwood::NodeImplementation s_impl("time", init);
 
 }  // namespace
@@ -64,8 +64,9 @@ struct property_updater<T, DERIVED, typename std::enable_if<std::is_copy_constru
 		T value = port.get<T>();
 		// allow the UI to change it (or a part of it)
 		prop.get(value);
-		// and use action to apply it to a port (making it undoable)
-		possumwood::actions::setValue(port, std::move(value));
+		// and use action to apply it to a port (making it undoable - a series of quick changes, e.g., while
+		//   dragging a slider, is merged into a single undo step)
+		possumwood::actions::setValue(port, std::move(value), true);
 	}
 };
 
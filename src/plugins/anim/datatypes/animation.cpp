@@ -1,5 +1,7 @@
 #include "animation.h"
 
+#include <actions/binary.h>
+
 namespace anim {
 
 Animation::Animation(float fps) : m_fps(fps) {
@@ -82,3 +84,49 @@ std::ostream& operator<<(std::ostream& out, const Animation& anim) {
 }
 
 }  // namespace anim
+
+namespace {
+
+// all frames of an animation share the same hierarchy - it is stored only once, followed by the
+//   poses of all frames
+void writeBinary(std::ostream& out, const anim::Animation& anim) {
+	const float fps = anim.fps();
+	possumwood::binary::writeRaw(out, &fps, 1);
+	possumwood::binary::writeInt<std::uint64_t>(out, anim.size());
+
+	if(!anim.empty()) {
+		anim::writeBinary(out, anim.front());
+
+		for(auto it = anim.begin() + 1; it != anim.end(); ++it)
+			anim::writeBinaryPose(out, *it);
+	}
+}
+
+void readBinary(std::istream& in, anim::Animation& anim) {
+	float fps;
+	possumwood::binary::readRaw(in, &fps, 1);
+
+	anim::Animation result(fps);
+
+	const std::size_t count = possumwood::binary::readCount(in);
+	if(count > 0) {
+		anim::Skeleton skel;
+		anim::readBinary(in, skel);
+		result.addFrame(skel);
+
+		for(std::size_t f = 1; f < count; ++f) {
+			anim::readBinaryPose(in, skel);
+			result.addFrame(skel);
+		}
+	}
+
+	anim = std::move(result);
+}
+
+}  // namespace
+
+namespace possumwood {
+
+BinaryIO<anim::Animation> Traits<anim::Animation>::binaryIO(&writeBinary, &readBinary);
+
+}  // namespace possumwood
@@ -48,6 +48,8 @@ namespace possumwood {
 
 template <>
 struct Traits<anim::Animation> {
+	static BinaryIO<anim::Animation> binaryIO;
+
 	static constexpr std::array<float, 3> colour() {
 		return std::array<float, 3>{{0, 1.0, 0}};
 	}
@@ -1,5 +1,7 @@
 #include "frame_editor_data.h"
 
+#include <actions/binary.h>
+
 namespace anim {
 
 void FrameEditorData::setSkeleton(const Skeleton& s) {
@@ -82,10 +84,35 @@ void fromJson(const ::nlohmann::json& json, anim::FrameEditorData& value) {
 	}
 }
 
+// the same content as the json serialization (the skeleton is provided by the node's input), but
+//   including the full transformations
+void writeBinary(std::ostream& out, const anim::FrameEditorData& value) {
+	possumwood::binary::writeInt<std::uint64_t>(out, value.size());
+	for(auto& i : value) {
+		possumwood::binary::writeInt<std::uint64_t>(out, i.first);
+		anim::writeBinary(out, i.second);
+	}
+}
+
+void readBinary(std::istream& in, anim::FrameEditorData& value) {
+	value.clear();
+
+	const std::size_t count = possumwood::binary::readCount(in);
+	for(std::size_t i = 0; i < count; ++i) {
+		const std::size_t joint = possumwood::binary::readInt<std::uint64_t>(in);
+
+		anim::Transform tr;
+		anim::readBinary(in, tr);
+
+		value.setTransform(joint, tr);
+	}
+}
+
 }  // namespace
 
 namespace possumwood {
 
 IO<anim::FrameEditorData> Traits<anim::FrameEditorData>::io(&toJson, &fromJson);
+BinaryIO<anim::FrameEditorData> Traits<anim::FrameEditorData>::binaryIO(&writeBinary, &readBinary);
 
 }
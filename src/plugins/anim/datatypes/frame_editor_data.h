@@ -40,6 +40,7 @@ namespace possumwood {
 template <>
 struct Traits<anim::FrameEditorData> {
 	static IO<anim::FrameEditorData> io;
+	static BinaryIO<anim::FrameEditorData> binaryIO;
 
 	static constexpr std::array<float, 3> colour() {
 		return std::array<float, 3>{{0, 0.2, 0}};
@@ -1,5 +1,7 @@
 #include "skeleton.h"
 
+#include <actions/binary.h>
+
 #include <cassert>
 #include <iostream>
 
@@ -274,4 +276,128 @@ const Attributes& Skeleton::attributes() const {
 	return m_hierarchy->attributes();
 }
 
+///
+
+namespace {
+
+// type tags of the supported attribute types
+enum AttributeType { kEmpty = 0, kString = 1, kStringVector = 2 };
+
+void writeAttributes(std::ostream& out, const Attributes& attrs) {
+	std::size_t count = 0;
+	for(auto it = attrs.begin(); it != attrs.end(); ++it)
+		++count;
+	possumwood::binary::writeInt<std::uint64_t>(out, count);
+
+	for(auto& a : attrs) {
+		possumwood::binary::writeString(out, a.first);
+
+		if(a.second.empty())
+			possumwood::binary::writeInt<std::uint8_t>(out, kEmpty);
+
+		else if(a.second.is<std::string>()) {
+			possumwood::binary::writeInt<std::uint8_t>(out, kString);
+			possumwood::binary::writeString(out, a.second.as<std::string>());
+		}
+
+		else if(a.second.is<std::vector<std::string>>()) {
+			possumwood::binary::writeInt<std::uint8_t>(out, kStringVector);
+
+			const std::vector<std::string>& values = a.second.as<std::vector<std::string>>();
+			possumwood::binary::writeInt<std::uint64_t>(out, values.size());
+			for(auto& v : values)
+				possumwood::binary::writeString(out, v);
+		}
+
+		else
+			throw std::runtime_error("Binary serialization of skeleton attributes of type " + a.second.type() +
+			                         " is not supported.");
+	}
+}
+
+void readAttributes(std::istream& in, Attributes& attrs) {
+	const std::size_t count = possumwood::binary::readCount(in);
+	for(std::size_t i = 0; i < count; ++i) {
+		const std::string key = possumwood::binary::readString(in);
+
+		const unsigned type = possumwood::binary::readInt<std::uint8_t>(in);
+		if(type == kString)
+			attrs[key] = possumwood::binary::readString(in);
+
+		else if(type == kStringVector) {
+			std::vector<std::string> values(possumwood::binary::readCount(in));
+			for(auto& v : values)
+				v = possumwood::binary::readString(in);
+
+			attrs[key] = values;
+		}
+
+		else if(type != kEmpty)
+			throw std::runtime_error("Error reading a skeleton - unknown attribute type.");
+	}
+}
+
+}  // namespace
+
+void writeBinary(std::ostream& out, const Skeleton& skel) {
+	writeAttributes(out, skel.attributes());
+
+	// the hierarchy - joints are ordered with parents before their children
+	possumwood::binary::writeInt<std::uint64_t>(out, skel.size());
+	for(auto& j : skel) {
+		possumwood::binary::writeString(out, j.name());
+		possumwood::binary::writeInt<std::int64_t>(out, j.hasParent() ? (std::int64_t)j.parent().index() : -1);
+		writeAttributes(out, j.attributes());
+	}
+
+	writeBinaryPose(out, skel);
+}
+
+void readBinary(std::istream& in, Skeleton& skel) {
+	Skeleton result;
+	readAttributes(in, result.attributes());
+
+	const std::size_t count = possumwood::binary::readCount(in);
+	for(std::size_t i = 0; i < count; ++i) {
+		const std::string name = possumwood::binary::readString(in);
+		const std::int64_t parent = possumwood::binary::readInt<std::int64_t>(in);
+
+		// adding the joints in their original order reproduces the original indices (only single-root
+		//   hierarchies can be reproduced this way)
+		if(parent < 0) {
+			if(i != 0)
+				throw std::runtime_error("Error reading a skeleton - only skeletons with a single root are supported.");
+			result.addRoot(name, Transform());
+		}
+		else if(parent >= (std::int64_t)i || result.addChild(result[parent], Transform(), name) != i)
+			throw std::runtime_error("Error reading a skeleton - inconsistent joint order.");
+
+		readAttributes(in, result[i].attributes());
+	}
+
+	readBinaryPose(in, result);
+
+	skel = std::move(result);
+}
+
+void writeBinaryPose(std::ostream& out, const Skeleton& skel) {
+	possumwood::binary::writeInt<std::uint64_t>(out, skel.size());
+	for(auto& j : skel)
+		writeBinary(out, j.tr());
+}
+
+void readBinaryPose(std::istream& in, Skeleton& skel) {
+	if(possumwood::binary::readCount(in) != skel.size())
+		throw std::runtime_error("Error reading a skeleton pose - the number of joints doesn't match.");
+
+	for(auto& j : skel)
+		readBinary(in, j.tr());
+}
+
 }  // namespace anim
+
+namespace possumwood {
+
+BinaryIO<anim::Skeleton> Traits<anim::Skeleton>::binaryIO(&anim::writeBinary, &anim::readBinary);
+
+}  // namespace possumwood
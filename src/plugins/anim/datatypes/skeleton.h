@@ -115,12 +115,24 @@ class Skeleton {
 
 std::ostream& operator<<(std::ostream& out, const Skeleton& skel);
 
+/// binary serialization of a skeleton - its hierarchy with attributes (only string and string
+/// vector attributes are supported), followed by its pose
+void writeBinary(std::ostream& out, const Skeleton& skel);
+void readBinary(std::istream& in, Skeleton& skel);
+
+/// binary serialization of only the pose of a skeleton (joint transformations), to be read into
+/// a skeleton with the same hierarchy
+void writeBinaryPose(std::ostream& out, const Skeleton& skel);
+void readBinaryPose(std::istream& in, Skeleton& skel);
+
 }  // namespace anim
 
 namespace possumwood {
 
 template <>
 struct Traits<anim::Skeleton> {
+	static BinaryIO<anim::Skeleton> binaryIO;
+
 	static constexpr std::array<float, 3> colour() {
 		return std::array<float, 3>{{0, 0.5, 0}};
 	}
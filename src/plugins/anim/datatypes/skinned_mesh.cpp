@@ -1,5 +1,7 @@
 #include "skinned_mesh.h"
 
+#include <actions/binary.h>
+
 namespace anim {
 
 SkinnedMesh::SkinnedMesh() {
@@ -38,3 +40,93 @@ const Polygons& SkinnedMesh::polygons() const {
 }
 
 }  // namespace anim
+
+namespace {
+
+typedef std::shared_ptr<const std::vector<anim::SkinnedMesh>> SkinnedMeshes;
+
+void writeBinary(std::ostream& out, const SkinnedMeshes& meshes) {
+	const std::size_t count = meshes ? meshes->size() : 0;
+	possumwood::binary::writeInt<std::uint64_t>(out, count);
+
+	for(std::size_t m = 0; m < count; ++m) {
+		const anim::SkinnedMesh& mesh = (*meshes)[m];
+
+		possumwood::binary::writeString(out, mesh.name());
+
+		possumwood::binary::writeInt<std::uint64_t>(out, mesh.vertices().size());
+		for(auto& v : mesh.vertices()) {
+			possumwood::binary::writeRaw(out, &v.pos()[0], 3);
+
+			possumwood::binary::writeInt<std::uint64_t>(out, v.skinning().size());
+			for(auto& w : v.skinning()) {
+				possumwood::binary::writeInt<std::uint64_t>(out, w.bone);
+				possumwood::binary::writeRaw(out, &w.weight, 1);
+			}
+		}
+
+		// Imath vectors are not trivially copyable (user-provided copy constructors), but are laid out as
+		//   plain float arrays
+		possumwood::binary::writeInt<std::uint64_t>(out, mesh.normals().size());
+		if(!mesh.normals().empty())
+			possumwood::binary::writeRaw(out, &mesh.normals()[0][0], mesh.normals().size() * 3);
+
+		possumwood::binary::writeInt<std::uint64_t>(out, mesh.polygons().size());
+		for(auto& p : mesh.polygons())
+			for(auto& i : p)
+				possumwood::binary::writeInt<std::uint64_t>(out, i);
+	}
+}
+
+void readBinary(std::istream& in, SkinnedMeshes& meshes) {
+	std::unique_ptr<std::vector<anim::SkinnedMesh>> result(new std::vector<anim::SkinnedMesh>());
+
+	result->resize(possumwood::binary::readCount(in));
+	for(auto& mesh : *result) {
+		mesh.setName(possumwood::binary::readString(in));
+
+		const std::size_t vertexCount = possumwood::binary::readCount(in);
+		for(std::size_t v = 0; v < vertexCount; ++v) {
+			Imath::V3f pos;
+			possumwood::binary::readRaw(in, &pos[0], 3);
+
+			anim::Skinning skin;
+			const std::size_t weightCount = possumwood::binary::readCount(in);
+			for(std::size_t w = 0; w < weightCount; ++w) {
+				const std::size_t bone = possumwood::binary::readInt<std::uint64_t>(in);
+				float weight;
+				possumwood::binary::readRaw(in, &weight, 1);
+
+				skin.addWeight(bone, weight);
+			}
+
+			mesh.vertices().add(pos, skin);
+		}
+
+		mesh.normals().resize(possumwood::binary::readCount(in));
+		if(!mesh.normals().empty())
+			possumwood::binary::readRaw(in, &mesh.normals()[0][0], mesh.normals().size() * 3);
+
+		const std::size_t polygonCount = possumwood::binary::readCount(in);
+		for(std::size_t p = 0; p < polygonCount; ++p) {
+			std::size_t indices[3];
+			for(auto& i : indices) {
+				i = possumwood::binary::readInt<std::uint64_t>(in);
+				if(i >= vertexCount)
+					throw std::runtime_error("Error reading a skinned mesh - vertex index out of range.");
+			}
+
+			mesh.polygons().add(indices[0], indices[1], indices[2]);
+		}
+	}
+
+	meshes = SkinnedMeshes(result.release());
+}
+
+}  // namespace
+
+namespace possumwood {
+
+BinaryIO<SkinnedMeshes> Traits<SkinnedMeshes>::binaryIO(&writeBinary, &readBinary);
+
+}  // namespace possumwood
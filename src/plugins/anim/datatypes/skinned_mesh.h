@@ -40,6 +40,8 @@ namespace possumwood {
 
 template <>
 struct Traits<std::shared_ptr<const std::vector<anim::SkinnedMesh>>> {
+	static BinaryIO<std::shared_ptr<const std::vector<anim::SkinnedMesh>>> binaryIO;
+
 	static constexpr std::array<float, 3> colour() {
 		return std::array<float, 3>{{0, 0.5, 0.5}};
 	}
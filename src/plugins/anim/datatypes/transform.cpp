@@ -1,5 +1,7 @@
 #include "transform.h"
 
+#include <actions/binary.h>
+
 #include <OpenEXR/ImathMatrixAlgo.h>
 
 #include <cmath>
@@ -104,4 +106,18 @@ std::ostream& operator<<(std::ostream& out, const Transform& tr) {
 	return out;
 }
 
+void writeBinary(std::ostream& out, const Transform& tr) {
+	const float values[7] = {tr.translation.x, tr.translation.y, tr.translation.z, tr.rotation.r,
+	                         tr.rotation.v.x,  tr.rotation.v.y,  tr.rotation.v.z};
+	possumwood::binary::writeRaw(out, values, 7);
+}
+
+void readBinary(std::istream& in, Transform& tr) {
+	float values[7];
+	possumwood::binary::readRaw(in, values, 7);
+
+	tr.translation = Imath::V3f(values[0], values[1], values[2]);
+	tr.rotation = Imath::Quatf(values[3], values[4], values[5], values[6]);
+}
+
 };  // namespace anim
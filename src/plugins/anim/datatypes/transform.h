@@ -38,4 +38,8 @@ struct Transform {
 
 std::ostream& operator<<(std::ostream& out, const Transform& tr);
 
+/// binary serialization of a transformation (translation followed by rotation, as 7 floats)
+void writeBinary(std::ostream& out, const Transform& tr);
+void readBinary(std::istream& in, Transform& tr);
+
 };  // namespace anim
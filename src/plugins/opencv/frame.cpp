@@ -1,11 +1,17 @@
 #include "frame.h"
 
+#include <actions/binary.h>
+
 #include "tools.h"
 
 namespace possumwood {
 namespace opencv {
 
-Frame::Frame(const cv::Mat& data, bool copy) {
+Frame::Frame(const cv::Mat& data, bool copy) : Frame(data, cv::Rect(0, 0, data.cols, data.rows), 0, copy) {
+}
+
+Frame::Frame(const cv::Mat& data, const cv::Rect& region, unsigned level, bool copy)
+    : m_region(region), m_level(level) {
 	if(!copy)
 		m_frame = cv::Mat(data);
 	else
@@ -13,7 +19,7 @@ Frame::Frame(const cv::Mat& data, bool copy) {
 }
 
 Frame Frame::clone() const {
-	return Frame(m_frame, true);
+	return Frame(m_frame, m_region, m_level, true);
 }
 
 const cv::Mat& Frame::operator*() const {
@@ -40,6 +46,14 @@ bool Frame::empty() const {
 	return m_frame.empty();
 }
 
+const cv::Rect& Frame::region() const {
+	return m_region;
+}
+
+unsigned Frame::level() const {
+	return m_level;
+}
+
 bool Frame::operator==(const Frame& f) const {
 	return m_frame.ptr() == f.m_frame.ptr();
 }
@@ -49,9 +63,47 @@ bool Frame::operator!=(const Frame& f) const {
 }
 
 std::ostream& operator<<(std::ostream& out, const Frame& f) {
-	out << "(" << opencv::type2str((*f).type()) << " frame, " << (*f).cols << "x" << (*f).rows << ")";
+	out << "(" << opencv::type2str((*f).type()) << " frame, " << (*f).cols << "x" << (*f).rows;
+	if(f.level() > 0 || f.region() != cv::Rect(0, 0, (*f).cols, (*f).rows))
+		out << ", region " << f.region().x << "," << f.region().y << " " << f.region().width << "x"
+		    << f.region().height << " @ level " << f.level();
+	out << ")";
 	return out;
 }
 
 }  // namespace opencv
+
+namespace {
+
+void writeFrame(const std::string& filename, const opencv::Frame& frame) {
+	if(!cv::imwrite(filename, *frame))
+		throw std::runtime_error("Error writing frame to " + filename);
+}
+
+void writeBinary(std::ostream& out, const opencv::Frame& frame) {
+	binary::writeInt<std::int32_t>(out, frame.region().x);
+	binary::writeInt<std::int32_t>(out, frame.region().y);
+	binary::writeInt<std::int32_t>(out, frame.region().width);
+	binary::writeInt<std::int32_t>(out, frame.region().height);
+	binary::writeInt<std::uint32_t>(out, frame.level());
+
+	opencv::writeMat(out, *frame);
+}
+
+void readBinary(std::istream& in, opencv::Frame& frame) {
+	cv::Rect region;
+	region.x = binary::readInt<std::int32_t>(in);
+	region.y = binary::readInt<std::int32_t>(in);
+	region.width = binary::readInt<std::int32_t>(in);
+	region.height = binary::readInt<std::int32_t>(in);
+	const unsigned level = binary::readInt<std::uint32_t>(in);
+
+	frame = opencv::Frame(opencv::readMat(in), region, level, false);
+}
+
+}  // namespace
+
+ImageWriter<opencv::Frame> Traits<opencv::Frame>::imageWriter(&writeFrame);
+BinaryIO<opencv::Frame> Traits<opencv::Frame>::binaryIO(&writeBinary, &readBinary);
+
 }  // namespace possumwood
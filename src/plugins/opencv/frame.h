@@ -1,6 +1,7 @@
 #pragma once
 
 #include <actions/traits.h>
+#include <dependency_graph/data_traits.h>
 
 #include <memory>
 #include <opencv2/opencv.hpp>
@@ -12,6 +13,9 @@ namespace opencv {
 class Frame {
   public:
 	Frame(const cv::Mat& data = cv::Mat(), bool copy = true);
+	/// a frame holding only a region of the full-resolution image, at a downscale level (see
+	/// dependency_graph::Request)
+	Frame(const cv::Mat& data, const cv::Rect& region, unsigned level, bool copy = true);
 
 	Frame clone() const;
 
@@ -24,11 +28,19 @@ class Frame {
 	cv::Size size() const;
 	bool empty() const;
 
+	/// the region of the full-resolution image held by this frame (in full-resolution pixels)
+	const cv::Rect& region() const;
+	/// the downscale level of this frame (each level halves the resolution)
+	unsigned level() const;
+
 	bool operator==(const Frame& f) const;
 	bool operator!=(const Frame& f) const;
 
   private:
 	cv::Mat m_frame;
+
+	cv::Rect m_region;
+	unsigned m_level;
 };
 
 std::ostream& operator<<(std::ostream& out, const Frame& f);
@@ -37,9 +49,24 @@ std::ostream& operator<<(std::ostream& out, const Frame& f);
 
 template <>
 struct Traits<opencv::Frame> {
+	static ImageWriter<opencv::Frame> imageWriter;
+	static BinaryIO<opencv::Frame> binaryIO;
+
 	static constexpr std::array<float, 3> colour() {
 		return std::array<float, 3>{{1, 1, 0}};
 	}
 };
 
 }  // namespace possumwood
+
+namespace dependency_graph {
+
+// the pixel data of a frame are allocated dynamically - their size is used by the memory governor
+template <>
+struct DataSize<possumwood::opencv::Frame> {
+	static std::size_t size(const possumwood::opencv::Frame& value) {
+		return sizeof(possumwood::opencv::Frame) + value->total() * value->elemSize();
+	}
+};
+
+}  // namespace dependency_graph
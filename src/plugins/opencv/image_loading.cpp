@@ -26,27 +26,40 @@ struct ImageTraits<float> {
 };
 
 template <typename T>
-void copyData(ImageInput& input, cv::Mat& m) {
+void copyData(ImageInput& input, cv::Mat& m, const cv::Rect& region) {
 	const ImageSpec& spec = input.spec();
 	std::size_t xres = spec.width;
 	std::size_t yres = spec.height;
 	std::size_t channels = spec.nchannels;
 
-	std::vector<T> pixels(xres * yres * channels);
-	input.read_image(ImageTraits<T>::oiio_type, pixels.data());
+	// scanline images are read only in the rows covering the region, tiled images are read whole
+	std::size_t firstRow = 0;
+	std::vector<T> pixels;
+	if(spec.tile_width == 0) {
+		firstRow = region.y;
+		pixels.resize(xres * region.height * channels);
+		input.read_scanlines(spec.y + region.y, spec.y + region.y + region.height, 0, ImageTraits<T>::oiio_type,
+		                     pixels.data());
+	}
+	else {
+		pixels.resize(xres * yres * channels);
+		input.read_image(ImageTraits<T>::oiio_type, pixels.data());
+	}
 	input.close();
 
-	m = cv::Mat::zeros(yres, xres, CV_MAKETYPE(ImageTraits<T>::opencv_type, channels));
+	m = cv::Mat::zeros(region.height, region.width, CV_MAKETYPE(ImageTraits<T>::opencv_type, channels));
 
-	tbb::parallel_for(std::size_t(0), yres, [&](std::size_t y) {
-		for(std::size_t x = 0; x < xres; ++x) {
+	tbb::parallel_for(std::size_t(0), (std::size_t)region.height, [&](std::size_t y) {
+		const std::size_t row = y + region.y - firstRow;
+
+		for(std::size_t x = 0; x < (std::size_t)region.width; ++x) {
 			T* ptr = m.ptr<T>(y, x);
 
 			for(std::size_t c = 0; c < channels; ++c) {
 				// reverse channels - oiio RGB to opencv BGR
 				std::size_t index = channels - c - 1;
 
-				T value = *(pixels.data() + (y * xres + x) * channels + c);
+				T value = *(pixels.data() + (row * xres + x + region.x) * channels + c);
 				assert(value > 0 || value == 0);
 				*(ptr + index) = value;
 			}
@@ -57,6 +70,11 @@ void copyData(ImageInput& input, cv::Mat& m) {
 }  // namespace
 
 std::pair<cv::Mat, Exif> load(const boost::filesystem::path& filename) {
+	cv::Rect region;
+	return load(filename, region);
+}
+
+std::pair<cv::Mat, Exif> load(const boost::filesystem::path& filename, cv::Rect& region) {
 	std::pair<cv::Mat, Exif> result;
 
 	if(!filename.empty() && boost::filesystem::exists(filename)) {
@@ -67,11 +85,18 @@ std::pair<cv::Mat, Exif> load(const boost::filesystem::path& filename) {
 		// get the image spec
 		const ImageSpec& spec = in->spec();
 
+		// the loaded part of the image
+		const cv::Rect image(0, 0, spec.width, spec.height);
+		if(region.empty())
+			region = image;
+		else
+			region &= image;
+
 		// convert the raw data to a cv::Mat type
 		if(spec.format == TypeDesc::UINT8)
-			copyData<unsigned char>(*in, result.first);
+			copyData<unsigned char>(*in, result.first, region);
 		else if(spec.format == TypeDesc::FLOAT)
-			copyData<float>(*in, result.first);
+			copyData<float>(*in, result.first, region);
 		else
 			throw std::runtime_error("Error loading " + filename.string() +
 			                         " - only images with 8 or 32 bits per channel are supported at the moment!");
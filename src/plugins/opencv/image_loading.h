@@ -10,5 +10,9 @@ namespace opencv {
 
 std::pair<cv::Mat, Exif> load(const boost::filesystem::path& filename);
 
+/// loads a region of an image - for scanline images, only the rows covering the region are decoded.
+/// The region is clipped to the image (an empty region loads the whole image) and returned.
+std::pair<cv::Mat, Exif> load(const boost::filesystem::path& filename, cv::Rect& region);
+
 }
 }  // namespace possumwood
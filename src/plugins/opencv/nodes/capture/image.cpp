@@ -5,6 +5,7 @@
 
 #include "frame.h"
 #include "image_loading.h"
+#include "tools.h"
 
 namespace {
 
@@ -18,10 +19,18 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	// native reader - cannot read or understand EXIF information
 	// data.set(a_frame, possumwood::opencv::Frame(cv::imread(filename.filename().string())));
 
-	auto img = possumwood::opencv::load(filename.filename());
+	const dependency_graph::Request& request = data.request();
+
+	// only the requested region is decoded (the whole image if the request has no region)
+	cv::Rect region;
+	if(request.hasRegion())
+		region = cv::Rect(request.x(), request.y(), request.width(), request.height());
+
+	auto img = possumwood::opencv::load(filename.filename(), region);
 
 	data.set(a_exif, img.second);
-	data.set(a_frame, possumwood::opencv::Frame(img.first));
+	// the decoded region is at full resolution - fit() downscales it to the requested level
+	data.set(a_frame, possumwood::opencv::fit(possumwood::opencv::Frame(img.first, region, 0, false), data.request()));
 
 	return dependency_graph::State();
 }
@@ -37,6 +46,8 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_filename, a_frame);
 	meta.addInfluence(a_filename, a_exif);
 
+	meta.setFlags(dependency_graph::Metadata::kSupportsRequests);
+
 	meta.setCompute(compute);
 }
 
@@ -7,6 +7,7 @@
 
 #include "frame.h"
 #include "scoped_error_redirect.h"
+#include "tools.h"
 
 namespace {
 
@@ -33,15 +34,18 @@ static const std::vector<std::pair<std::string, int>> s_colorEnum{
 dependency_graph::State compute(dependency_graph::Values& data) {
 	dependency_graph::State state;
 
+	// only the requested part of the input is converted
+	const possumwood::opencv::Frame in = possumwood::opencv::fit(data.get(a_inFrame), data.request());
+
 	cv::Mat result;
 
 	{
 		possumwood::opencv::ScopedErrorRedirect errors;
-		cvtColor(*data.get(a_inFrame), result, data.get(a_mode).intValue());
+		cvtColor(*in, result, data.get(a_mode).intValue());
 		state.append(errors.state());
 	}
 
-	data.set(a_outFrame, possumwood::opencv::Frame(result));
+	data.set(a_outFrame, possumwood::opencv::Frame(result, in.region(), in.level()));
 
 	return state;
 }
@@ -54,6 +58,8 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_inFrame, a_outFrame);
 	meta.addInfluence(a_mode, a_outFrame);
 
+	meta.setFlags(dependency_graph::Metadata::kSupportsRequests);
+
 	meta.setCompute(compute);
 }
 
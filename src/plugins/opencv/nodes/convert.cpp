@@ -7,6 +7,7 @@
 
 #include "frame.h"
 #include "scoped_error_redirect.h"
+#include "tools.h"
 
 namespace {
 
@@ -29,17 +30,18 @@ int modeToEnum(const std::string& mode) {
 dependency_graph::State compute(dependency_graph::Values& data) {
 	dependency_graph::State state;
 
+	// only the requested part of the input is converted
+	const possumwood::opencv::Frame in = possumwood::opencv::fit(data.get(a_inFrame), data.request());
+
 	cv::Mat result;
 
 	{
 		possumwood::opencv::ScopedErrorRedirect errors;
-		(*data.get(a_inFrame))
-		    .clone()
-		    .convertTo(result, modeToEnum(data.get(a_mode).value()), data.get(a_a), data.get(a_b));
+		(*in).clone().convertTo(result, modeToEnum(data.get(a_mode).value()), data.get(a_a), data.get(a_b));
 		state.append(errors.state());
 	}
 
-	data.set(a_outFrame, possumwood::opencv::Frame(result));
+	data.set(a_outFrame, possumwood::opencv::Frame(result, in.region(), in.level()));
 
 	return state;
 }
@@ -56,6 +58,8 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_a, a_outFrame);
 	meta.addInfluence(a_b, a_outFrame);
 
+	meta.setFlags(dependency_graph::Metadata::kSupportsRequests);
+
 	meta.setCompute(compute);
 }
 
@@ -13,7 +13,9 @@ dependency_graph::InAttr<float> a_gamma, a_normalization;
 dependency_graph::OutAttr<possumwood::opencv::Frame> a_out;
 
 dependency_graph::State compute(dependency_graph::Values& data) {
-	const cv::Mat& in = *data.get(a_in);
+	// only the requested part of the input is processed
+	const possumwood::opencv::Frame frame = possumwood::opencv::fit(data.get(a_in), data.request());
+	const cv::Mat& in = *frame;
 	cv::Mat mat(in.rows, in.cols, in.type());
 
 	const float norm = data.get(a_normalization);
@@ -56,7 +58,7 @@ dependency_graph::State compute(dependency_graph::Values& data) {
 	else
 		throw std::runtime_error("Unsupported format " + possumwood::opencv::type2str(mat.type()));
 
-	data.set(a_out, possumwood::opencv::Frame(mat));
+	data.set(a_out, possumwood::opencv::Frame(mat, frame.region(), frame.level()));
 
 	return dependency_graph::State();
 }
@@ -71,6 +73,8 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_gamma, a_out);
 	meta.addInfluence(a_normalization, a_out);
 
+	meta.setFlags(dependency_graph::Metadata::kSupportsRequests);
+
 	meta.setCompute(compute);
 }
 
@@ -1,5 +1,7 @@
 #include "sequence.h"
 
+#include <actions/binary.h>
+
 #include "tools.h"
 
 namespace possumwood {
@@ -47,6 +49,19 @@ Sequence& Sequence::operator=(const Sequence& s) {
 	return *this;
 }
 
+Sequence::Sequence(Sequence&& s)
+    : m_sequence(std::move(s.m_sequence)), m_meta(s.m_meta), m_min(s.m_min), m_max(s.m_max) {
+}
+
+Sequence& Sequence::operator=(Sequence&& s) {
+	m_sequence = std::move(s.m_sequence);
+	m_meta = s.m_meta;
+	m_min = s.m_min;
+	m_max = s.m_max;
+
+	return *this;
+}
+
 bool Sequence::empty() const {
 	return m_sequence.empty();
 }
@@ -258,4 +273,48 @@ std::ostream& operator<<(std::ostream& out, const Sequence& seq) {
 }
 
 }  // namespace opencv
+
+namespace {
+
+void writeBinary(std::ostream& out, const opencv::Sequence& seq) {
+	// the metadata are only stored if initialised (the first added image initialises them otherwise)
+	binary::writeInt<std::uint8_t>(out, seq.meta().channels != 0);
+	binary::writeInt<std::int32_t>(out, seq.meta().type);
+	binary::writeInt<std::int32_t>(out, seq.meta().rows);
+	binary::writeInt<std::int32_t>(out, seq.meta().cols);
+
+	std::size_t count = 0;
+	for(auto it = seq.begin(); it != seq.end(); ++it)
+		++count;
+	binary::writeInt<std::uint64_t>(out, count);
+
+	for(auto& f : seq) {
+		binary::writeInt<std::int32_t>(out, f.first.x);
+		binary::writeInt<std::int32_t>(out, f.first.y);
+
+		opencv::writeMat(out, f.second);
+	}
+}
+
+void readBinary(std::istream& in, opencv::Sequence& seq) {
+	const bool hasMeta = binary::readInt<std::uint8_t>(in);
+	const int type = binary::readInt<std::int32_t>(in);
+	const int rows = binary::readInt<std::int32_t>(in);
+	const int cols = binary::readInt<std::int32_t>(in);
+
+	seq = opencv::Sequence(hasMeta ? opencv::Sequence::Metadata(type, rows, cols) : opencv::Sequence::Metadata());
+
+	const std::size_t count = binary::readCount(in);
+	for(std::size_t i = 0; i < count; ++i) {
+		const int x = binary::readInt<std::int32_t>(in);
+		const int y = binary::readInt<std::int32_t>(in);
+
+		seq(x, y) = opencv::readMat(in);
+	}
+}
+
+}  // namespace
+
+BinaryIO<opencv::Sequence> Traits<opencv::Sequence>::binaryIO(&writeBinary, &readBinary);
+
 }  // namespace possumwood
@@ -59,6 +59,9 @@ class Sequence final {
 	Sequence(const Sequence& s);
 	Sequence& operator=(const Sequence& s);
 
+	Sequence(Sequence&& s);
+	Sequence& operator=(Sequence&& s);
+
 	bool empty() const;
 	bool hasOneElement() const;
 
@@ -111,9 +114,25 @@ std::ostream& operator<<(std::ostream& out, const Sequence& f);
 
 template <>
 struct Traits<opencv::Sequence> {
+	static BinaryIO<opencv::Sequence> binaryIO;
+
 	static constexpr std::array<float, 3> colour() {
 		return std::array<float, 3>{{1, 0, 0}};
 	}
 };
 
 }  // namespace possumwood
+
+namespace dependency_graph {
+
+template <>
+struct DataSize<possumwood::opencv::Sequence> {
+	static std::size_t size(const possumwood::opencv::Sequence& value) {
+		std::size_t result = sizeof(possumwood::opencv::Sequence);
+		for(auto& f : value)
+			result += f.second.total() * f.second.elemSize();
+		return result;
+	}
+};
+
+}  // namespace dependency_graph
@@ -1,5 +1,8 @@
 #include "tools.h"
 
+#include <actions/binary.h>
+
+#include <cmath>
 #include <opencv2/opencv.hpp>
 
 namespace possumwood {
@@ -44,5 +47,68 @@ std::string type2str(int type) {
 	return r;
 }
 
+Frame fit(const Frame& frame, const dependency_graph::Request& request) {
+	if(frame.empty() || request.isFull())
+		return frame;
+
+	const unsigned level = std::max(frame.level(), request.level());
+
+	cv::Rect region = frame.region();
+	if(request.hasRegion())
+		region &= cv::Rect(request.x(), request.y(), request.width(), request.height());
+
+	if(region == frame.region() && level == frame.level())
+		return frame;
+
+	// the pixels of the frame covering the region (rounded outwards)
+	const float scale = 1.0f / (float)(1 << frame.level());
+	const int x0 = std::floor((float)(region.x - frame.region().x) * scale);
+	const int y0 = std::floor((float)(region.y - frame.region().y) * scale);
+	const int x1 = std::ceil((float)(region.x + region.width - frame.region().x) * scale);
+	const int y1 = std::ceil((float)(region.y + region.height - frame.region().y) * scale);
+	const cv::Rect pixels = cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(0, 0, frame->cols, frame->rows);
+
+	cv::Mat result = (*frame)(pixels);
+	if(level > frame.level() && !result.empty()) {
+		const double factor = 1.0 / (double)(1 << (level - frame.level()));
+		cv::Mat scaled;
+		cv::resize(result, scaled, cv::Size(), factor, factor, cv::INTER_AREA);
+		result = scaled;
+	}
+
+	return Frame(result, region, level);
+}
+
+void writeMat(std::ostream& out, const cv::Mat& mat) {
+	if(mat.dims > 2)
+		throw std::runtime_error("Binary serialization of matrices with more than 2 dimensions is not supported.");
+
+	binary::writeInt<std::int32_t>(out, mat.type());
+	binary::writeInt<std::int32_t>(out, mat.rows);
+	binary::writeInt<std::int32_t>(out, mat.cols);
+
+	// row by row - a matrix can be a view of a larger one, without continuous data
+	const std::size_t rowSize = mat.cols * mat.elemSize();
+	for(int row = 0; row < mat.rows; ++row)
+		binary::writeRaw(out, mat.ptr<char>(row), rowSize);
+}
+
+cv::Mat readMat(std::istream& in) {
+	const int type = binary::readInt<std::int32_t>(in);
+	const int rows = binary::readInt<std::int32_t>(in);
+	const int cols = binary::readInt<std::int32_t>(in);
+
+	if(rows < 0 || cols < 0)
+		throw std::runtime_error("Error reading a binary matrix - invalid size.");
+
+	cv::Mat result;
+	if(rows > 0 && cols > 0) {
+		result = cv::Mat(rows, cols, type);
+		binary::readRaw(in, result.ptr<char>(), result.total() * result.elemSize());
+	}
+
+	return result;
+}
+
 }  // namespace opencv
 }  // namespace possumwood
\ No newline at end of file
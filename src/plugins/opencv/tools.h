@@ -1,11 +1,26 @@
 #pragma once
 
+#include <dependency_graph/request.h>
+
+#include <iostream>
 #include <string>
 
+#include "frame.h"
+
 namespace possumwood {
 namespace opencv {
 
 std::string type2str(int type);
 
-}
+/// returns the part of a frame required by a request - the requested region, downscaled to the requested
+/// level (a frame already at a lower resolution is not upscaled). Used by nodes flagged with
+/// dependency_graph::Metadata::kSupportsRequests to process only the required pixels of their inputs.
+Frame fit(const Frame& frame, const dependency_graph::Request& request);
+
+/// binary serialization of a cv::Mat (its type, size and raw pixel data), used by the BinaryIO of
+/// the opencv datatypes
+void writeMat(std::ostream& out, const cv::Mat& mat);
+cv::Mat readMat(std::istream& in);
+
+}  // namespace opencv
 }  // namespace possumwood
\ No newline at end of file
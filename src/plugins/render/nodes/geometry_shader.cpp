@@ -40,6 +40,7 @@ void init(possumwood::Metadata& meta) {
 
 	meta.addInfluence(a_src, a_shader);
 
+	meta.setFlags(dependency_graph::Metadata::kMainThreadOnly);
 	meta.setCompute(&compute);
 	meta.setEditor<Editor>();
 }
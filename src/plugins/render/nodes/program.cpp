@@ -59,6 +59,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_gs, a_program);
 	meta.addInfluence(a_fs, a_program);
 
+	meta.setFlags(dependency_graph::Metadata::kMainThreadOnly);
 	meta.setCompute(&compute);
 }
 
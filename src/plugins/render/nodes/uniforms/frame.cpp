@@ -81,6 +81,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_mode, a_outUniforms);
 	meta.addInfluence(a_inUniforms, a_outUniforms);
 
+	meta.setFlags(dependency_graph::Metadata::kMainThreadOnly);
 	meta.setCompute(&compute);
 }
 
@@ -51,6 +51,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_value, a_outUniforms);
 	meta.addInfluence(a_inUniforms, a_outUniforms);
 
+	meta.setFlags(dependency_graph::Metadata::kMainThreadOnly);
 	meta.setCompute(&compute);
 }
 
@@ -277,6 +277,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_mesh, a_vd);
 	meta.addInfluence(a_pointsName, a_vd);
 
+	meta.setFlags(dependency_graph::Metadata::kMainThreadOnly);
 	meta.setCompute(&compute);
 }
 
@@ -65,6 +65,7 @@ void init(possumwood::Metadata& meta) {
 
 	meta.addInfluence(a_skeleton, a_vd);
 
+	meta.setFlags(dependency_graph::Metadata::kMainThreadOnly);
 	meta.setCompute(&compute);
 }
 
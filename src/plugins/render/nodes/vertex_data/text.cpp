@@ -127,6 +127,7 @@ void init(possumwood::Metadata& meta) {
 	meta.addInfluence(a_horizAlign, a_vd);
 	meta.addInfluence(a_vertAlign, a_vd);
 
+	meta.setFlags(dependency_graph::Metadata::kMainThreadOnly);
 	meta.setCompute(compute);
 }
 
@@ -0,0 +1,233 @@
+#include <dependency_graph/async_evaluation.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <thread>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+std::atomic<bool> s_started(false), s_release(false);
+
+/// passes its input to its output, but only after being released (or cancelled)
+const MetadataHandle& blockingNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("blocking"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			s_started = true;
+
+			while(!s_release && !vals.isCancelled())
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			vals.checkCancelled();
+
+			vals.set(output, vals.get(input));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+std::thread::id s_mainThreadComputeId;
+
+/// passes its input to its output, recording the thread of its compute (has to run on the main thread)
+const MetadataHandle& mainThreadNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("main_thread"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setFlags(Metadata::kMainThreadOnly);
+
+		meta->setCompute([](Values& vals) {
+			s_mainThreadComputeId = std::this_thread::get_id();
+
+			vals.set(output, vals.get(input));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(async_evaluation) {
+	for(bool parallel : {false, true}) {
+		Graph g;
+		g.setParallelEvaluation(parallel);
+
+		// add1 -> add2 -> add3
+		NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+		NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+		NodeBase& add3 = g.nodes().add(additionNode(), "add3");
+
+		BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+		BOOST_REQUIRE_NO_THROW(add2.port(2).connect(add3.port(0)));
+
+		BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+		BOOST_REQUIRE_NO_THROW(add1.port(1).set(2.0f));
+		BOOST_REQUIRE_NO_THROW(add2.port(1).set(3.0f));
+		BOOST_REQUIRE_NO_THROW(add3.port(1).set(4.0f));
+
+		// progress is reported via the state changed callback, deferred to the calling thread
+		std::atomic<unsigned> stateCounter(0), valueCounter(0);
+		std::atomic<bool> workerThread(false);
+		const std::thread::id mainThreadId = std::this_thread::get_id();
+		g.onStateChanged([&](const NodeBase&) {
+			++stateCounter;
+			workerThread = workerThread || std::this_thread::get_id() != mainThreadId;
+		});
+		add3.port(2).valueCallback([&]() {
+			++valueCounter;
+			workerThread = workerThread || std::this_thread::get_id() != mainThreadId;
+		});
+
+		std::shared_ptr<AsyncEvaluation> eval = g.evaluateAsync(add3.port(2));
+		BOOST_REQUIRE(eval != nullptr);
+
+		Data result;
+		BOOST_REQUIRE_NO_THROW(result = eval->get());
+		BOOST_CHECK(eval->isFinished());
+		BOOST_CHECK(not eval->isCancelled());
+		BOOST_CHECK_EQUAL(eval->progress(), 1.0f);
+		BOOST_CHECK_EQUAL(result.get<float>(), 10.0f);
+
+		BOOST_CHECK_EQUAL(stateCounter, 3u);
+		BOOST_CHECK(valueCounter > 0u);
+		BOOST_CHECK(not workerThread);
+
+		BOOST_CHECK(not add3.port(2).isDirty());
+		BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 10.0f);
+
+		// a clean port is just returned
+		eval = g.evaluateAsync(add3.port(2));
+		BOOST_CHECK_EQUAL(eval->get().get<float>(), 10.0f);
+		BOOST_CHECK_EQUAL(stateCounter, 3u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(async_evaluation_cancel) {
+	s_started = false;
+	s_release = false;
+
+	Graph g;
+
+	// add1 -> blocking -> add2
+	NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+	NodeBase& block = g.nodes().add(blockingNode(), "blocking");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(block.port(0)));
+	BOOST_REQUIRE_NO_THROW(block.port(1).connect(add2.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(add2.port(1).set(2.0f));
+
+	std::shared_ptr<AsyncEvaluation> eval = g.evaluateAsync(add2.port(2));
+	// queued behind the first evaluation
+	std::shared_ptr<AsyncEvaluation> queued = g.evaluateAsync(add1.port(2));
+
+	while(!s_started)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	BOOST_CHECK(not eval->isFinished());
+	BOOST_CHECK(not eval->waitFor(std::chrono::milliseconds(10)));
+	BOOST_CHECK_EQUAL(eval->progress(), 1.0f / 3.0f);
+
+	// cancellation is polled from the blocking compute
+	eval->cancel();
+	queued->cancel();
+
+	BOOST_CHECK_THROW(eval->get(), EvaluationCancelled);
+	BOOST_CHECK_THROW(queued->get(), EvaluationCancelled);
+	BOOST_CHECK(eval->isCancelled());
+
+	// the cancelled outputs are left dirty, and the blocking node didn't report an error
+	BOOST_CHECK(not add1.port(2).isDirty());
+	BOOST_CHECK(block.port(1).isDirty());
+	BOOST_CHECK(add2.port(2).isDirty());
+	BOOST_CHECK(not block.state().errored());
+
+	// a new evaluation finishes the work
+	s_release = true;
+
+	eval = g.evaluateAsync(add2.port(2));
+	BOOST_CHECK_EQUAL(eval->get().get<float>(), 3.0f);
+	BOOST_CHECK(not add2.port(2).isDirty());
+
+	// the graph's destructor cancels a running evaluation
+	s_started = false;
+	s_release = false;
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(2.0f));
+	eval = g.evaluateAsync(add2.port(2));
+
+	while(!s_started)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+BOOST_AUTO_TEST_CASE(async_evaluation_main_thread) {
+	Graph g;
+
+	// add1 -> main_thread -> add2
+	NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+	NodeBase& main = g.nodes().add(mainThreadNode(), "main_thread");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(main.port(0)));
+	BOOST_REQUIRE_NO_THROW(main.port(1).connect(add2.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(add2.port(1).set(2.0f));
+
+	// an upstream with a main-thread-only node is evaluated synchronously on the calling thread
+	s_mainThreadComputeId = std::thread::id();
+
+	std::shared_ptr<AsyncEvaluation> eval = g.evaluateAsync(add2.port(2));
+	BOOST_CHECK(eval->isFinished());
+	BOOST_CHECK(s_mainThreadComputeId == std::this_thread::get_id());
+	BOOST_CHECK_EQUAL(eval->get().get<float>(), 3.0f);
+
+	// a clean main-thread-only node doesn't prevent the asynchronous evaluation of its downstream
+	BOOST_REQUIRE_NO_THROW(add2.port(1).set(3.0f));
+
+	eval = g.evaluateAsync(add2.port(2));
+	BOOST_CHECK_EQUAL(eval->get().get<float>(), 4.0f);
+}
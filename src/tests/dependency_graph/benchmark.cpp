@@ -0,0 +1,175 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <vector>
+
+#include "common.h"
+
+// Simple timing benchmarks, reported as test messages (run with --log_level=message).
+// Timings are not checked, only the results of the evaluation.
+
+using namespace dependency_graph;
+
+namespace {
+
+/// a float wrapper with a user-provided copy constructor, forcing heap storage in Data
+struct BoxedFloat {
+	BoxedFloat(float v = 0.0f) : value(v) {
+	}
+
+	BoxedFloat(const BoxedFloat& f) : value(f.value) {
+	}
+
+	BoxedFloat& operator=(const BoxedFloat& f) = default;
+
+	float value;
+};
+
+std::ostream& operator<<(std::ostream& out, const BoxedFloat& f) {
+	out << f.value;
+	return out;
+}
+
+float valueOf(const float& f) {
+	return f;
+}
+
+float valueOf(const BoxedFloat& f) {
+	return f.value;
+}
+
+template <typename T>
+float accumulate(const std::vector<Data>& values) {
+	float result = 0.0f;
+
+	std::vector<Data> copies(values.size());
+	for(std::size_t i = 0; i < values.size(); ++i)
+		copies[i] = values[i];
+
+	for(auto& d : copies)
+		result += valueOf(d.get<T>());
+
+	return result;
+}
+
+template <typename T>
+double benchmarkData(unsigned count, float& result) {
+	std::vector<Data> values;
+	for(unsigned i = 0; i < count; ++i)
+		values.push_back(Data(T(1.0f)));
+
+	const auto start = std::chrono::steady_clock::now();
+
+	result = 0.0f;
+	for(unsigned a = 0; a < 100; ++a)
+		result += accumulate<T>(values);
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(benchmark_data) {
+	float inlineResult = 0.0f, heapResult = 0.0f;
+
+	const double inlineTime = benchmarkData<float>(1000, inlineResult);
+	const double heapTime = benchmarkData<BoxedFloat>(1000, heapResult);
+
+	BOOST_CHECK_EQUAL(inlineResult, 100000.0f);
+	BOOST_CHECK_EQUAL(heapResult, 100000.0f);
+
+	BOOST_TEST_MESSAGE("Data copy and get, inline float: " << inlineTime << "ms, heap-allocated float: " << heapTime
+	                                                       << "ms");
+}
+
+BOOST_AUTO_TEST_CASE(benchmark_arithmetic) {
+	// a long chain of addition nodes, each adding 1 to the result of the previous one
+	Graph g;
+
+	std::vector<NodeBase*> nodes;
+	for(unsigned i = 0; i < 1000; ++i) {
+		nodes.push_back(&g.nodes().add(additionNode(), "add_" + std::to_string(i)));
+		nodes.back()->port(1).set(1.0f);
+
+		if(i > 0)
+			nodes[i - 1]->port(2).connect(nodes[i]->port(0));
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for(unsigned a = 0; a < 20; ++a) {
+		nodes.front()->port(0).set(float(a));
+		BOOST_REQUIRE_EQUAL(nodes.back()->port(2).get<float>(), float(a + 1000));
+	}
+
+	const double time =
+	    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	BOOST_TEST_MESSAGE("Arithmetic chain evaluation, 20x 1000 nodes: " << time << "ms");
+}
+
+namespace {
+
+/// builds a wide network of additions - each node connected to two nodes of the previous row
+double benchmarkBuild(bool bulk, float& result) {
+	Graph g;
+
+	const unsigned rows = 50, columns = 40;
+	std::vector<NodeBase*> nodes;
+
+	// UI-like callbacks
+	unsigned callbacks = 0;
+	g.onAddNode([&](NodeBase&) { ++callbacks; });
+	g.onConnect([&](Port&, Port&) { ++callbacks; });
+	g.onDirty([&]() { ++callbacks; });
+
+	const auto start = std::chrono::steady_clock::now();
+
+	{
+		std::unique_ptr<Graph::BulkBuild> build;
+		if(bulk)
+			build.reset(new Graph::BulkBuild(g));
+
+		for(unsigned r = 0; r < rows; ++r)
+			for(unsigned c = 0; c < columns; ++c) {
+				nodes.push_back(&g.nodes().add(additionNode(), "add_" + std::to_string(r) + "_" + std::to_string(c)));
+
+				if(r == 0) {
+					nodes.back()->port(0).set(1.0f);
+					nodes.back()->port(1).set(0.0f);
+				}
+				else {
+					nodes[(r - 1) * columns + c]->port(2).connect(nodes.back()->port(0));
+					nodes[(r - 1) * columns + (c + 1) % columns]->port(2).connect(nodes.back()->port(1));
+				}
+			}
+	}
+
+	const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	result = nodes.back()->port(2).get<float>();
+	return time;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(benchmark_bulk_build) {
+	float result = 0.0f, bulkResult = 0.0f;
+
+	const double time = benchmarkBuild(false, result);
+	const double bulkTime = benchmarkBuild(true, bulkResult);
+
+	// each row doubles the values of the previous one
+	BOOST_CHECK_EQUAL(result, float(1ull << 49));
+	BOOST_CHECK_EQUAL(result, bulkResult);
+
+	BOOST_TEST_MESSAGE("Building a network of 2000 nodes, individually: " << time << "ms, in a bulk build: " << bulkTime
+	                                                                    << "ms");
+}
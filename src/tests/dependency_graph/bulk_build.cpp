@@ -0,0 +1,147 @@
+#include <dependency_graph/graph.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+BOOST_AUTO_TEST_CASE(bulk_build_callbacks) {
+	Graph g;
+
+	std::vector<NodeBase*> added;
+	std::vector<std::pair<Port*, Port*>> connected;
+	unsigned removed = 0, disconnected = 0, renamed = 0, dirty = 0;
+
+	g.onAddNode([&](NodeBase& n) {
+		// the connections are reported after all nodes
+		BOOST_CHECK(connected.empty());
+		added.push_back(&n);
+	});
+	g.onConnect([&](Port& p1, Port& p2) { connected.push_back(std::make_pair(&p1, &p2)); });
+	g.onRemoveNode([&](NodeBase&) { ++removed; });
+	g.onDisconnect([&](Port&, Port&) { ++disconnected; });
+	g.onNameChanged([&](NodeBase&) { ++renamed; });
+	g.onDirty([&]() { ++dirty; });
+
+	NodeBase& existing = g.nodes().add(additionNode(), "existing");
+	BOOST_REQUIRE_EQUAL(added.size(), 1u);
+	added.clear();
+	dirty = 0;
+
+	{
+		Graph::BulkBuild build(g);
+		BOOST_CHECK(g.isBulkBuilding());
+
+		NodeBase& add1 = g.nodes().add(additionNode(), "add_1");
+		NodeBase& add2 = g.nodes().add(additionNode(), "add_2");
+		NodeBase& add3 = g.nodes().add(additionNode(), "add_3");
+
+		BOOST_REQUIRE_NO_THROW(existing.port(2).connect(add1.port(0)));
+		BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+		BOOST_REQUIRE_NO_THROW(add2.port(2).connect(add3.port(0)));
+
+		// callbacks of nodes added during the build are suppressed
+		add1.setName("renamed");
+
+		// nested builds are flushed with the outermost one
+		{
+			Graph::BulkBuild nested(g);
+			g.nodes().add(additionNode(), "add_4");
+		}
+
+		// removed nodes and connections were never reported
+		BOOST_REQUIRE_NO_THROW(add2.port(2).disconnect(add3.port(0)));
+		g.nodes().erase(g.nodes().find(add3.index()));
+
+		BOOST_CHECK(added.empty());
+		BOOST_CHECK(connected.empty());
+		BOOST_CHECK_EQUAL(removed, 0u);
+		BOOST_CHECK_EQUAL(disconnected, 0u);
+		BOOST_CHECK_EQUAL(renamed, 0u);
+		BOOST_CHECK_EQUAL(dirty, 0u);
+
+		// callbacks of existing nodes are not suppressed
+		existing.setName("existing_renamed");
+		BOOST_CHECK_EQUAL(renamed, 1u);
+	}
+
+	BOOST_CHECK(!g.isBulkBuilding());
+
+	BOOST_REQUIRE_EQUAL(added.size(), 3u);
+	BOOST_CHECK_EQUAL(added[0]->name(), "renamed");
+	BOOST_CHECK_EQUAL(added[1]->name(), "add_2");
+	BOOST_CHECK_EQUAL(added[2]->name(), "add_4");
+
+	BOOST_REQUIRE_EQUAL(connected.size(), 2u);
+	BOOST_CHECK_EQUAL(connected[0].first, &existing.port(2));
+	BOOST_CHECK_EQUAL(connected[1].second, &added[1]->port(0));
+
+	BOOST_CHECK_EQUAL(removed, 0u);
+	BOOST_CHECK_EQUAL(disconnected, 0u);
+	BOOST_CHECK_EQUAL(renamed, 1u);
+
+	// a single consolidated dirtiness notification
+	BOOST_CHECK_EQUAL(dirty, 1u);
+
+	// callbacks are back to normal after the build
+	added[0]->setName("add_1");
+	BOOST_CHECK_EQUAL(renamed, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(bulk_build_dirty_propagation) {
+	Graph g;
+
+	NodeBase& add1 = g.nodes().add(additionNode(), "add_1");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add_2");
+	NodeBase& add3 = g.nodes().add(additionNode(), "add_3");
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(add3.port(0).set(1.0f));
+
+	BOOST_CHECK_EQUAL(add2.port(2).get<float>(), 1.0f);
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 1.0f);
+
+	{
+		Graph::BulkBuild build(g);
+
+		// the propagation of dirtiness is deferred
+		BOOST_REQUIRE_NO_THROW(add1.port(1).set(2.0f));
+		BOOST_CHECK(!add1.port(2).isDirty());
+		BOOST_CHECK(!add2.port(2).isDirty());
+
+		BOOST_REQUIRE_NO_THROW(add2.port(2).connect(add3.port(1)));
+		BOOST_CHECK(add3.port(1).isDirty());
+		BOOST_CHECK(!add3.port(2).isDirty());
+
+		// pulling propagates it first
+		BOOST_CHECK_EQUAL(add2.port(2).get<float>(), 3.0f);
+		BOOST_CHECK(!add2.port(2).isDirty());
+		BOOST_CHECK(add3.port(2).isDirty());
+
+		// and more changes are deferred again
+		BOOST_REQUIRE_NO_THROW(add2.port(1).set(1.0f));
+		BOOST_CHECK(!add2.port(2).isDirty());
+		BOOST_CHECK(add3.port(2).isDirty());
+
+		// a deferred port can be safely removed
+		NodeBase& add4 = g.nodes().add(additionNode(), "add_4");
+		BOOST_REQUIRE_NO_THROW(add4.port(0).set(1.0f));
+		g.nodes().erase(g.nodes().find(add4.index()));
+	}
+
+	// the end of the build propagates the dirtiness through the whole graph
+	BOOST_CHECK(add2.port(2).isDirty());
+	BOOST_CHECK(add3.port(2).isDirty());
+
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 5.0f);
+
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			BOOST_CHECK(!n.port(p).isDirty());
+}
@@ -0,0 +1,98 @@
+#include <dependency_graph/compute_cache.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <map>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+/// an in-memory cache, keyed by the node name and the input values
+class MockCache : public ComputeCache {
+  public:
+	bool load(Port& output, const std::vector<std::size_t>& inputs) override {
+		++loads;
+
+		auto it = values.find(key(output, inputs));
+		if(it == values.end())
+			return false;
+
+		output.set(it->second);
+		return true;
+	}
+
+	void store(Port& output, const std::vector<std::size_t>& inputs, std::chrono::steady_clock::duration) override {
+		++stores;
+
+		values[key(output, inputs)] = output.get<float>();
+	}
+
+	std::map<std::string, float> values;
+	unsigned loads = 0, stores = 0;
+
+  private:
+	std::string key(Port& output, const std::vector<std::size_t>& inputs) {
+		std::stringstream result;
+		result << output.node().name() << "/" << output.name();
+		for(auto& i : inputs)
+			result << " " << output.node().port(i).get<float>();
+		return result.str();
+	}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(compute_cache) {
+	Graph g;
+	BOOST_CHECK(g.computeCache() == nullptr);
+
+	std::shared_ptr<MockCache> cache(new MockCache());
+	g.setComputeCache(cache);
+	BOOST_CHECK(g.computeCache() == cache);
+
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+	NodeBase& mult = g.nodes().add(multiplicationNode(), "mult");
+	BOOST_REQUIRE_NO_THROW(add.port(2).connect(mult.port(0)));
+
+	// the first evaluation stores all computed outputs
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(2.0f));
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(3.0f));
+	BOOST_REQUIRE_NO_THROW(mult.port(1).set(4.0f));
+	BOOST_CHECK_EQUAL(mult.port(2).get<float>(), 20.0f);
+	BOOST_CHECK_EQUAL(cache->loads, 2u);
+	BOOST_CHECK_EQUAL(cache->stores, 2u);
+	BOOST_CHECK_EQUAL(cache->values.size(), 2u);
+
+	// a new combination of inputs is computed and stored as well
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(mult.port(2).get<float>(), 16.0f);
+	BOOST_CHECK_EQUAL(cache->loads, 4u);
+	BOOST_CHECK_EQUAL(cache->stores, 4u);
+
+	// a cached combination of inputs is loaded, without running the compute
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(2.0f));
+	BOOST_CHECK_EQUAL(mult.port(2).get<float>(), 20.0f);
+	BOOST_CHECK_EQUAL(cache->loads, 6u);
+	BOOST_CHECK_EQUAL(cache->stores, 4u);
+
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			BOOST_CHECK(not n.port(p).isDirty());
+
+	// removing the cache
+	g.setComputeCache(std::shared_ptr<ComputeCache>());
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(mult.port(2).get<float>(), 16.0f);
+	BOOST_CHECK_EQUAL(cache->loads, 6u);
+	BOOST_CHECK_EQUAL(cache->stores, 4u);
+}
@@ -0,0 +1,230 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <atomic>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <random>
+#include <thread>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+std::atomic<unsigned> s_computeCount(0);
+
+/// a two-in-one-out node, summing its inputs and counting its computes
+const MetadataHandle& countingNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("counting"));
+
+		static InAttr<float> a, b;
+		meta->addAttribute(a, "a");
+		meta->addAttribute(b, "b");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(a, output);
+		meta->addInfluence(b, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount;
+
+			// give the other threads a chance to pull on the same node
+			std::this_thread::yield();
+
+			vals.set(output, vals.get(a) + vals.get(b));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+// the node created from twoOutputNode()
+NodeBase* s_twoOutputs = nullptr;
+
+/// a node with two independent outputs, each passing through one input
+const MetadataHandle& twoOutputNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("two_outputs"));
+
+		static InAttr<float> in1, in2;
+		meta->addAttribute(in1, "in1");
+		meta->addAttribute(in2, "in2");
+
+		static OutAttr<float> out1, out2;
+		meta->addAttribute(out1, "out1");
+		meta->addAttribute(out2, "out2");
+
+		meta->addInfluence(in1, out1);
+		meta->addInfluence(in2, out2);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount;
+
+			std::this_thread::yield();
+
+			// only dirty outputs with evaluated inputs are computed - an input in the upstream of the other
+			//   output is still dirty while computing the first one (reading it would pull its upstream from
+			//   inside the compute), and setting a clean output would invalidate its downstream again
+			if(vals.isDirty(out1) && !s_twoOutputs->port(0).isDirty())
+				vals.set(out1, vals.get(in1));
+			if(vals.isDirty(out2) && !s_twoOutputs->port(1).isDirty())
+				vals.set(out2, vals.get(in2));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+const std::size_t s_width = 8;
+const std::size_t s_depth = 6;
+
+/// pulls on all nodes of a layered graph from several threads at the same time, in a different order
+///   in each thread, and returns the number of values that didn't match the expected result
+unsigned pullConcurrently(std::vector<std::vector<NodeBase*>>& layers,
+                          const std::vector<std::vector<float>>& expected) {
+	std::atomic<unsigned> mismatches(0);
+
+	std::vector<std::thread> threads;
+	for(unsigned t = 0; t < 8; ++t)
+		threads.push_back(std::thread([&layers, &expected, &mismatches, t]() {
+			std::vector<std::pair<std::size_t, std::size_t>> order;
+			for(std::size_t l = 0; l < s_depth; ++l)
+				for(std::size_t n = 0; n < s_width; ++n)
+					order.push_back(std::make_pair(l, n));
+
+			// half of the threads start with the most expensive pulls, to make them meet in the upstream
+			std::mt19937 gen(t);
+			std::shuffle(order.begin(), order.end(), gen);
+			if(t % 2 == 0)
+				std::sort(order.begin(), order.end(), [](const std::pair<std::size_t, std::size_t>& p1,
+				                                         const std::pair<std::size_t, std::size_t>& p2) {
+					return p1.first > p2.first;
+				});
+
+			for(auto& o : order) {
+				const float value = layers[o.first][o.second]->port(2).get<float>();
+				if(value != expected[o.first][o.second])
+					++mismatches;
+			}
+		}));
+
+	for(auto& t : threads)
+		t.join();
+
+	return mismatches;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(concurrent_evaluation) {
+	for(bool parallel : {false, true}) {
+		Graph g;
+		g.setParallelEvaluation(parallel);
+
+		// a layered graph - each node sums two neighbouring nodes of the previous layer
+		std::vector<std::vector<NodeBase*>> layers(s_depth);
+		for(std::size_t l = 0; l < s_depth; ++l)
+			for(std::size_t n = 0; n < s_width; ++n) {
+				layers[l].push_back(&g.nodes().add(countingNode(), "node"));
+
+				if(l > 0) {
+					BOOST_REQUIRE_NO_THROW(layers[l - 1][n]->port(2).connect(layers[l][n]->port(0)));
+					BOOST_REQUIRE_NO_THROW(layers[l - 1][(n + 1) % s_width]->port(2).connect(layers[l][n]->port(1)));
+				}
+			}
+
+		for(unsigned epoch = 0; epoch < 4; ++epoch) {
+			// changing all source values makes the whole graph dirty
+			std::vector<std::vector<float>> expected(s_depth, std::vector<float>(s_width));
+			for(std::size_t n = 0; n < s_width; ++n) {
+				BOOST_REQUIRE_NO_THROW(layers[0][n]->port(0).set((float)(n + epoch)));
+				BOOST_REQUIRE_NO_THROW(layers[0][n]->port(1).set(1.0f));
+
+				expected[0][n] = (float)(n + epoch) + 1.0f;
+			}
+
+			for(std::size_t l = 1; l < s_depth; ++l)
+				for(std::size_t n = 0; n < s_width; ++n)
+					expected[l][n] = expected[l - 1][n] + expected[l - 1][(n + 1) % s_width];
+
+			s_computeCount = 0;
+
+			BOOST_CHECK_EQUAL(pullConcurrently(layers, expected), 0u);
+
+			// each node is computed exactly once, independently of the number of threads pulling on it
+			BOOST_CHECK_EQUAL(s_computeCount.load(), s_width * s_depth);
+
+			for(auto& n : g.nodes())
+				for(std::size_t p = 0; p < n.portCount(); ++p)
+					BOOST_CHECK(not n.port(p).isDirty());
+		}
+
+		// pulling on clean values doesn't compute anything
+		s_computeCount = 0;
+		BOOST_CHECK_EQUAL(layers[s_depth - 1][0]->port(2).get<float>(),
+		                  layers[s_depth - 2][0]->port(2).get<float>() + layers[s_depth - 2][1]->port(2).get<float>());
+		BOOST_CHECK_EQUAL(s_computeCount.load(), 0u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_evaluation_multiple_outputs) {
+	for(bool parallel : {false, true}) {
+		Graph g;
+		g.setParallelEvaluation(parallel);
+
+		// n.out1 -> m.a, m.output -> n.in2 - the first output of n is in the upstream of its second output
+		NodeBase& n = g.nodes().add(twoOutputNode(), "n");
+		NodeBase& m = g.nodes().add(countingNode(), "m");
+		s_twoOutputs = &n;
+
+		BOOST_REQUIRE_NO_THROW(n.port(2).connect(m.port(0)));
+		BOOST_REQUIRE_NO_THROW(m.port(2).connect(n.port(1)));
+		BOOST_REQUIRE_NO_THROW(m.port(1).set(1.0f));
+
+		for(unsigned epoch = 0; epoch < 200; ++epoch) {
+			BOOST_REQUIRE_NO_THROW(n.port(0).set((float)epoch));
+
+			// pulling on n.out2 and m.output concurrently - holding a lock of the whole node n while evaluating
+			//   the upstream of n.out2 would deadlock with the evaluation of m.output pulling on n.out1
+			std::atomic<unsigned> mismatches(0);
+
+			std::thread t1([&]() {
+				if(n.port(3).get<float>() != (float)epoch + 1.0f)
+					++mismatches;
+			});
+
+			std::thread t2([&]() {
+				if(m.port(2).get<float>() != (float)epoch + 1.0f)
+					++mismatches;
+			});
+
+			t1.join();
+			t2.join();
+
+			BOOST_CHECK_EQUAL(mismatches.load(), 0u);
+		}
+	}
+}
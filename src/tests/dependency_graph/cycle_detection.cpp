@@ -0,0 +1,180 @@
+#include <dependency_graph/graph.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+#include <map>
+#include <random>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+// true if the node "to" is reachable from the node "from" (addition nodes - both inputs influence the output)
+bool isReachable(const std::vector<std::vector<unsigned>>& edges, std::size_t from, std::size_t to) {
+	std::vector<bool> visited(edges.size(), false);
+	std::vector<std::size_t> stack(1, from);
+
+	while(!stack.empty()) {
+		const std::size_t current = stack.back();
+		stack.pop_back();
+
+		if(current == to)
+			return true;
+
+		if(!visited[current]) {
+			visited[current] = true;
+			for(std::size_t n = 0; n < edges.size(); ++n)
+				if(edges[current][n] > 0)
+					stack.push_back(n);
+		}
+	}
+
+	return false;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(cycle_detection_reordering) {
+	Graph g;
+
+	// a chain of additions, connected from its end to force reordering on each connection
+	std::vector<NodeBase*> nodes;
+	for(unsigned a = 0; a < 10; ++a)
+		nodes.push_back(&g.nodes().add(additionNode(), "add_" + std::to_string(a)));
+
+	for(std::size_t a = nodes.size() - 1; a > 0; --a)
+		BOOST_REQUIRE_NO_THROW(nodes[a]->port(2).connect(nodes[a - 1]->port(0)));
+
+	// closing the loop anywhere is detected, and doesn't change the connections
+	for(std::size_t a = 0; a < nodes.size(); ++a)
+		BOOST_CHECK_THROW(nodes[0]->port(2).connect(nodes[a]->port(1)), std::runtime_error);
+	BOOST_CHECK_EQUAL(g.connections().size(), nodes.size() - 1);
+
+	// a disconnect keeps the order valid - the loop can then be closed on the other side
+	BOOST_REQUIRE_NO_THROW(nodes[5]->port(2).disconnect(nodes[4]->port(0)));
+	BOOST_REQUIRE_NO_THROW(nodes[0]->port(2).connect(nodes[9]->port(1)));
+	BOOST_CHECK_THROW(nodes[5]->port(2).connect(nodes[4]->port(0)), std::runtime_error);
+
+	// the evaluation follows the new connections - add_4 .. add_0, add_9 .. add_5
+	for(auto& n : nodes)
+		if(!n->port(1).isConnected())
+			BOOST_REQUIRE_NO_THROW(n->port(1).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(nodes[4]->port(0).set(2.0f));
+	BOOST_REQUIRE_NO_THROW(nodes[9]->port(0).set(0.0f));
+
+	BOOST_CHECK_EQUAL(nodes[0]->port(2).get<float>(), 7.0f);
+	BOOST_CHECK_EQUAL(nodes[5]->port(2).get<float>(), 11.0f);
+}
+
+BOOST_AUTO_TEST_CASE(cycle_detection_random) {
+	Graph g;
+
+	const std::size_t count = 40;
+
+	std::vector<NodeBase*> nodes;
+	for(unsigned a = 0; a < count; ++a)
+		nodes.push_back(&g.nodes().add(additionNode(), "add_" + std::to_string(a)));
+
+	// random connections, compared to a simple reachability test (number of connections between each two nodes)
+	std::vector<std::vector<unsigned>> edges(count, std::vector<unsigned>(count, 0));
+	std::map<const Port*, std::size_t> sources;
+
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<std::size_t> node(0, count - 1);
+	std::uniform_int_distribution<std::size_t> port(0, 1);
+
+	std::size_t connected = 0;
+	for(unsigned attempt = 0; attempt < 2000; ++attempt) {
+		const std::size_t from = node(gen);
+		const std::size_t to = node(gen);
+		Port& input = nodes[to]->port(port(gen));
+
+		// random disconnects keep the graph from saturating
+		if(input.isConnected()) {
+			if(attempt % 3 == 0) {
+				const std::size_t source = sources[&input];
+				BOOST_REQUIRE_NO_THROW(nodes[source]->port(2).disconnect(input));
+
+				sources.erase(&input);
+				--edges[source][to];
+			}
+			continue;
+		}
+
+		const bool cycle = isReachable(edges, to, from);
+		if(cycle)
+			BOOST_CHECK_THROW(nodes[from]->port(2).connect(input), std::runtime_error);
+		else {
+			BOOST_REQUIRE_NO_THROW(nodes[from]->port(2).connect(input));
+			sources[&input] = from;
+			++edges[from][to];
+			++connected;
+		}
+	}
+
+	BOOST_CHECK_GT(connected, count);
+}
+
+BOOST_AUTO_TEST_CASE(cycle_detection_batch) {
+	Graph g;
+
+	std::vector<NodeBase*> nodes;
+	for(unsigned a = 0; a < 6; ++a)
+		nodes.push_back(&g.nodes().add(additionNode(), "add_" + std::to_string(a)));
+
+	// a valid batch, against the creation order of the nodes
+	std::vector<std::pair<Port*, Port*>> batch;
+	for(std::size_t a = nodes.size() - 1; a > 0; --a)
+		batch.push_back(std::make_pair(&nodes[a]->port(2), &nodes[a - 1]->port(0)));
+
+	BOOST_REQUIRE_NO_THROW(g.connections().connect(batch));
+	BOOST_CHECK_EQUAL(g.connections().size(), 5u);
+
+	for(auto& n : nodes)
+		BOOST_REQUIRE_NO_THROW(n->port(1).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(nodes[5]->port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(nodes[0]->port(2).get<float>(), 7.0f);
+
+	// single connections still test cycles against the batch
+	BOOST_CHECK_THROW(nodes[0]->port(2).connect(nodes[3]->port(1)), std::runtime_error);
+	BOOST_CHECK_EQUAL(g.connections().size(), 5u);
+
+	// a batch closing a loop is rejected as a whole
+	NodeBase& extra1 = g.nodes().add(additionNode(), "extra_1");
+	NodeBase& extra2 = g.nodes().add(additionNode(), "extra_2");
+
+	batch = {std::make_pair(&extra1.port(2), &extra2.port(0)), std::make_pair(&nodes[0]->port(2), &extra1.port(0)),
+	         std::make_pair(&extra2.port(2), &nodes[4]->port(1))};
+	BOOST_CHECK_THROW(g.connections().connect(batch), std::runtime_error);
+	BOOST_CHECK_EQUAL(g.connections().size(), 5u);
+	BOOST_CHECK(!extra1.port(0).isConnected());
+	BOOST_CHECK(!extra2.port(0).isConnected());
+
+	// a loop within the batch itself
+	batch = {std::make_pair(&extra1.port(2), &extra2.port(0)), std::make_pair(&extra2.port(2), &extra1.port(0))};
+	BOOST_CHECK_THROW(g.connections().connect(batch), std::runtime_error);
+	BOOST_CHECK_EQUAL(g.connections().size(), 5u);
+
+	// connecting a single input twice is rejected
+	batch = {std::make_pair(&extra1.port(2), &extra2.port(0)), std::make_pair(&nodes[0]->port(2), &extra2.port(0))};
+	BOOST_CHECK_THROW(g.connections().connect(batch), std::runtime_error);
+	BOOST_CHECK_EQUAL(g.connections().size(), 5u);
+
+	// extending the chain
+	batch = {std::make_pair(&nodes[0]->port(2), &extra1.port(0)), std::make_pair(&extra1.port(2), &extra2.port(1))};
+	BOOST_REQUIRE_NO_THROW(g.connections().connect(batch));
+	BOOST_CHECK_EQUAL(g.connections().size(), 7u);
+
+	BOOST_REQUIRE_NO_THROW(extra1.port(1).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(extra2.port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(extra2.port(2).get<float>(), 9.0f);
+
+	// and the order follows the batch - extending the chain from its other end is detected as a cycle
+	BOOST_CHECK_THROW(extra2.port(2).connect(nodes[5]->port(1)), std::runtime_error);
+	BOOST_CHECK_THROW(extra1.port(2).connect(nodes[2]->port(1)), std::runtime_error);
+}
@@ -0,0 +1,101 @@
+#include <dependency_graph/data.inl>
+
+#include <boost/test/unit_test.hpp>
+#include <string>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+/// a float wrapper with a user-provided copy constructor - stored on the heap
+struct HeapFloat {
+	HeapFloat(float v = 0.0f) : value(v) {
+	}
+
+	HeapFloat(const HeapFloat& f) : value(f.value) {
+	}
+
+	HeapFloat& operator=(const HeapFloat& f) = default;
+
+	bool operator==(const HeapFloat& f) const {
+		return value == f.value;
+	}
+
+	float value;
+};
+
+std::ostream& operator<<(std::ostream& out, const HeapFloat& f) {
+	out << f.value;
+	return out;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(data_inline_storage) {
+	// small trivially-copyable values are stored inline, copies are independent
+	Data f1(1.0f);
+	Data f2 = f1;
+	BOOST_CHECK_EQUAL(f1.get<float>(), 1.0f);
+	BOOST_CHECK_EQUAL(f2.get<float>(), 1.0f);
+	BOOST_CHECK(f1 == f2);
+
+	f2.set(2.0f);
+	BOOST_CHECK_EQUAL(f1.get<float>(), 1.0f);
+	BOOST_CHECK_EQUAL(f2.get<float>(), 2.0f);
+	BOOST_CHECK(f1 != f2);
+
+	f1 = f2;
+	BOOST_CHECK_EQUAL(f1.get<float>(), 2.0f);
+	BOOST_CHECK(f1 == f2);
+
+	BOOST_CHECK_EQUAL(f1.typeinfo(), typeid(float));
+	BOOST_CHECK_EQUAL(f1.type(), "float");
+
+	std::stringstream ss;
+	ss << f1;
+	BOOST_CHECK_EQUAL(ss.str(), "2");
+}
+
+BOOST_AUTO_TEST_CASE(data_heap_storage) {
+	// other values are held on the heap, shared between copies
+	Data s1(std::string("abc"));
+	Data s2 = s1;
+	BOOST_CHECK_EQUAL(&s1.get<std::string>(), &s2.get<std::string>());
+	BOOST_CHECK(s1 == s2);
+
+	s2.set(std::string("def"));
+	BOOST_CHECK_EQUAL(s1.get<std::string>(), "abc");
+	BOOST_CHECK_EQUAL(s2.get<std::string>(), "def");
+	BOOST_CHECK(s1 != s2);
+
+	Data h1(HeapFloat(3.0f));
+	Data h2 = h1;
+	BOOST_CHECK_EQUAL(h1.get<HeapFloat>().value, 3.0f);
+	BOOST_CHECK_EQUAL(&h1.get<HeapFloat>(), &h2.get<HeapFloat>());
+
+	// assigning between storage kinds via void
+	Data v;
+	BOOST_CHECK(v.empty());
+	v = h1;
+	BOOST_CHECK_EQUAL(v.get<HeapFloat>().value, 3.0f);
+	v = Data();
+	v = Data(5.0f);
+	BOOST_CHECK_EQUAL(v.get<float>(), 5.0f);
+}
+
+BOOST_AUTO_TEST_CASE(data_type_checks) {
+	Data v;
+	BOOST_CHECK_THROW(v.get<float>(), std::runtime_error);
+	BOOST_CHECK_EQUAL(v.typeinfo(), typeid(void));
+
+	Data f(1.0f);
+	BOOST_CHECK_THROW(f.get<int>(), std::runtime_error);
+	BOOST_CHECK_THROW(f.get<HeapFloat>(), std::runtime_error);
+	BOOST_CHECK_NO_THROW(f.get<float>());
+
+	// values of different types are never equal
+	BOOST_CHECK(Data(1.0f) != Data(HeapFloat(1.0f)));
+	BOOST_CHECK(Data(1u) != Data(1));
+}
@@ -0,0 +1,153 @@
+#include <dependency_graph/async_evaluation.h>
+#include <dependency_graph/detail.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+/// a network with a float input and a float output, and a deferred load of its content - a multiplication
+///   by 2, linked to the network's ports
+Network& makeDeferredNetwork(Network& parent, const std::string& name, unsigned& loads) {
+	auto networkFactoryIterator = MetadataRegister::singleton().find("network");
+	BOOST_REQUIRE(networkFactoryIterator != MetadataRegister::singleton().end());
+
+	Network& net = parent.nodes().add(*networkFactoryIterator, name).as<Network>();
+
+	std::unique_ptr<Metadata> meta = instantiateMetadata("network");
+	detail::MetadataAccess::addAttribute(*meta, "input", Attr::kInput, Data(0.0f), 0);
+	detail::MetadataAccess::addAttribute(*meta, "output", Attr::kOutput, Data(0.0f), 0);
+	meta->setCompute([](Values&) { return State(); });
+	net.setMetadata(MetadataHandle(std::move(meta)));
+
+	net.setDeferredLoad([&loads](Network& n) {
+		++loads;
+
+		NodeBase& mult = n.nodes().add(multiplicationNode(), "mult");
+		mult.port(1).set(2.0f);
+
+		n.port(0).linkTo(mult.port(0));
+		mult.port(2).linkTo(n.port(1));
+
+		State state;
+		state.addWarning("loaded");
+		return state;
+	});
+
+	return net;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(deferred_load_upstream) {
+	Graph g;
+
+	// add_1 -> network -> add_2
+	unsigned loads = 0;
+	NodeBase& add1 = g.nodes().add(additionNode(), "add_1");
+	Network& net = makeDeferredNetwork(g, "network", loads);
+	NodeBase& add2 = g.nodes().add(additionNode(), "add_2");
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(net.port(0)));
+	BOOST_REQUIRE_NO_THROW(net.port(1).connect(add2.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(add1.port(1).set(2.0f));
+	BOOST_REQUIRE_NO_THROW(add2.port(1).set(1.0f));
+
+	BOOST_CHECK(!net.isLoaded());
+	BOOST_CHECK(net.nodes().empty());
+
+	// loading the upstream of a port outside of the network's downstream doesn't load it
+	BOOST_CHECK_EQUAL(&add1.port(2).loadDeferredNetworks(), &add1.port(2));
+	BOOST_CHECK_EQUAL(add1.port(2).get<float>(), 3.0f);
+	BOOST_CHECK_EQUAL(loads, 0u);
+
+	// loading the upstream of a port in the downstream does
+	BOOST_CHECK_EQUAL(&add2.port(2).loadDeferredNetworks(), &add2.port(2));
+	BOOST_CHECK_EQUAL(loads, 1u);
+	BOOST_CHECK_EQUAL(add2.port(2).get<float>(), 7.0f);
+	BOOST_CHECK(net.isLoaded());
+	BOOST_CHECK_EQUAL(net.nodes().size(), 1u);
+
+	// the state of the loading is the state of the network
+	BOOST_REQUIRE_EQUAL(net.state().size(), 1u);
+	BOOST_CHECK_EQUAL(net.state().begin()->second, "loaded");
+
+	// and only once
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(3.0f));
+	BOOST_REQUIRE_NO_THROW(add2.port(2).loadDeferredNetworks());
+	BOOST_CHECK_EQUAL(add2.port(2).get<float>(), 11.0f);
+	BOOST_CHECK_EQUAL(loads, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(deferred_load_explicit) {
+	Graph g;
+
+	unsigned loads = 0;
+	Network& net = makeDeferredNetwork(g, "network", loads);
+	BOOST_REQUIRE_NO_THROW(net.port(0).set(4.0f));
+
+	// the loaded port belongs to the loaded network itself
+	BOOST_CHECK_EQUAL(net.port(1).loadDeferredNetworks().get<float>(), 8.0f);
+	BOOST_CHECK_EQUAL(loads, 1u);
+
+	// an explicit load (e.g., by a UI) of a network in a nested network
+	Network& nested = makeDeferredNetwork(net, "nested", loads);
+	BOOST_CHECK(!nested.isLoaded());
+
+	nested.load();
+	BOOST_CHECK(nested.isLoaded());
+	BOOST_CHECK_EQUAL(loads, 2u);
+
+	nested.load();
+	BOOST_CHECK_EQUAL(loads, 2u);
+
+	// a cleared network doesn't load anymore
+	Network& cleared = makeDeferredNetwork(g, "cleared", loads);
+	cleared.clear();
+	BOOST_CHECK(cleared.isLoaded());
+	BOOST_CHECK_EQUAL(loads, 2u);
+
+	// asynchronous evaluation requires the networks to be loaded on the calling thread first
+	Network& async = makeDeferredNetwork(g, "async", loads);
+	BOOST_REQUIRE_NO_THROW(async.port(0).set(3.0f));
+
+	auto eval = g.evaluateAsync(async.port(1).loadDeferredNetworks());
+	BOOST_CHECK_EQUAL(loads, 3u);
+	BOOST_CHECK_EQUAL(eval->get().get<float>(), 6.0f);
+
+	// a pull never loads a network (the loading changes the graph) - the network reports an error instead,
+	//   and its output keeps the default value
+	Network& pulled = makeDeferredNetwork(g, "pulled", loads);
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+	BOOST_REQUIRE_NO_THROW(pulled.port(1).connect(add.port(0)));
+	BOOST_REQUIRE_NO_THROW(pulled.port(0).set(5.0f));
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(1.0f));
+
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 1.0f);
+	BOOST_CHECK(!pulled.isLoaded());
+	BOOST_CHECK(pulled.state().errored());
+	BOOST_CHECK_EQUAL(loads, 3u);
+
+	// the next explicit load (even with a clean downstream) loads the pulled network, replacing the error
+	//   with the state of the loading
+	BOOST_CHECK(!add.port(2).isDirty());
+	BOOST_CHECK_EQUAL(add.port(2).loadDeferredNetworks().get<float>(), 11.0f);
+	BOOST_CHECK_EQUAL(loads, 4u);
+	BOOST_CHECK(pulled.isLoaded());
+	BOOST_CHECK(!pulled.state().errored());
+
+	// networks that were never loaded are destroyed with the graph
+	makeDeferredNetwork(g, "unloaded", loads);
+}
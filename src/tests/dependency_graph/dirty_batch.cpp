@@ -0,0 +1,132 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+BOOST_AUTO_TEST_CASE(dirty_batch) {
+	Graph g;
+
+	unsigned dirtyCounter = 0, batchCounter = 0, flagsCounter = 0;
+	std::vector<Port*> batchPorts;
+
+	g.onDirty([&]() { ++dirtyCounter; });
+	g.onDirtyBatch([&](const std::vector<Port*>& ports) {
+		++batchCounter;
+		batchPorts = ports;
+	});
+
+	// add1 -> add2 -> add3
+	NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+	NodeBase& add3 = g.nodes().add(additionNode(), "add3");
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+	BOOST_REQUIRE_NO_THROW(add2.port(2).connect(add3.port(0)));
+
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			n.port(p).flagsCallback([&]() { ++flagsCounter; });
+
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 0.0f);
+
+	// without a batch, each dirty flag change is reported immediately
+	dirtyCounter = 0;
+	flagsCounter = 0;
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(dirtyCounter, 5u);
+	BOOST_CHECK_EQUAL(flagsCounter, 5u);
+	BOOST_CHECK_EQUAL(batchCounter, 0u);
+
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 1.0f);
+
+	// within a batch, all changes are reported once, at the end of the outermost batch
+	dirtyCounter = 0;
+	flagsCounter = 0;
+
+	{
+		Graph::DirtyBatch batch(g);
+
+		BOOST_REQUIRE_NO_THROW(add1.port(0).set(2.0f));
+
+		{
+			Graph::DirtyBatch nested(g);
+			BOOST_REQUIRE_NO_THROW(add1.port(1).set(3.0f));
+		}
+
+		BOOST_REQUIRE_NO_THROW(add2.port(1).set(4.0f));
+
+		BOOST_CHECK(add3.port(2).isDirty());
+		BOOST_CHECK_EQUAL(dirtyCounter, 0u);
+		BOOST_CHECK_EQUAL(flagsCounter, 0u);
+		BOOST_CHECK_EQUAL(batchCounter, 0u);
+	}
+
+	BOOST_CHECK_EQUAL(dirtyCounter, 1u);
+	BOOST_CHECK_EQUAL(batchCounter, 1u);
+	BOOST_CHECK_EQUAL(flagsCounter, 5u);
+	BOOST_CHECK_EQUAL(batchPorts.size(), 5u);
+	for(Port* p : batchPorts)
+		BOOST_CHECK(p->isDirty());
+
+	// a batch that ends with the original dirty flags doesn't report any ports
+	batchCounter = 0;
+	flagsCounter = 0;
+
+	{
+		Graph::DirtyBatch batch(g);
+
+		BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 9.0f);
+		BOOST_REQUIRE_NO_THROW(add1.port(0).set(3.0f));
+	}
+
+	BOOST_CHECK_EQUAL(flagsCounter, 0u);
+	BOOST_CHECK_EQUAL(batchCounter, 1u);
+	BOOST_CHECK(batchPorts.empty());
+
+	// removing a node inside a batch removes its ports from the notification
+	batchCounter = 0;
+
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 10.0f);
+
+	{
+		Graph::DirtyBatch batch(g);
+
+		BOOST_REQUIRE_NO_THROW(add1.port(0).set(4.0f));
+
+		auto it = std::find_if(g.nodes().begin(), g.nodes().end(), [&](const NodeBase& n) { return &n == &add3; });
+		BOOST_REQUIRE(it != g.nodes().end());
+		BOOST_REQUIRE_NO_THROW(g.nodes().erase(it));
+	}
+
+	BOOST_CHECK_EQUAL(batchCounter, 1u);
+	BOOST_CHECK_EQUAL(batchPorts.size(), 3u);
+	for(Port* p : batchPorts)
+		BOOST_CHECK(&p->node() != &add3);
+
+	// clearing the network inside a batch removes all its ports from the notification
+	batchCounter = 0;
+
+	BOOST_CHECK_EQUAL(add2.port(2).get<float>(), 11.0f);
+
+	{
+		Graph::DirtyBatch batch(g);
+
+		BOOST_REQUIRE_NO_THROW(add1.port(0).set(5.0f));
+		BOOST_REQUIRE_NO_THROW(g.clear());
+	}
+
+	BOOST_CHECK_EQUAL(batchCounter, 1u);
+	BOOST_CHECK(batchPorts.empty());
+}
@@ -0,0 +1,129 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+/// a one-in-one-out node type, computing min(input, limit) and counting its evaluations
+MetadataHandle clampNode(const std::string& type, float limit, unsigned& counter) {
+	std::unique_ptr<Metadata> meta(new Metadata(type));
+
+	InAttr<float> input;
+	meta->addAttribute(input, "input");
+
+	OutAttr<float> output;
+	meta->addAttribute(output, "output");
+
+	meta->addInfluence(input, output);
+
+	meta->setCompute([input, output, limit, &counter](Values& vals) {
+		vals.set(output, std::min(vals.get(input), limit));
+
+		++counter;
+
+		return State();
+	});
+
+	return MetadataHandle(std::move(meta));
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(early_cutoff_versions) {
+	Graph g;
+
+	NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+
+	// setting a different value changes the version
+	std::size_t version = add1.port(0).version();
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_CHECK(add1.port(0).version() != version);
+
+	// setting an equal value keeps the version
+	version = add1.port(0).version();
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_CHECK_EQUAL(add1.port(0).version(), version);
+
+	// a connected input carries the version of its source output
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+	BOOST_CHECK_EQUAL(add2.port(2).get<float>(), 1.0f);
+	BOOST_CHECK_EQUAL(add2.port(0).version(), add1.port(2).version());
+}
+
+BOOST_AUTO_TEST_CASE(early_cutoff) {
+	unsigned clampCounter = 0, downstreamCounter = 0;
+
+	Graph g;
+	BOOST_CHECK(not g.earlyCutoff());
+
+	// add -> clamp -> downstream
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+	NodeBase& clamp = g.nodes().add(clampNode("clamp", 10.0f, clampCounter), "clamp");
+	NodeBase& downstream = g.nodes().add(clampNode("downstream", 100.0f, downstreamCounter), "downstream");
+
+	BOOST_REQUIRE_NO_THROW(add.port(2).connect(clamp.port(0)));
+	BOOST_REQUIRE_NO_THROW(clamp.port(1).connect(downstream.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(20.0f));
+	BOOST_CHECK_EQUAL(downstream.port(1).get<float>(), 10.0f);
+	BOOST_CHECK_EQUAL(clampCounter, 1u);
+	BOOST_CHECK_EQUAL(downstreamCounter, 1u);
+
+	// without early cutoff, an unchanged clamped value still recomputes the downstream
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(30.0f));
+	BOOST_CHECK_EQUAL(downstream.port(1).get<float>(), 10.0f);
+	BOOST_CHECK_EQUAL(clampCounter, 2u);
+	BOOST_CHECK_EQUAL(downstreamCounter, 2u);
+
+	g.setEarlyCutoff(true);
+	BOOST_CHECK(g.earlyCutoff());
+
+	// the first evaluation records the input versions
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(40.0f));
+	BOOST_CHECK_EQUAL(downstream.port(1).get<float>(), 10.0f);
+	BOOST_CHECK_EQUAL(clampCounter, 3u);
+	BOOST_CHECK_EQUAL(downstreamCounter, 3u);
+
+	// an upstream change that doesn't change the clamped value stops at the clamp node
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(50.0f));
+	BOOST_CHECK(downstream.port(1).isDirty());
+	BOOST_CHECK_EQUAL(downstream.port(1).get<float>(), 10.0f);
+	BOOST_CHECK_EQUAL(clampCounter, 4u);
+	BOOST_CHECK_EQUAL(downstreamCounter, 3u);
+
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			BOOST_CHECK(not n.port(p).isDirty());
+
+	// setting an equal value doesn't recompute anything
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(50.0f));
+	BOOST_CHECK_EQUAL(downstream.port(1).get<float>(), 10.0f);
+	BOOST_CHECK_EQUAL(clampCounter, 4u);
+	BOOST_CHECK_EQUAL(downstreamCounter, 3u);
+
+	// a changed value propagates normally
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(5.0f));
+	BOOST_CHECK_EQUAL(downstream.port(1).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(clampCounter, 5u);
+	BOOST_CHECK_EQUAL(downstreamCounter, 4u);
+
+	// reconnecting the same output keeps all versions - nothing is recomputed
+	BOOST_REQUIRE_NO_THROW(clamp.port(1).disconnect(downstream.port(0)));
+	BOOST_REQUIRE_NO_THROW(clamp.port(1).connect(downstream.port(0)));
+	BOOST_CHECK_EQUAL(downstream.port(1).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(clampCounter, 5u);
+	BOOST_CHECK_EQUAL(downstreamCounter, 4u);
+}
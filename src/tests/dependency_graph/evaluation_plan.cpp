@@ -0,0 +1,113 @@
+#include <dependency_graph/evaluation_plan.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+BOOST_AUTO_TEST_CASE(evaluation_plan_compilation) {
+	Graph g;
+
+	// two chained additions
+	//   add1 -> add2
+	NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+
+	std::shared_ptr<const EvaluationPlan> plan = g.evaluationPlan(add2.port(2));
+	BOOST_REQUIRE(plan != nullptr);
+	BOOST_CHECK_EQUAL(&plan->output(), &add2.port(2));
+
+	// all upstream ports, in topological order - the output port itself is not part of the plan
+	BOOST_REQUIRE_EQUAL(plan->size(), 5u);
+
+	BOOST_CHECK_EQUAL((*plan)[0].port, &add1.port(0));
+	BOOST_CHECK_EQUAL((*plan)[0].kind, EvaluationPlan::Step::kClean);
+	BOOST_CHECK_EQUAL((*plan)[1].port, &add1.port(1));
+	BOOST_CHECK_EQUAL((*plan)[1].kind, EvaluationPlan::Step::kClean);
+	BOOST_CHECK_EQUAL((*plan)[2].port, &add1.port(2));
+	BOOST_CHECK_EQUAL((*plan)[2].kind, EvaluationPlan::Step::kCompute);
+	BOOST_CHECK_EQUAL((*plan)[3].port, &add2.port(0));
+	BOOST_CHECK_EQUAL((*plan)[3].kind, EvaluationPlan::Step::kCopy);
+	BOOST_CHECK_EQUAL((*plan)[3].source, &add1.port(2));
+	BOOST_CHECK_EQUAL((*plan)[4].port, &add2.port(1));
+	BOOST_CHECK_EQUAL((*plan)[4].kind, EvaluationPlan::Step::kClean);
+
+	// dependencies always point to preceding steps
+	for(std::size_t s = 0; s < plan->size(); ++s)
+		for(auto d = plan->dependenciesBegin(s); d != plan->dependenciesEnd(s); ++d)
+			BOOST_CHECK_LT(*d, s);
+
+	BOOST_CHECK_EQUAL(std::distance(plan->dependenciesBegin(2), plan->dependenciesEnd(2)), 2);
+	BOOST_CHECK_EQUAL(std::distance(plan->dependenciesBegin(3), plan->dependenciesEnd(3)), 1);
+	BOOST_CHECK_EQUAL(*plan->dependenciesBegin(3), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(evaluation_plan_caching) {
+	Graph g;
+
+	//   add1 -> add2 -> add3
+	NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+	NodeBase& add3 = g.nodes().add(additionNode(), "add3");
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+	BOOST_REQUIRE_NO_THROW(add2.port(2).connect(add3.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(add1.port(1).set(2.0f));
+	BOOST_REQUIRE_NO_THROW(add2.port(1).set(3.0f));
+	BOOST_REQUIRE_NO_THROW(add3.port(1).set(4.0f));
+
+	// evaluation through the plan
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 10.0f);
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			BOOST_CHECK(not n.port(p).isDirty());
+
+	// the plan is cached - value changes don't invalidate it
+	std::shared_ptr<const EvaluationPlan> plan = g.evaluationPlan(add3.port(2));
+	BOOST_CHECK_EQUAL(plan, g.evaluationPlan(add3.port(2)));
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(5.0f));
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 14.0f);
+	BOOST_CHECK_EQUAL(plan, g.evaluationPlan(add3.port(2)));
+
+	// connection change invalidates all plans
+	BOOST_REQUIRE_NO_THROW(add2.port(2).disconnect(add3.port(0)));
+	std::shared_ptr<const EvaluationPlan> disconnected = g.evaluationPlan(add3.port(2));
+	BOOST_CHECK(plan != disconnected);
+	BOOST_CHECK_EQUAL(disconnected->size(), 2u);
+
+	// a disconnected input keeps its last value
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 14.0f);
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add3.port(0)));
+	BOOST_CHECK(disconnected != g.evaluationPlan(add3.port(2)));
+	BOOST_CHECK_EQUAL(g.evaluationPlan(add3.port(2))->size(), 5u);
+
+	BOOST_CHECK_EQUAL(add3.port(2).get<float>(), 11.0f);
+
+	// node removal invalidates all plans
+	plan = g.evaluationPlan(add3.port(2));
+	g.nodes().erase(g.nodes().find(add2.index()));
+	BOOST_CHECK(plan != g.evaluationPlan(add3.port(2)));
+
+	// metadata change invalidates all plans
+	BOOST_REQUIRE_NO_THROW(add1.port(2).disconnect(add3.port(0)));
+	plan = g.evaluationPlan(add1.port(2));
+	BOOST_REQUIRE_NO_THROW(add1.setMetadata(multiplicationNode()));
+	BOOST_CHECK(plan != g.evaluationPlan(add1.port(2)));
+
+	BOOST_REQUIRE_NO_THROW(add1.port(0).set(2.0f));
+	BOOST_REQUIRE_NO_THROW(add1.port(1).set(3.0f));
+	BOOST_CHECK_EQUAL(add1.port(2).get<float>(), 6.0f);
+}
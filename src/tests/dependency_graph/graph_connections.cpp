@@ -189,3 +189,47 @@ BOOST_AUTO_TEST_CASE(graph_connections) {
 
 	BOOST_CHECK_EQUAL(s_connectionCount, 0u);
 }
+
+BOOST_AUTO_TEST_CASE(graph_connections_adjacency) {
+	Graph g;
+
+	NodeBase& add1 = g.nodes().add(additionNode(), "add_1");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add_2");
+	NodeBase& add3 = g.nodes().add(additionNode(), "add_3");
+
+	BOOST_CHECK(g.connections().connectedTo(add1.port(2)).empty());
+	BOOST_CHECK(not g.connections().connectedFrom(add2.port(0)));
+	BOOST_CHECK(not g.connections().isConnected(add1));
+
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(0)));
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add3.port(1)));
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(1)));
+
+	// connected inputs, in the order of connection
+	auto range = g.connections().connectedTo(add1.port(2));
+	BOOST_REQUIRE_EQUAL(range.size(), 3u);
+	BOOST_CHECK_EQUAL(&range[0].get(), &add2.port(0));
+	BOOST_CHECK_EQUAL(&range[1].get(), &add3.port(1));
+	BOOST_CHECK_EQUAL(&range[2].get(), &add2.port(1));
+
+	for(Port& p : g.connections().connectedTo(add1.port(2))) {
+		BOOST_REQUIRE(g.connections().connectedFrom(p));
+		BOOST_CHECK_EQUAL(&*g.connections().connectedFrom(p), &add1.port(2));
+	}
+
+	BOOST_CHECK(g.connections().isConnected(add1));
+	BOOST_CHECK(g.connections().isConnected(add3));
+
+	// iteration over all connections is ordered by the output port
+	BOOST_REQUIRE_EQUAL(g.connections().size(), 3u);
+	BOOST_REQUIRE(checkConnections(
+	    g, {{&add1.port(2), &add2.port(0)}, {&add1.port(2), &add3.port(1)}, {&add1.port(2), &add2.port(1)}}));
+
+	// disconnecting keeps the order of the remaining connections
+	BOOST_REQUIRE_NO_THROW(add1.port(2).disconnect(add3.port(1)));
+	BOOST_REQUIRE_EQUAL(g.connections().connectedTo(add1.port(2)).size(), 2u);
+	BOOST_CHECK_EQUAL(&g.connections().connectedTo(add1.port(2)).front().get(), &add2.port(0));
+	BOOST_CHECK_EQUAL(&g.connections().connectedTo(add1.port(2)).back().get(), &add2.port(1));
+	BOOST_CHECK(not g.connections().isConnected(add3));
+	BOOST_CHECK(not add3.port(1).isConnected());
+}
@@ -0,0 +1,243 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/memory_governor.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <map>
+#include <numeric>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+/// a large value type
+struct Buffer {
+	std::vector<float> values;
+
+	bool operator==(const Buffer& b) const {
+		return values == b.values;
+	}
+};
+
+std::ostream& operator<<(std::ostream& out, const Buffer& b) {
+	out << "(" << b.values.size() << " values)";
+	return out;
+}
+
+}  // namespace
+
+namespace dependency_graph {
+
+template <>
+struct DataSize<Buffer> {
+	static std::size_t size(const Buffer& value) {
+		return DataSize<std::vector<float>>::size(value.values);
+	}
+};
+
+}  // namespace dependency_graph
+
+namespace {
+
+// number of computes of each node type
+std::map<std::string, unsigned> s_computeCount;
+
+/// creates a buffer of ones
+const MetadataHandle& bufferSourceNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("buffer_source"));
+
+		static InAttr<unsigned> size;
+		meta->addAttribute(size, "size");
+
+		static OutAttr<Buffer> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(size, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["buffer_source"];
+
+			Buffer result;
+			result.values.resize(vals.get(size), 1.0f);
+			vals.set(output, std::move(result));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// multiplies all elements of a buffer
+const MetadataHandle& bufferScaleNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("buffer_scale"));
+
+		static InAttr<Buffer> input;
+		meta->addAttribute(input, "input");
+
+		static InAttr<float> factor;
+		meta->addAttribute(factor, "factor", 1.0f);
+
+		static OutAttr<Buffer> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+		meta->addInfluence(factor, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["buffer_scale"];
+
+			Buffer result = vals.get(input);
+			for(auto& v : result.values)
+				v *= vals.get(factor);
+			vals.set(output, std::move(result));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// sums all elements of a buffer
+const MetadataHandle& bufferSumNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("buffer_sum"));
+
+		static InAttr<Buffer> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["buffer_sum"];
+
+			const Buffer& in = vals.get(input);
+			vals.set(output, std::accumulate(in.values.begin(), in.values.end(), 0.0f));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(memory_governor) {
+	s_computeCount.clear();
+
+	Graph g;
+
+	// source -> scale1 -> scale2 -> sum, each buffer value takes ~4kB
+	NodeBase& source = g.nodes().add(bufferSourceNode(), "source");
+	NodeBase& scale1 = g.nodes().add(bufferScaleNode(), "scale1");
+	NodeBase& scale2 = g.nodes().add(bufferScaleNode(), "scale2");
+	NodeBase& sum = g.nodes().add(bufferSumNode(), "sum");
+
+	BOOST_REQUIRE_NO_THROW(source.port(1).connect(scale1.port(0)));
+	BOOST_REQUIRE_NO_THROW(scale1.port(2).connect(scale2.port(0)));
+	BOOST_REQUIRE_NO_THROW(scale2.port(2).connect(sum.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(1000u));
+	BOOST_REQUIRE_NO_THROW(scale1.port(1).set(2.0f));
+	BOOST_REQUIRE_NO_THROW(scale2.port(1).set(3.0f));
+
+	// a large budget doesn't evict anything
+	std::shared_ptr<MemoryGovernor> governor(new MemoryGovernor(1024 * 1024));
+	g.setMemoryGovernor(governor);
+	BOOST_CHECK(g.memoryGovernor() == governor);
+
+	BOOST_CHECK_EQUAL(sum.port(1).get<float>(), 6000.0f);
+	BOOST_CHECK_GT(governor->usage(), 3 * 1000 * sizeof(float));
+	BOOST_CHECK_EQUAL(governor->evictions(), 0u);
+
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			BOOST_CHECK(not n.port(p).isDirty());
+
+	// a budget of two buffers evicts the least recently pulled one - the source
+	governor->setBudget(2 * 1000 * sizeof(float) + 1024);
+	BOOST_REQUIRE_NO_THROW(scale2.port(1).set(4.0f));
+	BOOST_CHECK_EQUAL(sum.port(1).get<float>(), 8000.0f);
+
+	BOOST_CHECK_EQUAL(governor->evictions(), 1u);
+	BOOST_CHECK_LE(governor->usage(), governor->budget());
+	BOOST_CHECK(source.port(1).isDirty());
+	BOOST_CHECK(scale1.port(0).isDirty());
+	BOOST_CHECK(not scale1.port(2).isDirty());
+	BOOST_CHECK(not sum.port(1).isDirty());
+	BOOST_CHECK_EQUAL(s_computeCount["buffer_source"], 1u);
+
+	// the evicted upstream of a clean port is not recomputed
+	BOOST_REQUIRE_NO_THROW(scale2.port(1).set(5.0f));
+	BOOST_CHECK_EQUAL(sum.port(1).get<float>(), 10000.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["buffer_source"], 1u);
+	BOOST_CHECK(source.port(1).isDirty());
+
+	// an evicted value is recomputed on demand
+	BOOST_CHECK_EQUAL(scale1.port(0).get<Buffer>().values.size(), 1000u);
+	BOOST_CHECK_EQUAL(s_computeCount["buffer_source"], 2u);
+	BOOST_CHECK(not source.port(1).isDirty());
+
+	// a change upstream of evicted ports still invalidates the downstream
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(10u));
+	BOOST_CHECK(sum.port(1).isDirty());
+	BOOST_CHECK_EQUAL(sum.port(1).get<float>(), 100.0f);
+
+	// pinned values are never evicted
+	s_computeCount.clear();
+
+	sum.port(0).setPinned(true);
+	BOOST_CHECK(sum.port(0).isPinned());
+
+	governor->setBudget(0);
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(1000u));
+	BOOST_CHECK_EQUAL(sum.port(1).get<float>(), 10000.0f);
+
+	BOOST_CHECK(source.port(1).isDirty());
+	BOOST_CHECK(scale1.port(2).isDirty());
+	BOOST_CHECK(not scale2.port(2).isDirty());
+	BOOST_CHECK(not sum.port(0).isDirty());
+
+	// the evicted inputs of scale2 require the whole upstream to be recomputed
+	BOOST_REQUIRE_NO_THROW(scale2.port(1).set(1.0f));
+	BOOST_CHECK_EQUAL(sum.port(1).get<float>(), 2000.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["buffer_source"], 2u);
+	BOOST_CHECK_EQUAL(s_computeCount["buffer_scale"], 4u);
+
+	// removing the governor stops the eviction
+	g.setMemoryGovernor(std::shared_ptr<MemoryGovernor>());
+	BOOST_CHECK_EQUAL(governor->usage(), 0u);
+
+	BOOST_REQUIRE_NO_THROW(source.port(0).set(10u));
+	BOOST_CHECK_EQUAL(sum.port(1).get<float>(), 20.0f);
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			BOOST_CHECK(not n.port(p).isDirty());
+}
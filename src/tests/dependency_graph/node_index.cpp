@@ -0,0 +1,92 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+#include <dependency_graph/node.h>
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+#include <set>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+BOOST_AUTO_TEST_CASE(node_index) {
+	Graph g;
+	BOOST_CHECK(g.nodeIndex().empty());
+
+	auto networkFactoryIterator = MetadataRegister::singleton().find("network");
+	BOOST_REQUIRE(networkFactoryIterator != MetadataRegister::singleton().end());
+
+	// add_1, network (mult_1, nested (add_2, add_3)), mult_2
+	NodeBase& add1 = g.nodes().add(additionNode(), "add_1");
+	Network& network = g.nodes().add(*networkFactoryIterator, "network").as<Network>();
+	NodeBase& mult1 = network.nodes().add(multiplicationNode(), "mult_1");
+	Network& nested = network.nodes().add(*networkFactoryIterator, "nested").as<Network>();
+	NodeBase& add2 = nested.nodes().add(additionNode(), "add_2");
+	NodeBase& add3 = nested.nodes().add(additionNode(), "add_3");
+	NodeBase& mult2 = g.nodes().add(multiplicationNode(), "mult_2");
+
+	// the index contains all nodes of all networks
+	BOOST_CHECK_EQUAL(g.nodeIndex().size(), 7u);
+
+	std::set<const NodeBase*> indexed;
+	for(const NodeBase& n : g.nodeIndex())
+		indexed.insert(&n);
+	BOOST_CHECK(indexed == std::set<const NodeBase*>({&add1, &network, &mult1, &nested, &add2, &add3, &mult2}));
+
+	for(const NodeBase* n : indexed)
+		BOOST_CHECK_EQUAL(g.nodeIndex().find(n->index()), n);
+
+	// direct lookups
+	BOOST_CHECK_EQUAL(&g.nodes()[add1.index()], &add1);
+	BOOST_CHECK_EQUAL(&nested.nodes()[add3.index()], &add3);
+	BOOST_CHECK(g.nodes().find(add2.index()) == g.nodes().end());
+	BOOST_CHECK(nested.nodes().find(add2.index()) != nested.nodes().end());
+
+	// a recursive find returns an iterator that continues the recursive iteration
+	std::vector<const NodeBase*> recursive;
+	for(auto it = g.nodes().begin(Nodes::kRecursive); it != g.nodes().end(); ++it)
+		recursive.push_back(&(*it));
+	BOOST_REQUIRE_EQUAL(recursive.size(), 7u);
+
+	for(std::size_t i = 0; i < recursive.size(); ++i) {
+		auto it = g.nodes().find(recursive[i]->index(), Nodes::kRecursive);
+		for(std::size_t j = i; j < recursive.size(); ++j) {
+			BOOST_REQUIRE(it != g.nodes().end());
+			BOOST_CHECK_EQUAL(&(*it), recursive[j]);
+			++it;
+		}
+		BOOST_CHECK(it == g.nodes().end());
+	}
+
+	// a recursive find in a nested network doesn't find nodes outside of it
+	BOOST_CHECK(network.nodes().find(add3.index(), Nodes::kRecursive) != network.nodes().end());
+	BOOST_CHECK(network.nodes().find(mult2.index(), Nodes::kRecursive) == network.nodes().end());
+
+	// removing a network removes all its nodes from the index
+	const UniqueId nestedId = nested.index(), add2Id = add2.index();
+
+	auto it = network.nodes().find(nestedId);
+	BOOST_REQUIRE(it != network.nodes().end());
+	network.nodes().erase(it);
+
+	BOOST_CHECK_EQUAL(g.nodeIndex().size(), 4u);
+	BOOST_CHECK(g.nodeIndex().find(nestedId) == nullptr);
+	BOOST_CHECK(g.nodeIndex().find(add2Id) == nullptr);
+	BOOST_CHECK(g.nodes().find(add2Id, Nodes::kRecursive) == g.nodes().end());
+	BOOST_CHECK_EQUAL(g.nodeIndex().find(mult1.index()), &mult1);
+
+	// nodes added with an existing id keep the id order
+	const UniqueId add1Id = add1.index();
+	g.nodes().erase(g.nodes().find(add1Id));
+	NodeBase& readded = g.nodes().add(additionNode(), "add_1", Data(), boost::none, add1Id);
+	BOOST_CHECK_EQUAL(&(*g.nodes().begin()), &readded);
+	BOOST_CHECK_EQUAL(g.nodeIndex().find(add1Id), &readded);
+
+	g.clear();
+	BOOST_CHECK(g.nodeIndex().empty());
+}
@@ -0,0 +1,154 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+/// records the thread and the number of evaluations of each node type
+struct Recorder {
+	void record(const std::string& type) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		++counts[type];
+		threads[type] = std::this_thread::get_id();
+	}
+
+	std::mutex mutex;
+	std::map<std::string, unsigned> counts;
+	std::map<std::string, std::thread::id> threads;
+};
+
+/// a slow one-in-one-out node type, incrementing its input value and recording its evaluation
+MetadataHandle recordingNode(const std::string& type, unsigned flags, Recorder& recorder) {
+	std::unique_ptr<Metadata> meta(new Metadata(type));
+
+	InAttr<float> input;
+	meta->addAttribute(input, "input");
+
+	OutAttr<float> output;
+	meta->addAttribute(output, "output");
+
+	meta->addInfluence(input, output);
+
+	meta->setFlags(flags);
+
+	meta->setCompute([input, output, type, &recorder](Values& vals) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+		vals.set(output, vals.get(input) + 1.0f);
+
+		recorder.record(type);
+
+		return State();
+	});
+
+	return MetadataHandle(std::move(meta));
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(parallel_evaluation) {
+	Recorder recorder;
+
+	Graph g;
+	BOOST_CHECK(not g.parallelEvaluation());
+
+	g.setParallelEvaluation(true);
+	BOOST_CHECK(g.parallelEvaluation());
+
+	// two independent branches, merged by an addition node:
+	//   a1 -> a2 -> a3 -> add
+	//   b1 -> b2 (main thread only) -> add
+	NodeBase& a1 = g.nodes().add(recordingNode("a1", Metadata::kNoFlags, recorder), "a1");
+	NodeBase& a2 = g.nodes().add(recordingNode("a2", Metadata::kNoFlags, recorder), "a2");
+	NodeBase& a3 = g.nodes().add(recordingNode("a3", Metadata::kNoFlags, recorder), "a3");
+	NodeBase& b1 = g.nodes().add(recordingNode("b1", Metadata::kNoFlags, recorder), "b1");
+	NodeBase& b2 = g.nodes().add(recordingNode("b2", Metadata::kMainThreadOnly, recorder), "b2");
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+
+	BOOST_REQUIRE_NO_THROW(a1.port(1).connect(a2.port(0)));
+	BOOST_REQUIRE_NO_THROW(a2.port(1).connect(a3.port(0)));
+	BOOST_REQUIRE_NO_THROW(a3.port(1).connect(add.port(0)));
+	BOOST_REQUIRE_NO_THROW(b1.port(1).connect(b2.port(0)));
+	BOOST_REQUIRE_NO_THROW(b2.port(1).connect(add.port(1)));
+
+	BOOST_REQUIRE_NO_THROW(a1.port(0).set(1.0f));
+	BOOST_REQUIRE_NO_THROW(b1.port(0).set(10.0f));
+
+	// evaluate the whole graph - (1 + 3) + (10 + 2)
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 16.0f);
+
+	for(auto& n : g.nodes())
+		for(std::size_t p = 0; p < n.portCount(); ++p)
+			BOOST_CHECK(not n.port(p).isDirty());
+
+	// each node evaluated exactly once
+	for(auto& t : {"a1", "a2", "a3", "b1", "b2"})
+		BOOST_CHECK_EQUAL(recorder.counts[t], 1u);
+
+	// the pinned node has been evaluated on the main thread
+	BOOST_CHECK(recorder.threads["b2"] == std::this_thread::get_id());
+
+	// re-evaluation without any change doesn't compute anything
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 16.0f);
+	for(auto& t : {"a1", "a2", "a3", "b1", "b2"})
+		BOOST_CHECK_EQUAL(recorder.counts[t], 1u);
+
+	// changing one branch only evaluates the changed branch
+	BOOST_REQUIRE_NO_THROW(b1.port(0).set(20.0f));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 26.0f);
+
+	for(auto& t : {"a1", "a2", "a3"})
+		BOOST_CHECK_EQUAL(recorder.counts[t], 1u);
+	for(auto& t : {"b1", "b2"})
+		BOOST_CHECK_EQUAL(recorder.counts[t], 2u);
+
+	// the result is the same as serial evaluation
+	g.setParallelEvaluation(false);
+	BOOST_REQUIRE_NO_THROW(a1.port(0).set(2.0f));
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 27.0f);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_evaluation_shared_upstream) {
+	Recorder recorder;
+
+	Graph g;
+	g.setParallelEvaluation(true);
+
+	// a "diamond" - a single upstream node feeding two branches
+	//   src -> left  -> add
+	//       -> right -> add
+	NodeBase& src = g.nodes().add(recordingNode("src", Metadata::kNoFlags, recorder), "src");
+	NodeBase& left = g.nodes().add(recordingNode("left", Metadata::kNoFlags, recorder), "left");
+	NodeBase& right = g.nodes().add(recordingNode("right", Metadata::kMainThreadOnly, recorder), "right");
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+
+	BOOST_REQUIRE_NO_THROW(src.port(1).connect(left.port(0)));
+	BOOST_REQUIRE_NO_THROW(src.port(1).connect(right.port(0)));
+	BOOST_REQUIRE_NO_THROW(left.port(1).connect(add.port(0)));
+	BOOST_REQUIRE_NO_THROW(right.port(1).connect(add.port(1)));
+
+	BOOST_REQUIRE_NO_THROW(src.port(0).set(5.0f));
+
+	// (5 + 2) + (5 + 2)
+	BOOST_CHECK_EQUAL(add.port(2).get<float>(), 14.0f);
+
+	// the shared upstream node is evaluated only once
+	for(auto& t : {"src", "left", "right"})
+		BOOST_CHECK_EQUAL(recorder.counts[t], 1u);
+}
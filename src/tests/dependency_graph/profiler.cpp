@@ -0,0 +1,73 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+#include <dependency_graph/profiler.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <sstream>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+BOOST_AUTO_TEST_CASE(profiler) {
+	Graph g;
+
+	// add -> mult
+	NodeBase& add = g.nodes().add(additionNode(), "add");
+	NodeBase& mult = g.nodes().add(multiplicationNode(), "mult");
+	BOOST_REQUIRE_NO_THROW(add.port(2).connect(mult.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(add.port(0).set(2.0f));
+	BOOST_REQUIRE_NO_THROW(mult.port(1).set(3.0f));
+
+	// without a profiler, nothing is recorded
+	BOOST_CHECK(g.profiler() == nullptr);
+	BOOST_CHECK_EQUAL(mult.port(2).get<float>(), 6.0f);
+
+	std::shared_ptr<Profiler> profiler(new Profiler());
+	g.setProfiler(profiler);
+	BOOST_CHECK(g.profiler() == profiler);
+
+	BOOST_REQUIRE_NO_THROW(add.port(1).set(1.0f));
+	BOOST_CHECK_EQUAL(mult.port(2).get<float>(), 9.0f);
+
+	// upstream first - add's output, its transfer to mult's input, and mult's output
+	const std::vector<Profiler::Event> events = profiler->events();
+	BOOST_REQUIRE_EQUAL(events.size(), 3u);
+
+	BOOST_CHECK_EQUAL(events[0].kind, Profiler::Event::kCompute);
+	BOOST_CHECK_EQUAL(events[0].port, "network/add/output");
+	BOOST_CHECK_EQUAL(events[0].nodeType, "addition");
+	BOOST_CHECK_EQUAL(events[0].size, sizeof(float));
+	BOOST_CHECK(not events[0].errored);
+
+	BOOST_CHECK_EQUAL(events[1].kind, Profiler::Event::kInput);
+	BOOST_CHECK_EQUAL(events[1].port, "network/mult/input_1");
+
+	BOOST_CHECK_EQUAL(events[2].kind, Profiler::Event::kCompute);
+	BOOST_CHECK_EQUAL(events[2].port, "network/mult/output");
+
+	// mult's pull time includes the whole upstream evaluation
+	BOOST_CHECK(events[2].start <= events[0].start);
+	BOOST_CHECK(events[2].pull >= events[0].pull + events[0].compute);
+
+	for(auto& e : events)
+		BOOST_CHECK(e.thread == std::this_thread::get_id());
+
+	// trace export
+	std::stringstream trace;
+	profiler->writeChromeTrace(trace);
+	BOOST_CHECK(trace.str().find("{\"traceEvents\":[") == 0);
+	BOOST_CHECK(trace.str().find("\"name\":\"network/mult/output\",\"cat\":\"compute\",\"ph\":\"X\"") !=
+	            std::string::npos);
+	BOOST_CHECK(trace.str().find("\"node_type\":\"multiplication\"") != std::string::npos);
+
+	profiler->clear();
+	BOOST_CHECK(profiler->events().empty());
+}
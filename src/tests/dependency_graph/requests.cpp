@@ -0,0 +1,248 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/memory_governor.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <map>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+// number of computes of each node type
+std::map<std::string, unsigned> s_computeCount;
+
+// the last request seen by the compute of a node not supporting requests
+Request s_fullRequest;
+
+/// a "source" supporting requests - its result depends on the requested level and region
+const MetadataHandle& sourceNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("request_source"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setFlags(Metadata::kSupportsRequests);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["source"];
+
+			vals.set(output, vals.get(input) + (float)(vals.request().level() * 100 + vals.request().x()));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// doubles its input, supporting requests
+const MetadataHandle& doubleNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("request_double"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setFlags(Metadata::kSupportsRequests);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["double"];
+
+			vals.set(output, vals.get(input) * 2.0f);
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// increments its input, without supporting requests
+const MetadataHandle& incrementNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("request_increment"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["increment"];
+			s_fullRequest = vals.request();
+
+			vals.set(output, vals.get(input) + 1.0f);
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(request_coverage) {
+	// a full request covers everything
+	BOOST_CHECK(Request().isFull());
+	BOOST_CHECK(Request().covers(Request(1)));
+	BOOST_CHECK(Request().covers(Request(10, 10, 5, 5, 2)));
+
+	// a region covers smaller regions at the same or lower resolution
+	const Request region(10, 0, 5, 5, 1);
+	BOOST_CHECK(not region.isFull());
+	BOOST_CHECK(region.covers(Request(12, 1, 2, 2, 1)));
+	BOOST_CHECK(region.covers(Request(10, 0, 5, 5, 3)));
+	BOOST_CHECK(not region.covers(Request(12, 1, 2, 2, 0)));
+	BOOST_CHECK(not region.covers(Request(12, 1, 4, 2, 1)));
+	BOOST_CHECK(not region.covers(Request(1)));
+	BOOST_CHECK(not region.covers(Request()));
+
+	BOOST_CHECK(Request(1).covers(Request(2)));
+	BOOST_CHECK(not Request(2).covers(Request(1)));
+	BOOST_CHECK_EQUAL(Request(2).scale(), 0.25f);
+}
+
+BOOST_AUTO_TEST_CASE(request_evaluation) {
+	s_computeCount.clear();
+
+	// src -> dbl (both supporting requests)
+	//     -> inc (full only)
+	Graph g;
+	NodeBase& src = g.nodes().add(sourceNode(), "src");
+	NodeBase& dbl = g.nodes().add(doubleNode(), "dbl");
+	NodeBase& inc = g.nodes().add(incrementNode(), "inc");
+
+	BOOST_REQUIRE_NO_THROW(src.port(1).connect(dbl.port(0)));
+	BOOST_REQUIRE_NO_THROW(src.port(1).connect(inc.port(0)));
+	BOOST_REQUIRE_NO_THROW(src.port(0).set(1.0f));
+
+	// a pull with a request evaluates the whole upstream for the same request
+	const Request region(10, 0, 5, 5, 1);
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(region), 222.0f);
+	BOOST_CHECK_EQUAL(dbl.port(1).request(), region);
+	BOOST_CHECK_EQUAL(src.port(1).request(), region);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 1u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 1u);
+
+	// a covered request reuses the value
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(Request(12, 1, 2, 2, 1)), 222.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 1u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 1u);
+
+	// a different request is evaluated
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(Request(0, 0, 5, 5, 1)), 202.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 2u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 2u);
+
+	// switching back reuses the cached value (without evaluating the upstream)
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(region), 222.0f);
+	BOOST_CHECK_EQUAL(dbl.port(1).request(), region);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 2u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 2u);
+
+	// a full pull evaluates the full result, which is then valid for any request
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(), 2.0f);
+	BOOST_CHECK(dbl.port(1).request().isFull());
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(region), 2.0f);
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(Request(2)), 2.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 3u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 3u);
+
+	// a node not supporting requests computes its full result, from full inputs
+	BOOST_CHECK_EQUAL(inc.port(1).get<float>(region), 2.0f);
+	BOOST_CHECK(s_fullRequest.isFull());
+	BOOST_CHECK(inc.port(1).request().isFull());
+	BOOST_CHECK_EQUAL(s_computeCount["increment"], 1u);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 3u);
+
+	// a change invalidates the values of all requests
+	BOOST_REQUIRE_NO_THROW(src.port(0).set(2.0f));
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(region), 224.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 4u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 4u);
+
+	// the full result of a node not supporting requests re-evaluates an upstream evaluated for a region
+	BOOST_CHECK_EQUAL(inc.port(1).get<float>(region), 3.0f);
+	BOOST_CHECK(s_fullRequest.isFull());
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 5u);
+	BOOST_CHECK_EQUAL(s_computeCount["increment"], 2u);
+
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(), 4.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 5u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 5u);
+
+	// the same with the parallel evaluation
+	g.setParallelEvaluation(true);
+	BOOST_REQUIRE_NO_THROW(src.port(0).set(3.0f));
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(region), 226.0f);
+	BOOST_CHECK_EQUAL(inc.port(1).get<float>(region), 4.0f);
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(), 6.0f);
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(region), 6.0f);
+	BOOST_CHECK_EQUAL(s_computeCount["source"], 7u);
+	BOOST_CHECK_EQUAL(s_computeCount["double"], 7u);
+	BOOST_CHECK_EQUAL(s_computeCount["increment"], 3u);
+}
+
+BOOST_AUTO_TEST_CASE(request_cache_memory) {
+	Graph g;
+
+	auto governor = std::make_shared<MemoryGovernor>(std::size_t(1) << 30);
+	g.setMemoryGovernor(governor);
+
+	// src -> dbl (both supporting requests)
+	NodeBase& src = g.nodes().add(sourceNode(), "src");
+	NodeBase& dbl = g.nodes().add(doubleNode(), "dbl");
+
+	BOOST_REQUIRE_NO_THROW(src.port(1).connect(dbl.port(0)));
+	BOOST_REQUIRE_NO_THROW(src.port(0).set(1.0f));
+
+	const Request region(10, 0, 5, 5, 1);
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(region), 222.0f);
+	const std::size_t usage = governor->usage();
+	BOOST_CHECK(usage > 0);
+
+	// the values of previous requests, kept for reuse, are accounted for as well
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(Request(0, 0, 5, 5, 1)), 202.0f);
+	BOOST_CHECK(governor->usage() > usage);
+
+	// and released with the values of their ports
+	BOOST_REQUIRE_NO_THROW(src.port(0).set(2.0f));
+	BOOST_CHECK_EQUAL(dbl.port(1).get<float>(), 4.0f);
+	BOOST_CHECK_EQUAL(governor->usage(), usage);
+}
@@ -0,0 +1,210 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+#include <dependency_graph/node.h>
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <map>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+// the "application time" read by the time source computes
+float s_time = 0.0f;
+
+// number of computes of each node type
+std::map<std::string, unsigned> s_computeCount;
+
+/// a time source, outputting the current frame (the time rounded down)
+const MetadataHandle& frameNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("time_frame"));
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "frame");
+
+		meta->setFlags(Metadata::kTimeSource);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["frame"];
+
+			vals.set(output, std::floor(s_time));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// increments its input, counting its computes
+const MetadataHandle& incrementNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("time_increment"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_computeCount["increment"];
+
+			vals.set(output, vals.get(input) + 1.0f);
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(time_source_registry) {
+	Graph g;
+	BOOST_CHECK(g.nodeIndex().timeSources().empty());
+
+	auto networkFactoryIterator = MetadataRegister::singleton().find("network");
+	BOOST_REQUIRE(networkFactoryIterator != MetadataRegister::singleton().end());
+
+	// frame_1, add, network (frame_2)
+	NodeBase& frame1 = g.nodes().add(frameNode(), "frame_1");
+	g.nodes().add(additionNode(), "add");
+	Network& network = g.nodes().add(*networkFactoryIterator, "network").as<Network>();
+	NodeBase& frame2 = network.nodes().add(frameNode(), "frame_2");
+
+	// only the time sources are registered, including the ones in nested networks
+	std::vector<NodeBase*> sources = g.nodeIndex().timeSources();
+	std::sort(sources.begin(), sources.end());
+
+	std::vector<NodeBase*> expected = {&frame1, &frame2};
+	std::sort(expected.begin(), expected.end());
+
+	BOOST_CHECK(sources == expected);
+
+	// removing a network removes its time sources from the registry
+	auto it = g.nodes().find(network.index());
+	BOOST_REQUIRE(it != g.nodes().end());
+	g.nodes().erase(it);
+
+	BOOST_REQUIRE_EQUAL(g.nodeIndex().timeSources().size(), 1u);
+	BOOST_CHECK_EQUAL(g.nodeIndex().timeSources()[0], &frame1);
+
+	// changing the metadata of a node updates the registry
+	frame1.setMetadata(additionNode());
+	BOOST_CHECK(g.nodeIndex().timeSources().empty());
+}
+
+BOOST_AUTO_TEST_CASE(time_dependency) {
+	Graph g;
+
+	// frame -> add1 -> add2, and a static add3 -> add4
+	NodeBase& frame = g.nodes().add(frameNode(), "frame");
+	NodeBase& add1 = g.nodes().add(additionNode(), "add1");
+	NodeBase& add2 = g.nodes().add(additionNode(), "add2");
+	NodeBase& add3 = g.nodes().add(additionNode(), "add3");
+	NodeBase& add4 = g.nodes().add(additionNode(), "add4");
+
+	BOOST_REQUIRE_NO_THROW(frame.port(0).connect(add1.port(0)));
+	BOOST_REQUIRE_NO_THROW(add1.port(2).connect(add2.port(1)));
+	BOOST_REQUIRE_NO_THROW(add3.port(2).connect(add4.port(0)));
+
+	// the time source and its downstream are time-dependent
+	BOOST_CHECK(g.isTimeDependent(frame.port(0)));
+	BOOST_CHECK(g.isTimeDependent(add1.port(0)));
+	BOOST_CHECK(g.isTimeDependent(add1.port(2)));
+	BOOST_CHECK(g.isTimeDependent(add2.port(1)));
+	BOOST_CHECK(g.isTimeDependent(add2.port(2)));
+
+	// inputs not connected to a time source, and the static part of the graph, are not
+	BOOST_CHECK(!g.isTimeDependent(add1.port(1)));
+	BOOST_CHECK(!g.isTimeDependent(add2.port(0)));
+	for(std::size_t p = 0; p < 3; ++p) {
+		BOOST_CHECK(!g.isTimeDependent(add3.port(p)));
+		BOOST_CHECK(!g.isTimeDependent(add4.port(p)));
+	}
+
+	// connecting the static part to the time-dependent one updates the analysis
+	BOOST_REQUIRE_NO_THROW(add2.port(2).connect(add3.port(1)));
+	BOOST_CHECK(g.isTimeDependent(add3.port(2)));
+	BOOST_CHECK(g.isTimeDependent(add4.port(2)));
+	BOOST_CHECK(!g.isTimeDependent(add3.port(0)));
+
+	BOOST_REQUIRE_NO_THROW(add2.port(2).disconnect(add3.port(1)));
+	BOOST_CHECK(!g.isTimeDependent(add4.port(2)));
+
+	// a newly added time source is time-dependent as well
+	NodeBase& frame2 = g.nodes().add(frameNode(), "frame2");
+	BOOST_CHECK(g.isTimeDependent(frame2.port(0)));
+}
+
+BOOST_AUTO_TEST_CASE(time_change) {
+	for(bool earlyCutoff : {false, true}) {
+		Graph g;
+		g.setEarlyCutoff(earlyCutoff);
+
+		// frame -> timed, and an independent static node
+		NodeBase& frame = g.nodes().add(frameNode(), "frame");
+		NodeBase& timed = g.nodes().add(incrementNode(), "timed");
+		NodeBase& stat = g.nodes().add(incrementNode(), "static");
+
+		BOOST_REQUIRE_NO_THROW(frame.port(0).connect(timed.port(0)));
+		BOOST_REQUIRE_NO_THROW(stat.port(0).set(10.0f));
+
+		s_time = 1.0f;
+		s_computeCount.clear();
+
+		BOOST_CHECK_EQUAL(timed.port(1).get<float>(), 2.0f);
+		BOOST_CHECK_EQUAL(stat.port(1).get<float>(), 11.0f);
+		BOOST_CHECK_EQUAL(s_computeCount["frame"], 1u);
+		BOOST_CHECK_EQUAL(s_computeCount["increment"], 2u);
+
+		// a time change invalidates only the time-dependent part of the graph
+		s_time = 2.0f;
+		g.invalidateTimeSources();
+
+		BOOST_CHECK(frame.port(0).isDirty());
+		BOOST_CHECK(timed.port(1).isDirty());
+		BOOST_CHECK(!stat.port(1).isDirty());
+
+		s_computeCount.clear();
+		BOOST_CHECK_EQUAL(timed.port(1).get<float>(), 3.0f);
+		BOOST_CHECK_EQUAL(stat.port(1).get<float>(), 11.0f);
+		BOOST_CHECK_EQUAL(s_computeCount["frame"], 1u);
+		BOOST_CHECK_EQUAL(s_computeCount["increment"], 1u);
+
+		// a time change within the same frame re-evaluates the time source (which doesn't have any
+		//   inputs, but is never skipped by the early cutoff), and its unchanged value stops the
+		//   recomputation of its downstream if early cutoff is enabled
+		s_time = 2.5f;
+		g.invalidateTimeSources();
+
+		s_computeCount.clear();
+		BOOST_CHECK_EQUAL(timed.port(1).get<float>(), 3.0f);
+		BOOST_CHECK_EQUAL(s_computeCount["frame"], 1u);
+		BOOST_CHECK_EQUAL(s_computeCount["increment"], earlyCutoff ? 0u : 1u);
+	}
+}
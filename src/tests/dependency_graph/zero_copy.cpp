@@ -0,0 +1,217 @@
+#include <dependency_graph/graph.h>
+#include <dependency_graph/node.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/datablock.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+#include <numeric>
+#include <vector>
+
+#include "common.h"
+
+using namespace dependency_graph;
+
+namespace {
+
+/// a large value type, counting its deep copies and moves
+struct Counted {
+	Counted() = default;
+
+	Counted(const Counted& c) : values(c.values) {
+		++s_copies;
+	}
+
+	Counted(Counted&& c) : values(std::move(c.values)) {
+		++s_moves;
+	}
+
+	Counted& operator=(const Counted& c) {
+		values = c.values;
+		++s_copies;
+		return *this;
+	}
+
+	Counted& operator=(Counted&& c) {
+		values = std::move(c.values);
+		++s_moves;
+		return *this;
+	}
+
+	bool operator==(const Counted& c) const {
+		return values == c.values;
+	}
+
+	std::vector<float> values;
+
+	static unsigned s_copies, s_moves;
+};
+
+unsigned Counted::s_copies = 0;
+unsigned Counted::s_moves = 0;
+
+std::ostream& operator<<(std::ostream& out, const Counted& c) {
+	out << "(" << c.values.size() << " values)";
+	return out;
+}
+
+/// creates a Counted instance with a number of values
+const MetadataHandle& sourceNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("source"));
+
+		static InAttr<unsigned> size;
+		meta->addAttribute(size, "size");
+
+		static OutAttr<Counted> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(size, output);
+
+		meta->setCompute([](Values& vals) {
+			Counted result;
+			result.values.resize(vals.get(size), 1.0f);
+
+			vals.set(output, std::move(result));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// passes a Counted value through, without touching it
+const MetadataHandle& passthroughNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("passthrough"));
+
+		static InAttr<Counted> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<Counted> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			vals.copy(input, output);
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// sums all values of a Counted value
+const MetadataHandle& sumNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("sum"));
+
+		static InAttr<Counted> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<float> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			const Counted& in = vals.get(input);
+			vals.set(output, std::accumulate(in.values.begin(), in.values.end(), 0.0f));
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(zero_copy_data) {
+	Counted::s_copies = 0;
+	Counted::s_moves = 0;
+
+	// an rvalue is moved straight into the holder
+	Counted c;
+	c.values.resize(10);
+	Data d(std::move(c));
+	BOOST_CHECK_EQUAL(Counted::s_copies, 0u);
+	BOOST_CHECK_EQUAL(Counted::s_moves, 1u);
+
+	// copies of Data share the holder
+	Data d2 = d;
+	Data d3(d2);
+	BOOST_CHECK_EQUAL(&d3.get<Counted>(), &d.get<Counted>());
+	BOOST_CHECK(d3 == d);
+	BOOST_CHECK_EQUAL(Counted::s_copies, 0u);
+
+	// moving a Data leaves the source empty
+	Data d4(std::move(d3));
+	BOOST_CHECK(d3.empty());
+	BOOST_CHECK_EQUAL(&d4.get<Counted>(), &d.get<Counted>());
+
+	// setting an lvalue copies it exactly once, and doesn't touch the source
+	Counted c2;
+	c2.values.resize(5);
+	d4.set(c2);
+	BOOST_CHECK_EQUAL(c2.values.size(), 5u);
+	BOOST_CHECK_EQUAL(d4.get<Counted>().values.size(), 5u);
+	BOOST_CHECK_EQUAL(Counted::s_copies, 1u);
+	BOOST_CHECK_EQUAL(Counted::s_moves, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(zero_copy_chain) {
+	Graph g;
+
+	// source -> passthrough -> passthrough -> 3x sum
+	NodeBase& source = g.nodes().add(sourceNode(), "source");
+	NodeBase& pass1 = g.nodes().add(passthroughNode(), "pass1");
+	NodeBase& pass2 = g.nodes().add(passthroughNode(), "pass2");
+
+	BOOST_REQUIRE_NO_THROW(source.port(1).connect(pass1.port(0)));
+	BOOST_REQUIRE_NO_THROW(pass1.port(1).connect(pass2.port(0)));
+
+	std::vector<NodeBase*> sums;
+	for(unsigned i = 0; i < 3; ++i) {
+		sums.push_back(&g.nodes().add(sumNode(), "sum_" + std::to_string(i)));
+		BOOST_REQUIRE_NO_THROW(pass2.port(1).connect(sums.back()->port(0)));
+	}
+
+	for(unsigned size : {100u, 1000u}) {
+		Counted::s_copies = 0;
+		Counted::s_moves = 0;
+
+		BOOST_REQUIRE_NO_THROW(source.port(0).set(size));
+		for(NodeBase* s : sums)
+			BOOST_CHECK_EQUAL(s->port(1).get<float>(), float(size));
+
+		// the value is moved once into its holder, and never copied along the chain
+		BOOST_CHECK_EQUAL(Counted::s_copies, 0u);
+		BOOST_CHECK_EQUAL(Counted::s_moves, 1u);
+
+		// all ports share the same value instance
+		const Counted* value = &source.port(1).get<Counted>();
+		BOOST_CHECK_EQUAL(&pass1.port(0).get<Counted>(), value);
+		BOOST_CHECK_EQUAL(&pass2.port(1).get<Counted>(), value);
+		for(NodeBase* s : sums)
+			BOOST_CHECK_EQUAL(&s->port(0).get<Counted>(), value);
+	}
+}
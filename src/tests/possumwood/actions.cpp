@@ -163,4 +163,36 @@ BOOST_AUTO_TEST_CASE(actions_single_node_value) {
 	BOOST_CHECK_EQUAL(app.undoStack().redoActionCount(), 0u);
 }
 
+BOOST_AUTO_TEST_CASE(actions_merged_values) {
+	possumwood::AppCore app;
+
+	NodeBase& node = app.graph().nodes().add(additionNode(), "add_1");
+
+	// a series of mergeable changes (e.g., dragging a slider) forms a single undo step
+	for(float v = 1.0f; v <= 5.0f; v += 1.0f)
+		BOOST_REQUIRE_NO_THROW(possumwood::actions::setValue(node.port(0), v, true));
+
+	BOOST_CHECK_EQUAL(node.port(2).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(app.undoStack().undoActionCount(), 1u);
+
+	// a change of a different port is a separate step
+	BOOST_REQUIRE_NO_THROW(possumwood::actions::setValue(node.port(1), 2.0f, true));
+	BOOST_CHECK_EQUAL(app.undoStack().undoActionCount(), 2u);
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().undo());
+	BOOST_CHECK_EQUAL(node.port(2).get<float>(), 5.0f);
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().undo());
+	BOOST_CHECK_EQUAL(node.port(0).get<float>(), 0.0f);
+	BOOST_CHECK_EQUAL(node.port(2).get<float>(), 0.0f);
+
+	BOOST_REQUIRE_NO_THROW(app.undoStack().redo());
+	BOOST_CHECK_EQUAL(node.port(0).get<float>(), 5.0f);
+
+	// non-mergeable changes are never merged
+	BOOST_REQUIRE_NO_THROW(possumwood::actions::setValue(node.port(0), 6.0f));
+	BOOST_REQUIRE_NO_THROW(possumwood::actions::setValue(node.port(0), 7.0f));
+	BOOST_CHECK_EQUAL(app.undoStack().undoActionCount(), 3u);
+}
+
 /// TODO: connections and evaluation tests
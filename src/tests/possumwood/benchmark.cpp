@@ -0,0 +1,139 @@
+#include <actions/actions.h>
+#include <actions/filepath.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/selection.h>
+#include <possumwood_sdk/app.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <dependency_graph/nodes_iterator.inl>
+#include <vector>
+
+#include "../../apps/common.h"
+
+// Scene loading benchmark, reported as test messages (run possumwood_benchmark with --log_level=message).
+// Loads all scenes from the toolbars/ and examples/ directories with all plugins, but without any UI
+// or GL context - each scene both with and without a bulk build of the graph. Timings are not checked,
+// only that the scenes load.
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// all .psw files in a directory (recursively), in alphabetical order
+std::vector<fs::path> scenes(const fs::path& dir) {
+	std::vector<fs::path> result;
+
+	if(fs::exists(dir))
+		for(fs::recursive_directory_iterator it(dir); it != fs::recursive_directory_iterator(); ++it)
+			if(fs::is_regular_file(it->status()) && it->path().extension() == ".psw")
+				result.push_back(it->path());
+
+	std::sort(result.begin(), result.end());
+
+	return result;
+}
+
+/// builds the graph of a scene the same way as App::loadFile() (excluding the parsing), optionally
+/// without a bulk build; returns the time in milliseconds. The callbacks counter is reset after clearing
+/// the previous scene.
+double load(possumwood::App& app, const nlohmann::json& json, bool bulkBuild, dependency_graph::State& state,
+            unsigned& callbacks) {
+	app.graph().clear();
+	app.undoStack().clear();
+	callbacks = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	{
+		dependency_graph::Graph::DirtyBatch dirtyBatch(app.graph());
+
+		dependency_graph::Selection selection;
+		state = possumwood::actions::fromJson(app.graph(), selection, json, false, bulkBuild);
+	}
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// returns the number of nodes of the graph - nodes of networks with a deferred load are not counted
+///   (they were not instantiated)
+std::size_t nodeCount(possumwood::App& app) {
+	return std::distance(app.graph().nodes().begin(dependency_graph::Nodes::kRecursive), app.graph().nodes().end());
+}
+
+/// clears the graph of the application before the plugins owning the metadata of its nodes are unloaded
+struct ClearGraph {
+	~ClearGraph() {
+		possumwood::App::instance().graph().clear();
+	}
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(benchmark_scene_loading) {
+	possumwood::App app;
+
+	if(!fs::exists(possumwood::Filepath::fromString("$PLUGINS").toPath())) {
+		BOOST_TEST_MESSAGE("Scene loading benchmark skipped - no plugins found");
+		return;
+	}
+
+	PluginsRAII plugins;
+
+	std::vector<fs::path> files = scenes(possumwood::Filepath::fromString("$TOOLBARS").toPath());
+	for(auto& f : scenes(possumwood::Filepath::fromString("$EXAMPLES").toPath()))
+		files.push_back(f);
+
+	// UI-like callbacks
+	unsigned callbacks = 0;
+	boost::signals2::scoped_connection addNode =
+	    app.graph().onAddNode([&](dependency_graph::NodeBase&) { ++callbacks; });
+	boost::signals2::scoped_connection connect =
+	    app.graph().onConnect([&](dependency_graph::Port&, dependency_graph::Port&) { ++callbacks; });
+	boost::signals2::scoped_connection dirty = app.graph().onDirty([&]() { ++callbacks; });
+
+	ClearGraph clearGraph;
+
+	double total = 0.0, bulkTotal = 0.0;
+	std::size_t nodes = 0;
+	unsigned totalCallbacks = 0, bulkCallbacks = 0;
+
+	for(auto& f : files) {
+		nlohmann::json json;
+		{
+			fs::ifstream in(f);
+			BOOST_REQUIRE_NO_THROW(in >> json);
+		}
+
+		dependency_graph::State state, bulkState;
+
+		// the same scene, built individually and in a bulk build
+		const double time = load(app, json, false, state, callbacks);
+		const std::size_t count = nodeCount(app);
+		totalCallbacks += callbacks;
+
+		const double bulkTime = load(app, json, true, bulkState, callbacks);
+		bulkCallbacks += callbacks;
+
+		BOOST_CHECK_EQUAL(count, nodeCount(app));
+
+		total += time;
+		bulkTotal += bulkTime;
+		nodes += count;
+
+		// errors (e.g., a plugin that failed to load) don't stop the benchmark
+		if(state.errored() || bulkState.errored())
+			BOOST_TEST_MESSAGE("  " << f.string() << " loaded with errors");
+		BOOST_TEST_MESSAGE("  " << f.string() << ": " << count << " nodes, individually " << time
+		                        << "ms, in a bulk build " << bulkTime << "ms");
+	}
+
+	BOOST_CHECK(!files.empty());
+
+	BOOST_TEST_MESSAGE("Loading " << files.size() << " scenes (" << nodes << " nodes), individually: " << total
+	                              << "ms (" << totalCallbacks << " callbacks), in a bulk build: "
+	                              << bulkTotal << "ms (" << bulkCallbacks << " callbacks)");
+}
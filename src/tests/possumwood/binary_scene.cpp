@@ -0,0 +1,169 @@
+#include <actions/actions.h>
+#include <actions/binary_scene.h>
+#include <actions/filesystem_mock.h>
+#include <actions/io.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+#include <dependency_graph/rtti.h>
+#include <possumwood_sdk/app.h>
+
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+using nlohmann::json;
+
+namespace {
+
+dependency_graph::NodeBase& findNode(dependency_graph::Network& net, const std::string& name) {
+	for(auto& n : net.nodes())
+		if(n.name() == name)
+			return n;
+
+	BOOST_REQUIRE(false && "Node not found, fail");
+	throw;
+}
+
+json readJson(possumwood::IFilesystem& filesystem, const std::string& filename) {
+	json result;
+
+	auto stream = filesystem.read(possumwood::Filepath::fromString(filename));
+
+	(*stream) >> result;
+
+	return result;
+}
+
+/// a network with a nested network, connections and blind data
+void makeScene(possumwood::App& app) {
+	auto networkFactoryIterator = MetadataRegister::singleton().find("network");
+	BOOST_REQUIRE(networkFactoryIterator != MetadataRegister::singleton().end());
+
+	NodeBase& a = app.graph().nodes().add(additionNode(), "add");
+	a.port(0).set<float>(2.0f);
+	a.port(1).set<float>(4.0f);
+
+	Network& net = app.graph().nodes().add(*networkFactoryIterator, "test_network").as<Network>();
+
+	NodeBase& add = net.nodes().add(additionNode(), "add");
+	add.port(0).set<float>(1.0f);
+	add.port(1).set<float>(3.0f);
+
+	NodeBase& m = net.nodes().add(multiplicationNode(), "mult");
+	m.port(1).set<float>(5.0f);
+	m.setBlindData<std::string>("test blind data");
+
+	add.port(2).connect(m.port(0));
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(binary_scene_round_trip) {
+	auto filesystem = std::make_shared<possumwood::FilesystemMock>();
+
+	possumwood::App app(filesystem);
+
+	// make sure the static handles are initialised
+	additionNode();
+	multiplicationNode();
+
+	makeScene(app);
+
+	// the reference json file
+	BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("scene.psw"), false));
+	const json result = readJson(*filesystem, "scene.psw");
+
+	// the binary file is not a json file
+	BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("scene.pswb"), false));
+	{
+		auto stream = filesystem->read(possumwood::Filepath::fromString("scene.pswb"));
+		BOOST_CHECK(possumwood::BinarySceneReader::isBinaryScene(*stream));
+	}
+
+	// loading the binary file leads to the same scene
+	app.newFile();
+	BOOST_REQUIRE(app.graph().nodes().empty());
+
+	dependency_graph::State state;
+	BOOST_REQUIRE_NO_THROW(state = app.loadFile(possumwood::Filepath::fromString("scene.pswb")));
+	BOOST_CHECK(!state.errored());
+
+	BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("scene_too.psw"), false));
+	BOOST_CHECK_EQUAL(readJson(*filesystem, "scene_too.psw"), result);
+
+	// and loading a json file still works after that
+	BOOST_REQUIRE_NO_THROW(state = app.loadFile(possumwood::Filepath::fromString("scene.psw")));
+	BOOST_CHECK(!state.errored());
+
+	BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("scene_three.psw"), false));
+	BOOST_CHECK_EQUAL(readJson(*filesystem, "scene_three.psw"), result);
+}
+
+BOOST_AUTO_TEST_CASE(binary_scene_values) {
+	auto filesystem = std::make_shared<possumwood::FilesystemMock>();
+
+	possumwood::App app(filesystem);
+
+	additionNode();
+	multiplicationNode();
+
+	makeScene(app);
+
+	BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("scene.psw"), false));
+	const json result = readJson(*filesystem, "scene.psw");
+
+	{
+		// a binary serialization of floats, only while saving and loading the binary scene
+		unsigned written = 0, read = 0;
+		possumwood::BinaryIO<float> binaryIO(
+		    [&written](std::ostream& out, const float& f) {
+			    out.write(reinterpret_cast<const char*>(&f), sizeof(float));
+			    ++written;
+		    },
+		    [&read](std::istream& in, float& f) {
+			    in.read(reinterpret_cast<char*>(&f), sizeof(float));
+			    ++read;
+		    });
+
+		BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("scene.pswb"), false));
+
+		// all unconnected float inputs are stored as binary values, referenced from the scene
+		BOOST_CHECK_EQUAL(written, 5u);
+		{
+			auto stream = filesystem->read(possumwood::Filepath::fromString("scene.pswb"));
+			possumwood::BinarySceneReader reader(*stream);
+
+			const json& ports = reader.scene()["nodes"]["addition_0"]["ports"];
+			BOOST_CHECK(ports["input_1"].is_object());
+			BOOST_CHECK(ports["input_1"].find("$binary") != ports["input_1"].end());
+		}
+
+		app.newFile();
+
+		dependency_graph::State state;
+		BOOST_REQUIRE_NO_THROW(state = app.loadFile(possumwood::Filepath::fromString("scene.pswb")));
+		BOOST_CHECK(!state.errored());
+		BOOST_CHECK_EQUAL(read, 5u);
+	}
+
+	// the values are the same as in the original scene
+	BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("scene_too.psw"), false));
+	BOOST_CHECK_EQUAL(readJson(*filesystem, "scene_too.psw"), result);
+
+	Network& net = findNode(app.graph(), "test_network").as<Network>();
+	BOOST_CHECK_EQUAL(findNode(net, "mult").port(2).get<float>(), 20.0f);
+
+	// a reference to a binary value outside of a binary scene is an error
+	filesystem->addFile(possumwood::Filepath::fromString("broken.psw"),
+	                    "{\"nodes\":{\"addition_0\":{\"name\":\"add\", \"type\":\"addition\", "
+	                    "\"ports\":{\"input_1\":{\"$binary\":0}}}}, \"connections\":[], \"name\":\"network\", "
+	                    "\"type\":\"network\"}");
+
+	dependency_graph::State state;
+	BOOST_REQUIRE_NO_THROW(state = app.loadFile(possumwood::Filepath::fromString("broken.psw")));
+	BOOST_CHECK(state.errored());
+}
@@ -0,0 +1,204 @@
+#include <actions/disk_cache.h>
+#include <actions/io.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/metadata_register.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/data.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+
+using namespace dependency_graph;
+
+namespace {
+
+/// a value with a binary serialization only
+struct Heavy {
+	std::vector<float> values;
+};
+
+std::ostream& operator<<(std::ostream& out, const Heavy& h) {
+	out << "(" << h.values.size() << " values)";
+	return out;
+}
+
+/// a value without any serialization
+struct Opaque {
+	float value = 0.0f;
+};
+
+std::ostream& operator<<(std::ostream& out, const Opaque& o) {
+	out << o.value;
+	return out;
+}
+
+unsigned s_heavyCount = 0;
+unsigned s_opaqueCount = 0;
+
+/// generates a Heavy value with N elements, counting its computes
+const MetadataHandle& heavyNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("disk_cache_heavy"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<Heavy> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_heavyCount;
+
+			Heavy result;
+			for(unsigned i = 0; i < 1000; ++i)
+				result.values.push_back(vals.get(input) * (float)i);
+			vals.set(output, result);
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// generates an Opaque value, counting its computes
+const MetadataHandle& opaqueNode() {
+	static std::unique_ptr<MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<Metadata> meta(new Metadata("disk_cache_opaque"));
+
+		static InAttr<float> input;
+		meta->addAttribute(input, "input");
+
+		static OutAttr<Opaque> output;
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([](Values& vals) {
+			++s_opaqueCount;
+
+			Opaque result;
+			result.value = vals.get(input);
+			vals.set(output, result);
+
+			return State();
+		});
+
+		s_handle.reset(new MetadataHandle(std::move(meta)));
+	}
+
+	return *s_handle;
+}
+
+/// a temporary cache directory, removed on destruction
+struct TempDir {
+	TempDir() : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("disk_cache_%%%%%%%%")) {
+	}
+
+	~TempDir() {
+		boost::system::error_code ec;
+		boost::filesystem::remove_all(path, ec);
+	}
+
+	std::size_t fileCount() const {
+		return std::distance(boost::filesystem::directory_iterator(path), boost::filesystem::directory_iterator());
+	}
+
+	boost::filesystem::path path;
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(disk_cache_binary_roundtrip) {
+	possumwood::BinaryIO<Heavy> binaryIO(
+	    [](std::ostream& out, const Heavy& h) {
+		    const std::uint64_t size = h.values.size();
+		    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		    out.write(reinterpret_cast<const char*>(h.values.data()), h.values.size() * sizeof(float));
+	    },
+	    [](std::istream& in, Heavy& h) {
+		    std::uint64_t size = 0;
+		    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+		    h.values.resize(size);
+		    in.read(reinterpret_cast<char*>(h.values.data()), h.values.size() * sizeof(float));
+	    });
+
+	TempDir dir;
+	auto cache = std::make_shared<possumwood::DiskCache>(dir.path, std::chrono::steady_clock::duration(0));
+
+	s_heavyCount = 0;
+
+	// the first evaluation computes the value, and stores it in the cache
+	{
+		Graph g;
+		g.setComputeCache(cache);
+
+		NodeBase& n = g.nodes().add(heavyNode(), "heavy");
+		n.port(0).set(2.0f);
+
+		const Heavy& h = n.port(1).get<Heavy>();
+		BOOST_REQUIRE_EQUAL(h.values.size(), 1000u);
+		BOOST_CHECK_EQUAL(h.values[10], 20.0f);
+	}
+
+	BOOST_CHECK_EQUAL(s_heavyCount, 1u);
+	BOOST_CHECK_EQUAL(dir.fileCount(), 1u);
+
+	// an identical graph loads the value from the cache, without computing it
+	{
+		Graph g;
+		g.setComputeCache(cache);
+
+		NodeBase& n = g.nodes().add(heavyNode(), "heavy");
+		n.port(0).set(2.0f);
+
+		const Heavy& h = n.port(1).get<Heavy>();
+		BOOST_REQUIRE_EQUAL(h.values.size(), 1000u);
+		BOOST_CHECK_EQUAL(h.values[10], 20.0f);
+		BOOST_CHECK_EQUAL(h.values[999], 1998.0f);
+
+		BOOST_CHECK_EQUAL(s_heavyCount, 1u);
+
+		// a different input value is a cache miss
+		n.port(0).set(3.0f);
+
+		BOOST_CHECK_EQUAL(n.port(1).get<Heavy>().values[10], 30.0f);
+		BOOST_CHECK_EQUAL(s_heavyCount, 2u);
+	}
+
+	BOOST_CHECK_EQUAL(dir.fileCount(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(disk_cache_unstorable) {
+	TempDir dir;
+	auto cache = std::make_shared<possumwood::DiskCache>(dir.path, std::chrono::steady_clock::duration(0));
+
+	s_opaqueCount = 0;
+
+	// values without any serialization are always computed, and never stored
+	for(unsigned a = 0; a < 2; ++a) {
+		Graph g;
+		g.setComputeCache(cache);
+
+		NodeBase& n = g.nodes().add(opaqueNode(), "opaque");
+		n.port(0).set(5.0f);
+
+		BOOST_CHECK_EQUAL(n.port(1).get<Opaque>().value, 5.0f);
+		BOOST_CHECK_EQUAL(s_opaqueCount, a + 1);
+	}
+
+	BOOST_CHECK_EQUAL(dir.fileCount(), 0u);
+}
@@ -0,0 +1,385 @@
+#include <actions/actions.h>
+#include <actions/disk_cache.h>
+#include <actions/filesystem_mock.h>
+#include <dependency_graph/graph.h>
+#include <dependency_graph/memory_governor.h>
+#include <dependency_graph/metadata_register.h>
+#include <possumwood_sdk/app.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <dependency_graph/attr.inl>
+#include <dependency_graph/metadata.inl>
+#include <dependency_graph/node_base.inl>
+#include <dependency_graph/nodes.inl>
+#include <dependency_graph/port.inl>
+#include <dependency_graph/values.inl>
+
+#include "common.h"
+
+using namespace dependency_graph;
+using nlohmann::json;
+
+namespace {
+
+dependency_graph::NodeBase& findNode(dependency_graph::Network& net, const std::string& name) {
+	for(auto& n : net.nodes())
+		if(n.name() == name)
+			return n;
+
+	BOOST_REQUIRE(false && "Node not found, fail");
+	throw;
+}
+
+json readJson(possumwood::IFilesystem& filesystem, const std::string& filename) {
+	json result;
+
+	auto stream = filesystem.read(possumwood::Filepath::fromString(filename));
+
+	(*stream) >> result;
+
+	return result;
+}
+
+unsigned s_evaluations = 0;
+
+/// a float pass-through node counting its evaluations
+const dependency_graph::MetadataHandle& countingNode() {
+	static std::unique_ptr<dependency_graph::MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<dependency_graph::Metadata> meta(new dependency_graph::Metadata("counting"));
+
+		static dependency_graph::InAttr<float> input;
+		static dependency_graph::OutAttr<float> output;
+
+		meta->addAttribute(input, "input");
+		meta->addAttribute(output, "output");
+
+		meta->addInfluence(input, output);
+
+		meta->setCompute([&](dependency_graph::Values& data) {
+			++s_evaluations;
+			data.set(output, data.get(input));
+
+			return dependency_graph::State();
+		});
+
+		s_handle =
+		    std::unique_ptr<dependency_graph::MetadataHandle>(new dependency_graph::MetadataHandle(std::move(meta)));
+
+		dependency_graph::MetadataRegister::singleton().add(*s_handle);
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(instanced_networks) {
+	auto filesystem = std::make_shared<possumwood::FilesystemMock>();
+
+	possumwood::App app(filesystem);
+
+	// make sure the static handles are initialised
+	additionNode();
+	countingNode();
+
+	json subnetwork(
+	    {{"nodes",
+	      {{"input_0", {{"name", "in"}, {"type", "input"}}},
+	       {"counting_0", {{"name", "counting"}, {"type", "counting"}}},
+	       {"output_0", {{"name", "out"}, {"type", "output"}}}}},
+	     {"connections",
+	      {{{"in_node", "counting_0"}, {"in_port", "input"}, {"out_node", "input_0"}, {"out_port", "data"}},
+	       {{"in_node", "output_0"}, {"in_port", "data"}, {"out_node", "counting_0"}, {"out_port", "output"}}}},
+	     {"name", "network"},
+	     {"type", "network"}});
+	(*filesystem->write(possumwood::Filepath::fromString("instance.psw"))) << subnetwork;
+
+	// four instances of the same network - one connected, three with their own input values
+	json setup(
+	    {{"nodes",
+	      {{"addition_0", {{"name", "add"}, {"type", "addition"}, {"ports", {{"input_1", 1.0}, {"input_2", 2.0}}}}},
+	       {"network_0",
+	        {{"name", "net_a"}, {"type", "network"}, {"source", "instance.psw"}, {"instanced", true}}},
+	       {"network_1",
+	        {{"name", "net_b"},
+	         {"type", "network"},
+	         {"source", "instance.psw"},
+	         {"instanced", true},
+	         {"ports", {{"in", 5.0}}}}},
+	       {"network_2",
+	        {{"name", "net_c"},
+	         {"type", "network"},
+	         {"source", "instance.psw"},
+	         {"instanced", true},
+	         {"ports", {{"in", 5.0}}}}},
+	       {"network_3",
+	        {{"name", "net_d"},
+	         {"type", "network"},
+	         {"source", "instance.psw"},
+	         {"instanced", true},
+	         {"ports", {{"in", 7.0}}}}}}},
+	     {"connections",
+	      {{{"in_node", "network_0"}, {"in_port", "in"}, {"out_node", "addition_0"}, {"out_port", "output"}}}},
+	     {"name", "network"},
+	     {"type", "network"}});
+	(*filesystem->write(possumwood::Filepath::fromString("setup.psw"))) << setup;
+
+	dependency_graph::State state;
+	BOOST_REQUIRE_NO_THROW(state = app.loadFile(possumwood::Filepath::fromString("setup.psw")));
+	BOOST_REQUIRE(!state.errored());
+
+	Network& netA = findNode(app.graph(), "net_a").as<Network>();
+	Network& netB = findNode(app.graph(), "net_b").as<Network>();
+	Network& netC = findNode(app.graph(), "net_c").as<Network>();
+	Network& netD = findNode(app.graph(), "net_d").as<Network>();
+
+	// the instances don't have any content, just their ports and values
+	for(Network* net : {&netA, &netB, &netC, &netD}) {
+		BOOST_CHECK(net->nodes().empty());
+		BOOST_REQUIRE_EQUAL(net->portCount(), 2u);
+		BOOST_CHECK(net->metadata() == netA.metadata());
+	}
+
+	// instances with the same inputs share a single evaluation
+	s_evaluations = 0;
+	BOOST_CHECK_EQUAL(netB.port(1).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(netC.port(1).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 1u);
+
+	BOOST_CHECK_EQUAL(netD.port(1).get<float>(), 7.0f);
+	BOOST_CHECK_EQUAL(netA.port(1).get<float>(), 3.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 3u);
+
+	// changing an input re-evaluates only the changed instance, reusing previous results where possible
+	BOOST_REQUIRE_NO_THROW(findNode(app.graph(), "add").port(0).set(3.0f));
+	BOOST_CHECK_EQUAL(netA.port(1).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(netD.port(1).get<float>(), 7.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 3u);
+
+	BOOST_REQUIRE_NO_THROW(netD.port(0).set(9.0f));
+	BOOST_CHECK_EQUAL(netD.port(1).get<float>(), 9.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 4u);
+
+	// the instances are saved as references, with their own input values
+	BOOST_REQUIRE_NO_THROW(app.saveFile(possumwood::Filepath::fromString("setup_too.psw"), false));
+	const json saved = readJson(*filesystem, "setup_too.psw");
+
+	for(auto& n : saved["nodes"]) {
+		if(n["type"] == "network") {
+			BOOST_CHECK_EQUAL(n["source"], "instance.psw");
+			BOOST_CHECK_EQUAL(n["instanced"], true);
+			BOOST_CHECK(n.find("nodes") == n.end());
+		}
+
+		if(n["name"] == "net_d")
+			BOOST_CHECK_EQUAL(n["ports"]["in"], 9.0);
+	}
+}
+
+namespace {
+
+float s_time = 0.0f;
+
+/// a time source outputting the "application time" of this test
+const dependency_graph::MetadataHandle& timeNode() {
+	static std::unique_ptr<dependency_graph::MetadataHandle> s_handle;
+
+	if(s_handle == nullptr) {
+		std::unique_ptr<dependency_graph::Metadata> meta(new dependency_graph::Metadata("instanced_time"));
+
+		static dependency_graph::OutAttr<float> output;
+		meta->addAttribute(output, "time");
+
+		meta->setFlags(dependency_graph::Metadata::kTimeSource);
+
+		meta->setCompute([&](dependency_graph::Values& data) {
+			data.set(output, s_time);
+
+			return dependency_graph::State();
+		});
+
+		s_handle =
+		    std::unique_ptr<dependency_graph::MetadataHandle>(new dependency_graph::MetadataHandle(std::move(meta)));
+
+		dependency_graph::MetadataRegister::singleton().add(*s_handle);
+	}
+
+	return *s_handle;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(instanced_time_sources) {
+	auto filesystem = std::make_shared<possumwood::FilesystemMock>();
+
+	possumwood::App app(filesystem);
+
+	// make sure the static handles are initialised
+	additionNode();
+	countingNode();
+	timeNode();
+
+	// in + time -> counting -> out
+	json subnetwork(
+	    {{"nodes",
+	      {{"input_0", {{"name", "in"}, {"type", "input"}}},
+	       {"time_0", {{"name", "time"}, {"type", "instanced_time"}}},
+	       {"addition_0", {{"name", "add"}, {"type", "addition"}}},
+	       {"counting_0", {{"name", "counting"}, {"type", "counting"}}},
+	       {"output_0", {{"name", "out"}, {"type", "output"}}}}},
+	     {"connections",
+	      {{{"in_node", "addition_0"}, {"in_port", "input_1"}, {"out_node", "input_0"}, {"out_port", "data"}},
+	       {{"in_node", "addition_0"}, {"in_port", "input_2"}, {"out_node", "time_0"}, {"out_port", "time"}},
+	       {{"in_node", "counting_0"}, {"in_port", "input"}, {"out_node", "addition_0"}, {"out_port", "output"}},
+	       {{"in_node", "output_0"}, {"in_port", "data"}, {"out_node", "counting_0"}, {"out_port", "output"}}}},
+	     {"name", "network"},
+	     {"type", "network"}});
+	(*filesystem->write(possumwood::Filepath::fromString("animated.psw"))) << subnetwork;
+
+	json setup({{"nodes",
+	             {{"network_0",
+	               {{"name", "net_a"},
+	                {"type", "network"},
+	                {"source", "animated.psw"},
+	                {"instanced", true},
+	                {"ports", {{"in", 10.0}}}}},
+	              {"network_1",
+	               {{"name", "net_b"},
+	                {"type", "network"},
+	                {"source", "animated.psw"},
+	                {"instanced", true},
+	                {"ports", {{"in", 10.0}}}}}}},
+	            {"connections", json::array()},
+	            {"name", "network"},
+	            {"type", "network"}});
+	(*filesystem->write(possumwood::Filepath::fromString("animated_setup.psw"))) << setup;
+
+	s_time = 1.0f;
+
+	dependency_graph::State state;
+	BOOST_REQUIRE_NO_THROW(state = app.loadFile(possumwood::Filepath::fromString("animated_setup.psw")));
+	BOOST_REQUIRE(!state.errored());
+
+	Network& netA = findNode(app.graph(), "net_a").as<Network>();
+	Network& netB = findNode(app.graph(), "net_b").as<Network>();
+
+	// the instances of a template with a time source are time sources themselves
+	BOOST_CHECK(netA.metadata()->flags() & dependency_graph::Metadata::kTimeSource);
+	BOOST_CHECK_EQUAL(app.graph().nodeIndex().timeSources().size(), 2u);
+
+	s_evaluations = 0;
+	BOOST_CHECK_EQUAL(netA.port(1).get<float>(), 11.0f);
+	BOOST_CHECK_EQUAL(netB.port(1).get<float>(), 11.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 1u);
+
+	// a time change invalidates the instances, and evaluates the template for the new time
+	s_time = 2.0f;
+	app.graph().invalidateTimeSources();
+
+	BOOST_CHECK(netA.port(1).isDirty());
+	BOOST_CHECK_EQUAL(netA.port(1).get<float>(), 12.0f);
+	BOOST_CHECK_EQUAL(netB.port(1).get<float>(), 12.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 2u);
+
+	// returning to a previous time reuses the cached evaluation
+	s_time = 1.0f;
+	app.graph().invalidateTimeSources();
+
+	BOOST_CHECK_EQUAL(netA.port(1).get<float>(), 11.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 2u);
+
+	// the cached outputs of the template are accounted for by the memory governor
+	auto governor = std::make_shared<dependency_graph::MemoryGovernor>(std::size_t(1) << 30);
+	app.graph().setMemoryGovernor(governor);
+
+	s_time = 3.0f;
+	app.graph().invalidateTimeSources();
+
+	BOOST_CHECK_EQUAL(netB.port(1).get<float>(), 13.0f);
+	BOOST_CHECK_EQUAL(s_evaluations, 3u);
+	BOOST_CHECK(governor->usage() > 0);
+
+	app.graph().setMemoryGovernor(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(instanced_disk_cache) {
+	auto filesystem = std::make_shared<possumwood::FilesystemMock>();
+
+	possumwood::App app(filesystem);
+
+	// make sure the static handles are initialised
+	additionNode();
+	countingNode();
+
+	// two templates with the same ports, but different content - in -> counting -> out, and in + 10 -> out
+	json passthrough(
+	    {{"nodes",
+	      {{"input_0", {{"name", "in"}, {"type", "input"}}},
+	       {"counting_0", {{"name", "counting"}, {"type", "counting"}}},
+	       {"output_0", {{"name", "out"}, {"type", "output"}}}}},
+	     {"connections",
+	      {{{"in_node", "counting_0"}, {"in_port", "input"}, {"out_node", "input_0"}, {"out_port", "data"}},
+	       {{"in_node", "output_0"}, {"in_port", "data"}, {"out_node", "counting_0"}, {"out_port", "output"}}}},
+	     {"name", "network"},
+	     {"type", "network"}});
+	(*filesystem->write(possumwood::Filepath::fromString("passthrough.psw"))) << passthrough;
+
+	json addition(
+	    {{"nodes",
+	      {{"input_0", {{"name", "in"}, {"type", "input"}}},
+	       {"addition_0", {{"name", "add"}, {"type", "addition"}, {"ports", {{"input_2", 10.0}}}}},
+	       {"output_0", {{"name", "out"}, {"type", "output"}}}}},
+	     {"connections",
+	      {{{"in_node", "addition_0"}, {"in_port", "input_1"}, {"out_node", "input_0"}, {"out_port", "data"}},
+	       {{"in_node", "output_0"}, {"in_port", "data"}, {"out_node", "addition_0"}, {"out_port", "output"}}}},
+	     {"name", "network"},
+	     {"type", "network"}});
+	(*filesystem->write(possumwood::Filepath::fromString("addition.psw"))) << addition;
+
+	json setup({{"nodes",
+	             {{"network_0",
+	               {{"name", "net_a"},
+	                {"type", "network"},
+	                {"source", "passthrough.psw"},
+	                {"instanced", true},
+	                {"ports", {{"in", 5.0}}}}},
+	              {"network_1",
+	               {{"name", "net_b"},
+	                {"type", "network"},
+	                {"source", "addition.psw"},
+	                {"instanced", true},
+	                {"ports", {{"in", 5.0}}}}}}},
+	            {"connections", json::array()},
+	            {"name", "network"},
+	            {"type", "network"}});
+	(*filesystem->write(possumwood::Filepath::fromString("cached_setup.psw"))) << setup;
+
+	// all compute results are stored in a temporary cache directory
+	const boost::filesystem::path dir =
+	    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("instanced_cache_%%%%%%%%");
+	app.graph().setComputeCache(std::make_shared<possumwood::DiskCache>(dir, std::chrono::steady_clock::duration(0)));
+
+	dependency_graph::State state;
+	BOOST_REQUIRE_NO_THROW(state = app.loadFile(possumwood::Filepath::fromString("cached_setup.psw")));
+	BOOST_REQUIRE(!state.errored());
+
+	Network& netA = findNode(app.graph(), "net_a").as<Network>();
+	Network& netB = findNode(app.graph(), "net_b").as<Network>();
+
+	// both instances have the "network" type, ports of the same names and the same inputs - but the results
+	//   of their different templates are cached separately
+	BOOST_CHECK_EQUAL(netA.metadata()->type(), netB.metadata()->type());
+
+	BOOST_CHECK_EQUAL(netA.port(1).get<float>(), 5.0f);
+	BOOST_CHECK_EQUAL(netB.port(1).get<float>(), 15.0f);
+	BOOST_CHECK_EQUAL(
+	    std::distance(boost::filesystem::directory_iterator(dir), boost::filesystem::directory_iterator()), 2);
+
+	app.graph().setComputeCache(nullptr);
+
+	boost::system::error_code ec;
+	boost::filesystem::remove_all(dir, ec);
+}
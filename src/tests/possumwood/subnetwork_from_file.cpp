@@ -133,8 +133,17 @@ BOOST_AUTO_TEST_CASE(network_from_file) {
 	BOOST_CHECK_EQUAL(net.portCount(), 2u);
 	BOOST_CHECK_EQUAL(net.port(0).name(), "this_is_an_input");
 	BOOST_CHECK_EQUAL(net.port(0).get<float>(), 8.0f);
+
+	// the content of the network is only loaded explicitly, before the first evaluation of its output
+	BOOST_CHECK(!net.isLoaded());
+	BOOST_CHECK(net.nodes().empty());
+
 	BOOST_CHECK_EQUAL(net.port(1).name(), "this_is_an_output");
-	BOOST_CHECK_EQUAL(net.port(1).get<float>(), 8.0f);
+	BOOST_CHECK_EQUAL(net.port(1).loadDeferredNetworks().get<float>(), 8.0f);
+
+	BOOST_CHECK(net.isLoaded());
+	BOOST_CHECK_EQUAL(net.nodes().size(), 3u);
+	BOOST_CHECK(!net.state().errored());
 
 	// test that the eval still works
 	BOOST_CHECK_NO_THROW(net.port(0).set(5.0f));
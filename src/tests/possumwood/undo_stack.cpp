@@ -1,11 +1,19 @@
+#include <actions/io.h>
 #include <actions/undo_stack.h>
 
+#include <boost/filesystem/operations.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <dependency_graph/data.inl>
+
 namespace std {
 std::ostream& operator<<(std::ostream& out, const std::vector<unsigned>& vals) {
 	return out;
 }
+
+std::ostream& operator<<(std::ostream& out, const std::vector<float>& vals) {
+	return out;
+}
 }  // namespace std
 
 BOOST_AUTO_TEST_CASE(simple_undo_redo) {
@@ -262,3 +270,140 @@ BOOST_AUTO_TEST_CASE(exception_handling) {
 	BOOST_REQUIRE_NO_THROW(stack.redo());
 	BOOST_CHECK_EQUAL(values, half_result);
 }
+
+namespace {
+
+/// an action setting a value, storing the original value for undo
+possumwood::UndoStack::Action setAction(std::vector<float>& value, std::size_t size) {
+	std::shared_ptr<dependency_graph::Data> target(new dependency_graph::Data(std::vector<float>(size, size)));
+	std::shared_ptr<dependency_graph::Data> original(new dependency_graph::Data());
+
+	possumwood::UndoStack::Action action;
+	action.addCommand(
+	    "Setting value",
+	    [&value, target, original]() {
+		    if(original->empty())
+			    *original = dependency_graph::Data(value);
+		    value = target->get<std::vector<float>>();
+	    },
+	    [&value, original]() { value = original->get<std::vector<float>>(); },
+	    std::vector<possumwood::UndoStack::Action::Value>{target, original},
+	    std::vector<possumwood::UndoStack::Action::Value>{original});
+	action.setMergeKey("value");
+
+	return action;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(merged_undo_redo) {
+	std::vector<float> value;
+
+	possumwood::UndoStack stack;
+
+	// consecutive changes of the same value form a single undo step
+	for(std::size_t a = 1; a <= 10; ++a)
+		BOOST_REQUIRE_NO_THROW(stack.execute(setAction(value, a)));
+
+	BOOST_CHECK_EQUAL(stack.undoActionCount(), 1u);
+	BOOST_CHECK_EQUAL(value.size(), 10u);
+
+	// only the original and the last values are held
+	BOOST_CHECK(stack.memoryFootprint() < 4 * (sizeof(std::vector<float>) + 10 * sizeof(float)));
+
+	BOOST_REQUIRE_NO_THROW(stack.undo());
+	BOOST_CHECK(value.empty());
+
+	BOOST_REQUIRE_NO_THROW(stack.redo());
+	BOOST_CHECK_EQUAL(value.size(), 10u);
+
+	// an action in between stops the merging
+	{
+		possumwood::UndoStack::Action a;
+		a.addCommand("Nothing", []() {}, []() {});
+		BOOST_REQUIRE_NO_THROW(stack.execute(a));
+	}
+
+	BOOST_REQUIRE_NO_THROW(stack.execute(setAction(value, 20)));
+	BOOST_REQUIRE_NO_THROW(stack.execute(setAction(value, 30)));
+	BOOST_CHECK_EQUAL(stack.undoActionCount(), 3u);
+
+	BOOST_REQUIRE_NO_THROW(stack.undo());
+	BOOST_CHECK_EQUAL(value.size(), 10u);
+
+	BOOST_REQUIRE_NO_THROW(stack.undo());
+	BOOST_REQUIRE_NO_THROW(stack.undo());
+	BOOST_CHECK(value.empty());
+}
+
+BOOST_AUTO_TEST_CASE(undo_memory_limit) {
+	std::vector<float> value;
+
+	// each action holds two values of about 4kB
+	possumwood::UndoStack stack;
+	stack.setMemoryLimit(20 * 1024);
+
+	for(std::size_t a = 1; a <= 10; ++a) {
+		possumwood::UndoStack::Action action = setAction(value, 1000 + a);
+		action.setMergeKey("");
+		BOOST_REQUIRE_NO_THROW(stack.execute(action));
+	}
+
+	// without a journal, the oldest actions are dropped
+	BOOST_CHECK(stack.memoryFootprint() <= stack.memoryLimit());
+	BOOST_CHECK(stack.undoActionCount() < 10u);
+	BOOST_CHECK(stack.undoActionCount() > 1u);
+
+	const std::size_t count = stack.undoActionCount();
+	for(std::size_t a = 0; a < count; ++a)
+		BOOST_REQUIRE_NO_THROW(stack.undo());
+	BOOST_CHECK_EQUAL(value.size(), 1000u + 10u - count);
+
+	// with a journal, the values are moved to a file instead
+	possumwood::BinaryIO<std::vector<float>> binaryIO(
+	    [](std::ostream& out, const std::vector<float>& v) {
+		    const std::uint64_t size = v.size();
+		    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		    out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(float));
+	    },
+	    [](std::istream& in, std::vector<float>& v) {
+		    std::uint64_t size = 0;
+		    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+		    v.resize(size);
+		    in.read(reinterpret_cast<char*>(v.data()), v.size() * sizeof(float));
+	    });
+
+	const boost::filesystem::path journal =
+	    boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("undo_%%%%-%%%%.journal");
+
+	stack.clear();
+	value.clear();
+	BOOST_REQUIRE_NO_THROW(stack.setJournal(journal));
+	BOOST_CHECK(boost::filesystem::exists(journal));
+
+	for(std::size_t a = 1; a <= 10; ++a) {
+		possumwood::UndoStack::Action action = setAction(value, 1000 + a);
+		action.setMergeKey("");
+		BOOST_REQUIRE_NO_THROW(stack.execute(action));
+	}
+
+	BOOST_CHECK(stack.memoryFootprint() <= stack.memoryLimit());
+	BOOST_CHECK_EQUAL(stack.undoActionCount(), 10u);
+
+	// undo reads the values back
+	for(std::size_t a = 10; a > 0; --a) {
+		BOOST_CHECK_EQUAL(value.size(), 1000u + a);
+		BOOST_CHECK_EQUAL(value.back(), static_cast<float>(1000u + a));
+		BOOST_REQUIRE_NO_THROW(stack.undo());
+	}
+	BOOST_CHECK(value.empty());
+
+	for(std::size_t a = 1; a <= 10; ++a) {
+		BOOST_REQUIRE_NO_THROW(stack.redo());
+		BOOST_CHECK_EQUAL(value.size(), 1000u + a);
+	}
+
+	// the journal is removed with the stack (or when replaced)
+	BOOST_REQUIRE_NO_THROW(stack.setJournal(boost::filesystem::path()));
+	BOOST_CHECK(!boost::filesystem::exists(journal));
+}